@@ -0,0 +1,92 @@
+#ifndef _BINNING_H_
+#define _BINNING_H_
+
+#include "defs.h"
+#include "workers.h"
+
+#define BIN_WIDTH 64
+#define BIN_LINE 64
+#define BIN_ROWS (8192 / (BIN_WIDTH * sizeof(pixel_t)))
+#define BIN_STRIPS ((SCREEN_WIDTH + BIN_WIDTH - 1) / BIN_WIDTH)
+#define BIN_BANDS ((SCREEN_HEIGHT - SCREEN_HEIGHT / 2 + BIN_ROWS - 1) / \
+	BIN_ROWS)
+
+/*
+ * The binned renderer draws a textured frame in two passes instead of one
+ * full height column per ray. The first casts every ray into a compact
+ * hit list, BIN_WIDTH columns per work item. The second rasterises screen
+ * tiles from that list: a tile is a strip of BIN_WIDTH columns and two
+ * mirrored bands of BIN_ROWS rows each, one below the horizon and the one
+ * above it, since a floor texel and the ceiling texel mirrored across the
+ * horizon come from the same map position. A tile (8 KB per band) is
+ * drawn into a buffer of its worker, walls first, then floor and ceiling,
+ * and copied out with streaming stores, so the frame buffer is written
+ * once without being read into the cache. Every pixel is written, the
+ * same as the column path draws onto a cleared buffer.
+ *
+ * Both passes run on a worker pool (see workers.h), the thread rendering
+ * the frame included.
+ */
+
+/**
+ * struct bincolumn_s - hit list entry of one screen column
+ * @distance: distance of the wall from the camera plane
+ * @wallX: where along the wall face the ray hit, between 0 and 1
+ * @cell: wall cell hit
+ * @side: 0 if an x side of the cell was hit, 1 for a y side
+ * @drawStart: first screen row of the wall
+ * @drawEnd: screen row below the wall; floor and ceiling start past it
+ * @sliceHeight: unclamped height of the wall on screen
+ * @texels: texture column of the wall, shaded at its level, or NULL to
+ * leave the column black
+ * @toWall: from the camera to the point of the wall at floor level
+ * @inverseDist: 1 / @distance
+ */
+typedef struct bincolumn_s
+{
+	real_t distance;
+	real_t wallX;
+	SDL_Point cell;
+	int side;
+	int drawStart;
+	int drawEnd;
+	int sliceHeight;
+	const pixel_t *texels;
+	vec_t toWall;
+	real_t inverseDist;
+} bincolumn_t;
+
+/**
+ * struct bintile_s - tile buffer of one worker
+ * @top: rows of the tile above the horizon; the band of the first strip
+ * of rows also holds row 0
+ * @bottom: rows of the tile below the horizon
+ */
+typedef struct bintile_s
+{
+	pixel_t top[BIN_ROWS + 1][BIN_WIDTH];
+	pixel_t bottom[BIN_ROWS][BIN_WIDTH];
+} bintile_t;
+
+/**
+ * struct binner_s - binned renderer and its worker threads
+ * @pool: the threads rendering, the caller included
+ * @tiles: tile buffer of each worker of @pool
+ * @state: game drawn by the current pass
+ * @camera: position of the camera, in ray casting precision
+ * @columns: the hit list, one entry per screen column
+ */
+typedef struct binner_s
+{
+	workers_t *pool;
+	bintile_t *tiles;
+	GameState *state;
+	vec_t camera;
+	bincolumn_t columns[SCREEN_WIDTH];
+} binner_t;
+
+binner_t *binner_Create(int threads);
+void binner_Render(binner_t *binner, GameState *state);
+void binner_Destroy(binner_t *binner);
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef _CONTROL_H_
+#define _CONTROL_H_
+
+#include "defs.h"
+
+#define CONTROL_VERSION 1
+#define CONTROL_SLOTS 4
+#define CONTROL_MAX_PAYLOAD 65535
+
+/*
+ * The control socket lets another process drive the game in place of the
+ * keyboard (Linux only): step the simulation with INPUT_* bits and a
+ * timestep, place or move the camera, read the player back and trace
+ * segments against the maze. Every message is a controlheader_t followed
+ * by @length bytes of payload, in host byte order since both ends share
+ * the machine. The game answers each request in order with the same
+ * type and sequence, and serves one client at a time.
+ *
+ * Frames never go through the socket. The reply to CONTROL_HELLO carries
+ * a shared memory descriptor holding CONTROL_SLOTS controlslot_t, which
+ * the client maps read only. A step that asks for a frame has it copied
+ * into slot frame % CONTROL_SLOTS and its reply names the slot. Slots are
+ * only written for such steps, so a frame stays valid until the client
+ * has asked for CONTROL_SLOTS more.
+ */
+
+/**
+ * enum controltype_e - requests of the control protocol, each answered
+ * with a message of the same type
+ * @CONTROL_HELLO: no payload; answered with controlinfo_t and the ring
+ * @CONTROL_STEP: controlstep_t; answered with controlstate_t once the
+ * step (and its frame, if asked for) is done
+ * @CONTROL_SET_CAMERA: controlcamera_t; answered with controlstate_t,
+ * status CONTROL_IN_WALL and no change if the position is not open floor
+ * @CONTROL_MOVE: controlmove_t; answered with controlstate_t
+ * @CONTROL_QUERY: no payload; answered with controlstate_t
+ * @CONTROL_TRACE: 1 to CONTROL_MAX_RAYS controlray_t; answered with a
+ * controlhit_t per ray
+ * @CONTROL_QUIT: no payload; answered with no payload, then the game ends
+ */
+typedef enum controltype_e
+{
+	CONTROL_HELLO = 1,
+	CONTROL_STEP,
+	CONTROL_SET_CAMERA,
+	CONTROL_MOVE,
+	CONTROL_QUERY,
+	CONTROL_TRACE,
+	CONTROL_QUIT
+} controltype_t;
+
+/**
+ * enum controlstatus_e - status of a reply
+ * @CONTROL_OK: the request was carried out
+ * @CONTROL_BAD_REQUEST: unknown type or malformed payload, nothing changed
+ * @CONTROL_IN_WALL: the camera was not moved into a wall
+ */
+typedef enum controlstatus_e
+{
+	CONTROL_OK,
+	CONTROL_BAD_REQUEST,
+	CONTROL_IN_WALL
+} controlstatus_t;
+
+/**
+ * struct controlheader_s - start of every message
+ * @type: a controltype_t
+ * @status: a controlstatus_t in replies, 0 in requests
+ * @length: number of payload bytes that follow
+ * @sequence: chosen by the client, repeated in the reply
+ */
+typedef struct controlheader_s
+{
+	uint8_t type;
+	uint8_t status;
+	uint16_t length;
+	uint32_t sequence;
+} controlheader_t;
+
+/**
+ * struct controlinfo_s - reply to CONTROL_HELLO
+ * @version: CONTROL_VERSION
+ * @mapWidth: number of cells in a row of the maze
+ * @mapHeight: number of rows in the maze
+ * @screenWidth: width of the frames
+ * @screenHeight: height of the frames
+ * @pixelSize: bytes per pixel: 1 for palette indices, 4 for xRGB
+ * @slots: number of slots in the ring
+ * @slotSize: size of a controlslot_t, the ring holds @slots of them
+ */
+typedef struct controlinfo_s
+{
+	uint32_t version;
+	int32_t mapWidth;
+	int32_t mapHeight;
+	uint16_t screenWidth;
+	uint16_t screenHeight;
+	uint8_t pixelSize;
+	uint8_t slots;
+	uint32_t slotSize;
+} controlinfo_t;
+
+/**
+ * struct controlstep_s - payload of CONTROL_STEP
+ * @input: INPUT_* bits held during the step (see player.h)
+ * @render: nonzero to render the frame after the step into the ring
+ * @elapsed: time the step advances the game, in ms
+ */
+typedef struct controlstep_s
+{
+	uint8_t input;
+	uint8_t render;
+	uint16_t elapsed;
+} controlstep_t;
+
+/**
+ * struct controlcamera_s - payload of CONTROL_SET_CAMERA
+ * @position: player position, x being the row of the maze
+ * @direction: player direction
+ * @viewPlane: camera plane, perpendicular to @direction
+ */
+typedef struct controlcamera_s
+{
+	point_t position;
+	point_t direction;
+	point_t viewPlane;
+} controlcamera_t;
+
+/**
+ * struct controlmove_s - payload of CONTROL_MOVE: the camera moves forward
+ * then sideways, each move stopping just short of the first wall in its
+ * way, then the camera turns
+ * @forward: distance along the direction, in lengths of the direction
+ * vector, negative to back up
+ * @strafe: distance along the camera plane, in lengths of the plane
+ * @turn: rotation, in radians
+ */
+typedef struct controlmove_s
+{
+	double forward;
+	double strafe;
+	double turn;
+} controlmove_t;
+
+/**
+ * struct controlstate_s - player after a request
+ * @camera: position, direction and camera plane
+ * @time: game time, in ms
+ * @steps: number of steps taken
+ * @frame: number of the frame in @slot, counting from 0
+ * @slot: ring slot holding the frame of this step, or -1 for none
+ * @blocked: nonzero if a wall stopped a move of this request
+ */
+typedef struct controlstate_s
+{
+	controlcamera_t camera;
+	double time;
+	uint32_t steps;
+	uint32_t frame;
+	int32_t slot;
+	uint32_t blocked;
+} controlstate_t;
+
+/**
+ * struct controlray_s - segment traced by CONTROL_TRACE
+ * @from: start of the segment
+ * @to: end of the segment
+ */
+typedef struct controlray_s
+{
+	point_t from;
+	point_t to;
+} controlray_t;
+
+#define CONTROL_MAX_RAYS (CONTROL_MAX_PAYLOAD / sizeof(controlray_t))
+
+/**
+ * struct controlhit_s - result of tracing a segment
+ * @fraction: part of the segment travelled before the first wall, 1 if
+ * there is none
+ * @cell: the wall cell, or the cell holding @to; cells outside the map
+ * count as walls
+ * @hit: nonzero if a wall was hit
+ * @reserved: 0
+ */
+typedef struct controlhit_s
+{
+	double fraction;
+	SDL_Point cell;
+	int32_t hit;
+	int32_t reserved;
+} controlhit_t;
+
+/**
+ * struct controlslot_s - one frame of the shared memory ring
+ * @frame: number of the frame, counting from 0
+ * @reserved: 0
+ * @palette: palette the frame was rendered with (MAZE_PALETTE builds only)
+ * @pixels: the frame buffer as rendered
+ */
+typedef struct controlslot_s
+{
+	uint32_t frame;
+	uint32_t reserved;
+#ifdef MAZE_PALETTE
+	uint32_t palette[PALETTE_SIZE];
+#endif
+	pixel_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH];
+} controlslot_t;
+
+/**
+ * struct control_s - control socket of a running game
+ * @path: path the socket is bound to
+ * @listener: listening socket
+ * @client: connected client, or -1
+ * @memory: descriptor of the shared memory ring
+ * @ring: the ring, CONTROL_SLOTS slots
+ * @pending: header of the step waiting for its reply, type 0 for none
+ * @render: true if the pending step asked for a frame
+ * @slot: slot holding the frame of the pending step, or -1
+ * @blocked: true if a wall stopped a move of the pending step
+ * @steps: number of steps taken
+ * @frames: number of frames written to the ring
+ * @request: payload of the request being served
+ * @reply: payload of its reply
+ */
+typedef struct control_s
+{
+	char *path;
+	int listener;
+	int client;
+	int memory;
+	controlslot_t *ring;
+	controlheader_t pending;
+	bool render;
+	int slot;
+	bool blocked;
+	uint32_t steps;
+	uint32_t frames;
+	uint8_t request[CONTROL_MAX_PAYLOAD];
+	uint8_t reply[CONTROL_MAX_PAYLOAD];
+} control_t;
+
+/**
+ * struct controlclient_s - connection of a client to a game
+ * @fd: the socket
+ * @sequence: sequence number of the next request
+ * @info: reply to CONTROL_HELLO
+ * @ring: the shared memory ring, mapped read only
+ */
+typedef struct controlclient_s
+{
+	int fd;
+	uint32_t sequence;
+	controlinfo_t info;
+	const controlslot_t *ring;
+} controlclient_t;
+
+control_t *control_Start(const char *path);
+bool control_Next(control_t *control, GameState *state, uint8_t *input,
+		uint16_t *elapsed);
+void control_Frame(control_t *control, const GameState *state);
+void control_Stop(control_t *control);
+
+bool control_Send(int fd, const controlheader_t *header,
+		const void *payload, int memory);
+bool control_Receive(int fd, controlheader_t *header, void *payload,
+		size_t size, int *memory);
+
+controlclient_t *control_Connect(const char *path);
+bool control_Post(controlclient_t *client, controltype_t type,
+		const void *payload, uint16_t length);
+bool control_Wait(controlclient_t *client, controlheader_t *header,
+		void *reply, size_t size);
+int control_Request(controlclient_t *client, controltype_t type,
+		const void *payload, uint16_t length, void *reply, size_t size);
+bool control_Step(controlclient_t *client, uint8_t input, uint16_t elapsed,
+		bool render, controlstate_t *state);
+const controlslot_t *control_Slot(const controlclient_t *client,
+		const controlstate_t *state);
+void control_Disconnect(controlclient_t *client);
+
+#endif
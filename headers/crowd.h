@@ -0,0 +1,82 @@
+#ifndef _CROWD_H_
+#define _CROWD_H_
+
+#include "defs.h"
+#include "workers.h"
+
+#define CROWD_MAX_RADIUS 0.45
+#define CROWD_CHUNK 1024
+
+/*
+ * A crowd moves many agents through the maze at once. Agents are circles
+ * kept in structure of arrays form, one array per field, and each tick
+ * moves every agent by its velocity: agents overlapping each other are
+ * pushed apart, and the move then slides along the walls the circle
+ * touches instead of stopping, so agents neither cut wall corners nor
+ * squeeze through diagonal gaps. Cells outside the map count as walls.
+ *
+ * Neighbours are found through a uniform grid of 2 * CROWD_MAX_RADIUS
+ * cells, numbered row by row and wrapped around a table, rebuilt every
+ * tick with a counting sort of the agents by bucket. Agents are moved in
+ * bucket order, so nearby agents are read together. A tick only reads
+ * the positions of the previous one, so agents are updated in parallel on
+ * a worker pool (see workers.h), CROWD_CHUNK at a time, and the result
+ * does not depend on the number of threads.
+ */
+
+/**
+ * struct crowd_s - agents moving through a maze
+ * @maze: maze the agents move in, must outlive the crowd
+ * @width: number of cells in a maze row (row stride)
+ * @height: number of rows in the maze
+ * @count: number of agents
+ * @capacity: number of agents the arrays hold
+ * @x: row coordinate of each agent
+ * @y: column coordinate of each agent
+ * @vx: velocity of each agent along the rows, in cells per second
+ * @vy: velocity of each agent along the columns, in cells per second
+ * @radius: radius of each agent, in cells
+ * @blocked: nonzero for each agent a wall slowed during the last tick
+ * @nextX: positions being computed by the current tick
+ * @nextY: positions being computed by the current tick
+ * @keys: bucket of each agent
+ * @start: first entry of each bucket in @order, plus the end of the last
+ * @order: agents sorted by bucket
+ * @mask: number of buckets minus one, a power of two minus one
+ * @stride: number of grid cells in a grid row, with a margin
+ * @seconds: length of the current tick
+ * @pool: the threads updating, the caller included
+ */
+typedef struct crowd_s
+{
+	const int *maze;
+	int width;
+	int height;
+	int count;
+	int capacity;
+	double *x;
+	double *y;
+	double *vx;
+	double *vy;
+	double *radius;
+	uint8_t *blocked;
+	double *nextX;
+	double *nextY;
+	uint32_t *keys;
+	uint32_t *start;
+	uint32_t *order;
+	uint32_t mask;
+	uint32_t stride;
+	double seconds;
+	workers_t *pool;
+} crowd_t;
+
+crowd_t *crowd_Create(const int *maze, int width, int height, int capacity,
+		int threads);
+int crowd_Add(crowd_t *crowd, double x, double y, double radius);
+void crowd_Update(crowd_t *crowd, double seconds);
+void crowd_Destroy(crowd_t *crowd);
+bool crowd_Slide(const int *maze, int width, int height, double *x,
+		double *y, double dx, double dy, double radius);
+
+#endif
@@ -2,17 +2,26 @@
 #define CONSTANTS_H
 
 #include <stdint.h>
+#include <float.h>
+#include <math.h>
 #include <SDL2/SDL.h>
 #define SCREEN_WIDTH 1000
 #define SCREEN_HEIGHT 800
 #define TEXTURE_WIDTH 64
 #define TEXTURE_HEIGHT 64
 #define TEXTURE_COUNT 6
-#define MAP_WIDTH 25
-#define MAP_HEIGHT 24
 
 #include <stdbool.h>
 
+struct replay_s;
+struct lighting_s;
+struct reload_s;
+struct stream_s;
+struct control_s;
+struct binner_s;
+struct minimap_s;
+struct metrics_s;
+
 /**
  * struct point_s - data structure for XY point coordinates of type double
  * @x: x coordinate
@@ -24,6 +33,103 @@ typedef struct point_s
 	double y;
 } point_t;
 
+/*
+ * Precision of the ray casting and texture mapping math, picked at compile
+ * time: -DMAZE_FLOAT selects single precision, -DMAZE_FIXED 16.16 fixed
+ * point (make PRECISION=float|fixed) and double is the default. Game state
+ * stays in point_t; each ray converts the camera once, and real_t values
+ * are only combined through the REAL_* macros so every mode builds.
+ * Fixed point holds values below 32768, enough for maps of 16384 cells.
+ */
+#if defined(MAZE_FIXED)
+typedef int32_t real_t;
+#define REAL_NAME "fixed"
+#define REAL_ONE 65536
+#define REAL(v) ((real_t)floor((v) * 65536.0 + 0.5))
+#define REAL_FROM_INT(i) ((real_t)(i) * 65536)
+#define REAL_TO_DOUBLE(r) ((r) / 65536.0)
+#define REAL_FRAC(r) ((r) & 0xFFFF)
+#define REAL_MUL(a, b) ((real_t)(((int64_t)(a) * (b)) >> 16))
+#define REAL_DIV(a, b) ((real_t)(((int64_t)(a) * 65536) / (b)))
+#elif defined(MAZE_FLOAT)
+typedef float real_t;
+#define REAL_NAME "float"
+#define REAL_ONE 1.0f
+#else
+typedef double real_t;
+#define REAL_NAME "double"
+#define REAL_ONE 1.0
+#endif
+
+#ifndef MAZE_FIXED
+#define REAL(v) ((real_t)(v))
+#define REAL_FROM_INT(i) ((real_t)(i))
+#define REAL_TO_DOUBLE(r) ((double)(r))
+#define REAL_FRAC(r) ((r) - (real_t)real_Floor(r))
+#define REAL_MUL(a, b) ((a) * (b))
+#define REAL_DIV(a, b) ((a) / (b))
+#endif
+
+/**
+ * real_Floor - Rounds a real_t down to an integer without a libm call
+ * @r: value to round
+ *
+ * Return: the largest integer not above @r
+ */
+static inline int real_Floor(real_t r)
+{
+#ifdef MAZE_FIXED
+	return (r >> 16);
+#else
+	int i = (int)r;
+
+	return (i - (r < (real_t)i));
+#endif
+}
+
+/**
+ * struct vec_s - data structure for XY coordinates in ray casting precision
+ * @x: x coordinate
+ * @y: y coordinate
+ */
+typedef struct vec_s
+{
+	real_t x;
+	real_t y;
+} vec_t;
+
+/*
+ * Texel and frame buffer format, picked at compile time: 32-bit xRGB by
+ * default, or with -DMAZE_PALETTE (make PALETTE=1) one byte per pixel
+ * indexing a 256 colour palette built from the textures at load time.
+ * Palette index 0 is always black, so a cleared buffer stays black.
+ *
+ * Shading darkens a pixel by level / SHADE_LEVELS. SHADE_ROW turns a
+ * level into a shade_t and SHADE applies it to one pixel: a lookup in
+ * that level's colormap row for palette pixels, and two multiplies for
+ * xRGB pixels. Level 0 leaves pixels unchanged. They only run when the
+ * textures are stored (see shade_TexturePixels): every texture is kept
+ * shaded at every level, so drawing a shaded pixel reads one texel, the
+ * same as an unshaded one.
+ */
+#define PALETTE_SIZE 256
+#define SHADE_LEVELS 32
+#ifdef MAZE_PALETTE
+typedef uint8_t pixel_t;
+typedef const uint8_t *shade_t;
+#define PIXEL_FORMAT "palette"
+#define SHADE_ROW(state, level) ((state)->colormap[level])
+#define SHADE(shade, c) ((shade)[c])
+#else
+typedef uint32_t pixel_t;
+typedef uint32_t shade_t;
+#define PIXEL_FORMAT "xrgb"
+#define SHADE_ROW(state, level) \
+	((uint32_t)(SHADE_LEVELS - (level)) * 256 / SHADE_LEVELS)
+#define SHADE(shade, c) (((((c) & 0xFF00FF) * (shade) >> 8) & 0xFF00FF) | \
+	((((c) & 0xFF00) * (shade) >> 8) & 0xFF00))
+#endif
+
 /**
  * struct GameState_s - Stores the current state of the game
  *
@@ -31,12 +137,35 @@ typedef struct point_s
  * @renderer: Pointer to the SDL_Renderer, used for rendering graphics
  * @texture: Pointer to the SDL_Texture, used for applying textures
  * @tiles: 3D array storing textures for each tile of the game world
+ * @shades: @tiles shaded at each of the SHADE_LEVELS levels, or NULL
+ * until textures are stored
  * @screenBuffer: 2D array representing the screen pixels for rendering
+ * @palette: xRGB colour of each palette index (MAZE_PALETTE builds only)
+ * @colormap: Palette index of each colour at each shade level
+ * (MAZE_PALETTE builds only)
  * @position: Player's position in the game world (x, y coordinates)
  * @direction: Player's direction vector for movement
  * @viewPlane: Plane perpendicular to the player's direction for field of view
  * @time: Time elapsed in the game (used for calculating frame updates)
  * @maze: Pointer to the maze map data (2D array representing the game level)
+ * @mapWidth: Number of cells in a row of the maze
+ * @mapHeight: Number of rows in the maze
+ * @pvs: DDA step bounds of the maze, per block of cells (see pvs.h), or
+ * NULL
+ * @replay: Input recording or playback of the run, or NULL
+ * @lighting: Baked lighting and fog of the maze (see lighting.h), or NULL
+ * @reload: Watcher reloading the map and textures when they change on disk
+ * (see reload.h), or NULL
+ * @stream: Video output every finished frame is queued to (see stream.h),
+ * or NULL
+ * @control: Socket another process drives the game through instead of the
+ * keyboard (see control.h), or NULL
+ * @binner: Renderer drawing textured frames tile by tile on several
+ * threads (see binning.h), or NULL to draw them column by column
+ * @minimap: Minimap and overview drawn over textured frames (see
+ * minimap.h), or NULL
+ * @metrics: Frame time histograms, overlay and reports (see metrics.h),
+ * or NULL
  * @textured: Flag to indicate if textures are being used in the game
  * @quit: Flag to indicate if the game loop should exit
  */
@@ -45,19 +174,42 @@ typedef struct GameState_s
 	SDL_Window *window;
 	SDL_Renderer *renderer;
 	SDL_Texture *texture;
-	uint32_t tiles[TEXTURE_COUNT][TEXTURE_HEIGHT][TEXTURE_HEIGHT];
-	uint32_t screenBuffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+	pixel_t tiles[TEXTURE_COUNT][TEXTURE_HEIGHT][TEXTURE_HEIGHT];
+	pixel_t (*shades)[TEXTURE_COUNT][TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	pixel_t screenBuffer[SCREEN_HEIGHT][SCREEN_WIDTH];
+#ifdef MAZE_PALETTE
+	uint32_t palette[PALETTE_SIZE];
+	uint8_t colormap[SHADE_LEVELS][PALETTE_SIZE];
+#endif
 	point_t position;
 	point_t direction;
 	point_t viewPlane;
 	double time;
 	int *maze;
+	int mapWidth;
+	int mapHeight;
+	uint8_t *pvs;
+	struct replay_s *replay;
+	struct lighting_s *lighting;
+	struct reload_s *reload;
+	struct stream_s *stream;
+	struct control_s *control;
+	struct binner_s *binner;
+	struct minimap_s *minimap;
+	struct metrics_s *metrics;
 	int textured;
 	int quit;
 } GameState;
 
-void extract_TexturePixels(GameState *state, SDL_Surface *texture, int index);
-void extract_Pixels(GameState *state, SDL_Surface *parsedOrigin[]);
+void extract_TexturePixels(SDL_Surface *texture,
+		uint32_t texels[TEXTURE_HEIGHT][TEXTURE_WIDTH]);
+bool extract_Pixels(GameState *state, SDL_Surface *parsedOrigin[]);
+bool convert_TexturePixels(uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH],
+		pixel_t (*tiles)[TEXTURE_HEIGHT][TEXTURE_WIDTH], uint32_t *palette,
+		uint8_t (*colormap)[PALETTE_SIZE]);
+bool set_TexturePixels(GameState *state,
+		uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH]);
+void shade_TexturePixels(GameState *state, unsigned int slots);
 uint32_t get_ColorFromPixel(uint8_t *pixel, SDL_PixelFormat *format);
 void printGameState(GameState *state);
 
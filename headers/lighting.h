@@ -0,0 +1,101 @@
+#ifndef _LIGHTING_H_
+#define _LIGHTING_H_
+
+#include "defs.h"
+
+#define LIGHTMAP_LUXELS 4
+#define LIGHT_BLOCK 8
+#define LIGHT_BLOCK_BYTES (LIGHT_BLOCK * LIGHT_BLOCK * 4 * LIGHTMAP_LUXELS)
+#define FOG_BUCKETS 64
+
+/*
+ * Light is baked when a map is loaded. Each wall face that borders a floor
+ * cell gets LIGHTMAP_LUXELS brightness samples along its length, lit by
+ * the ambient level and by every point light that can see it. Brightness
+ * is stored in 1 / SHADE_LEVELS steps, so SHADE_LEVELS means full light.
+ * Only the LIGHT_BLOCK x LIGHT_BLOCK cell blocks a light reaches get
+ * samples; every other face is lit by the ambient level alone.
+ *
+ * Rendering never does light math per pixel: the brightness of a wall
+ * column and its quantised distance pick a shade level in a table, and
+ * every pixel of the column is shaded with that one level. Floor and
+ * ceiling rows only get the ambient light and the fog of their distance.
+ *
+ * Faces are numbered like the ray that hits them: side * 2 + (step > 0),
+ * so face 1 is the -x face of a wall cell and face 2 the +y face.
+ *
+ * The lights are kept with the bake, along with the list of lights that
+ * reach each block, so that opening or closing a cell only rebakes the
+ * blocks of the lights whose reach covers it.
+ */
+
+/**
+ * struct light_s - point light placed in a map
+ * @x: row coordinate of the light
+ * @y: column coordinate of the light
+ * @intensity: brightness added at the light, 1 being full light
+ * @radius: distance at which the light fades out, in cells
+ */
+typedef struct light_s
+{
+	double x;
+	double y;
+	double intensity;
+	double radius;
+} light_t;
+
+/**
+ * struct lighting_s - baked lighting of a map
+ * @width: number of cells in a row of the map
+ * @height: number of rows of the map
+ * @blockWidth: number of light blocks in a row of blocks
+ * @blocks: per block, 1 + index of its samples in @luxels, or 0 if unlit
+ * @luxels: samples of the lit blocks, LIGHT_BLOCK_BYTES per block
+ * @blockCount: number of lit blocks
+ * @lights: the point lights the bake was made with
+ * @lightCount: number of lights
+ * @lightStart: per lit block, index of its first light in @lightIndex,
+ * with one more entry closing the last list
+ * @lightIndex: the lights reaching each lit block, in light order
+ * @stamp: generation tag telling which blocks were rebaked by an update
+ * @generation: tag of the current update
+ * @brightness: ambient brightness every face starts with, 1 being full
+ * @ambient: brightness of unlit faces, for x (0) and y (1) sides
+ * @fogScale: fog buckets per cell of distance, 0 without fog
+ * @shade: shade level of each brightness at each fog bucket
+ * @rowLevel: shade level of each floor and ceiling screen row
+ */
+typedef struct lighting_s
+{
+	int width;
+	int height;
+	int blockWidth;
+	uint32_t *blocks;
+	uint8_t *luxels;
+	size_t blockCount;
+	light_t *lights;
+	int lightCount;
+	uint32_t *lightStart;
+	uint32_t *lightIndex;
+	uint32_t *stamp;
+	uint32_t generation;
+	double brightness;
+	uint8_t ambient[2];
+	double fogScale;
+	uint8_t shade[SHADE_LEVELS + 1][FOG_BUCKETS];
+	uint8_t rowLevel[SCREEN_HEIGHT];
+} lighting_t;
+
+lighting_t *lighting_Create(const int *maze, int width, int height,
+		const light_t *lights, int lightCount, double ambient,
+		double fogDistance);
+void lighting_Destroy(lighting_t *lighting);
+void lighting_CellChanged(lighting_t *lighting, const int *maze, int x,
+		int y);
+int lighting_WallLevel(const lighting_t *lighting, SDL_Point map, int face,
+		real_t wallX, real_t distance);
+bool lighting_Load(const int *maze, int width, int height,
+		const char *mapFilename, lighting_t **lighting);
+bool loadMapLighting(GameState *state, const char *mapFilename);
+
+#endif
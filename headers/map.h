@@ -1,7 +1,10 @@
 #ifndef _MAP_H_
 #define _MAP_H_
 
-int *readMapFromFile(char *filename);
-void printMap(int *map);
+#include "defs.h"
+
+int *readMapFromFile(char *filename, int *width, int *height);
+void printMap(int *map, int width, int height);
+bool findOpenCell(int *map, int width, int height, point_t *position);
 
 #endif
@@ -0,0 +1,52 @@
+#ifndef _MAPEDIT_H_
+#define _MAPEDIT_H_
+
+#include "defs.h"
+#include "navigation.h"
+#include "pvs.h"
+
+#define MAPEDIT_TILE 16
+
+/*
+ * Cells of a loaded map can change while the game runs: doors slide,
+ * walls are knocked down. Every change goes through mapedit_SetCell,
+ * which writes the maze and repairs only the parts of the derived data
+ * that depend on the cell: the visibility bounds, the registered flow
+ * fields and the baked lighting. A change of wall texture keeps the cell
+ * a wall and only marks its tile dirty. Dirty tiles are MAPEDIT_TILE x
+ * MAPEDIT_TILE cells and are collected until mapedit_TakeDirty hands them
+ * out, so views of the map can redraw just what changed.
+ */
+
+/**
+ * struct mapedit_s - edit context of a loaded map
+ * @state: game state whose maze, visibility data and lighting are edited
+ * @pvs: update context of the visibility data, or NULL without any
+ * @fields: flow fields built on the maze, repaired after each edit
+ * @fieldCount: number of entries in @fields
+ * @fieldCapacity: allocated entries in @fields
+ * @tileWidth: number of tiles in a row of tiles
+ * @dirty: per tile, true if it is in @dirtyTiles
+ * @dirtyTiles: tiles changed since the last mapedit_TakeDirty
+ * @dirtyCount: number of entries in @dirtyTiles
+ */
+typedef struct mapedit_s
+{
+	GameState *state;
+	pvsedit_t *pvs;
+	flowfield_t **fields;
+	int fieldCount;
+	int fieldCapacity;
+	int tileWidth;
+	bool *dirty;
+	int *dirtyTiles;
+	int dirtyCount;
+} mapedit_t;
+
+mapedit_t *mapedit_Create(GameState *state);
+void mapedit_Destroy(mapedit_t *edit);
+bool mapedit_AddFlowField(mapedit_t *edit, flowfield_t *field);
+bool mapedit_SetCell(mapedit_t *edit, int x, int y, int value);
+int mapedit_TakeDirty(mapedit_t *edit, SDL_Rect *rects, int max);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _MAPGEN_H_
+#define _MAPGEN_H_
+
+#include "defs.h"
+
+/**
+ * enum mapstyle_e - layouts the map generator can produce
+ * @MAPGEN_PERFECT: maze with exactly one route between any two cells
+ * @MAPGEN_CAVERN: open caves carved out of smooth noise
+ * @MAPGEN_CORRIDOR: long horizontal corridors with rare crossings
+ */
+typedef enum mapstyle_e
+{
+	MAPGEN_PERFECT,
+	MAPGEN_CAVERN,
+	MAPGEN_CORRIDOR
+} mapstyle_t;
+
+/**
+ * struct mapgen_s - options of a generated map
+ * @width: number of cells in a row
+ * @height: number of rows
+ * @style: layout to generate
+ * @density: percentage of solid walls; for MAPGEN_PERFECT the share of
+ * maze walls kept (lower values add loops), for MAPGEN_CAVERN roughly the
+ * share of wall cells, for MAPGEN_CORRIDOR the share of the wall between
+ * two corridors that has no opening
+ * @seed: seed of the generator, equal options give equal maps
+ */
+typedef struct mapgen_s
+{
+	int width;
+	int height;
+	mapstyle_t style;
+	int density;
+	uint32_t seed;
+} mapgen_t;
+
+/*
+ * Rows are produced top to bottom and handed to a callback one at a time,
+ * so a map never has to fit in memory. A callback returning false stops
+ * the generator.
+ */
+typedef bool (*maprow_fn)(const int *row, int width, void *data);
+
+bool generateMap(const mapgen_t *options, maprow_fn emit, void *data);
+bool generateMapToFile(const mapgen_t *options, const char *filename);
+int *generateMapToMemory(const mapgen_t *options);
+bool parseMapStyle(const char *name, mapstyle_t *style);
+
+/* Helpers shared by the generator sources */
+uint32_t mapgen_Hash(uint32_t seed, int x, int y);
+uint32_t mapgen_Next(uint32_t *state);
+bool mapgen_Chance(uint32_t *state, int percent);
+int mapgen_Wall(const mapgen_t *options, int x, int y);
+int mapgen_Perfect(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data);
+int mapgen_Corridor(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data);
+int mapgen_Cavern(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data);
+
+#endif
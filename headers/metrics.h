@@ -0,0 +1,118 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include "defs.h"
+
+#define METRICS_BUCKETS 240
+#define METRICS_PERIOD 1000
+#define METRICS_OVERLAY_PERIOD 500
+#define METRICS_LINES 6
+#define METRICS_LINE 28
+#define METRICS_JSON 512
+
+/*
+ * Metrics time every frame of the game, always: the time between frame
+ * starts, the time spent drawing, the time spent handing the frame to the
+ * screen, the video output and the control ring, and the time from
+ * sampling the input to presenting the first frame that shows it. Each
+ * goes into a histogram of microseconds, exact below 8 us and with 8
+ * buckets per doubling above, so percentiles are within 6%. Buckets are
+ * atomic counters that only grow: recording is one atomic add, and each
+ * reader keeps a snapshot and works on the difference, so nothing is
+ * ever locked or reset.
+ *
+ * A reporter thread writes a JSON line for each period to a file, or to
+ * the Unix socket named after "unix:" (Linux only), reconnecting when the
+ * listener comes back. The overlay shows the same figures over textured
+ * frames, refreshed every METRICS_OVERLAY_PERIOD ms.
+ */
+
+/**
+ * enum metric_e - what a histogram times
+ * @METRIC_FRAME: from one frame start to the next
+ * @METRIC_RENDER: from the frame start to the start of the upload
+ * @METRIC_UPLOAD: handing the frame on and presenting it
+ * @METRIC_LATENCY: from sampling the input to presenting the next frame
+ * @METRIC_COUNT: number of histograms
+ */
+typedef enum metric_e
+{
+	METRIC_FRAME,
+	METRIC_RENDER,
+	METRIC_UPLOAD,
+	METRIC_LATENCY,
+	METRIC_COUNT
+} metric_t;
+
+/**
+ * struct metricsnapshot_s - the histograms as a reader last saw them
+ * @counts: count of each bucket of each histogram
+ * @time: performance counter when it was taken
+ */
+typedef struct metricsnapshot_s
+{
+	uint32_t counts[METRIC_COUNT][METRICS_BUCKETS];
+	uint64_t time;
+} metricsnapshot_t;
+
+/**
+ * struct metrics_s - frame metrics of a run
+ * @counts: the histograms, written by the game thread only
+ * @toMicro: microseconds per performance counter tick
+ * @start: performance counter when the metrics were created
+ * @frameStart: start of the current frame, 0 before the first
+ * @uploadStart: start of the current upload
+ * @inputTime: when input not yet shown was sampled, or 0
+ * @overlay: true to draw the overlay
+ * @shown: snapshot behind the overlay text
+ * @lines: the overlay text
+ * @ink: pixel of the overlay text, in the frame format
+ * @output: file or socket path the reporter writes to
+ * @file: the file, NULL when writing to a socket
+ * @fd: the socket, -1 while not connected
+ * @period: milliseconds between two JSON lines
+ * @thread: the reporter thread, NULL without an output
+ * @lock: guards @stop
+ * @wake: signalled when the metrics are destroyed
+ * @stop: true once the reporter should write its last line and end
+ * @reported: snapshot behind the last JSON line
+ * @written: number of JSON lines written
+ * @dropped: number of JSON lines nothing was listening for
+ */
+typedef struct metrics_s
+{
+	SDL_atomic_t counts[METRIC_COUNT][METRICS_BUCKETS];
+	double toMicro;
+	uint64_t start;
+	uint64_t frameStart;
+	uint64_t uploadStart;
+	uint64_t inputTime;
+	bool overlay;
+	metricsnapshot_t shown;
+	char lines[METRICS_LINES][METRICS_LINE];
+	pixel_t ink;
+	char *output;
+	FILE *file;
+	int fd;
+	int period;
+	SDL_Thread *thread;
+	SDL_mutex *lock;
+	SDL_cond *wake;
+	bool stop;
+	metricsnapshot_t reported;
+	unsigned long written;
+	unsigned long dropped;
+} metrics_t;
+
+metrics_t *metrics_Create(const char *output, int period);
+void metrics_Destroy(metrics_t *metrics);
+void metrics_Record(metrics_t *metrics, metric_t metric, uint64_t ticks);
+void metrics_FrameStart(metrics_t *metrics);
+void metrics_Input(metrics_t *metrics);
+void metrics_UploadStart(metrics_t *metrics);
+void metrics_Presented(metrics_t *metrics);
+int metrics_Format(metrics_t *metrics, char *line, size_t size);
+void metrics_Toggle(metrics_t *metrics);
+void metrics_Draw(metrics_t *metrics, GameState *state);
+
+#endif
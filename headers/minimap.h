@@ -0,0 +1,119 @@
+#ifndef _MINIMAP_H_
+#define _MINIMAP_H_
+
+#include "defs.h"
+
+#define MINIMAP_LEVELS 16
+#define MINIMAP_SIZE 200
+#define MINIMAP_MARGIN 8
+#define MINIMAP_MAGNIFY 3
+#define MINIMAP_DIRTY 32
+#define MINIMAP_CONE 24
+
+#define MINIMAP_VOID 0x000000
+#define MINIMAP_OPEN 0x202020
+#define MINIMAP_WALL 0xB4B4B4
+#define MINIMAP_PLAYER 0xFF4040
+#define MINIMAP_VIEW 0xFFD040
+
+/*
+ * The minimap draws the maze from above over textured frames: a
+ * MINIMAP_SIZE square in the top right corner following the player, or
+ * an overview of the whole map in the middle of the screen. Rows of the
+ * maze run down the screen and columns across it.
+ *
+ * The maze is reduced once into a pyramid of wall coverage, level l
+ * holding one byte per 2^l x 2^l cells, so every zoom reads a single
+ * texel per pixel. Zooming in past one cell per pixel magnifies level 0
+ * up to 2^MINIMAP_MAGNIFY pixels per cell. The view is kept rasterised in
+ * a layer: a frame scrolls it, rasterises only the rectangles that came
+ * into view or changed, copies it to the screen and draws the player and
+ * the edges of the view on top.
+ */
+
+/**
+ * enum minimapmode_e - what the minimap shows
+ * @MINIMAP_OFF: nothing
+ * @MINIMAP_CORNER: the cells around the player, in the top right corner
+ * @MINIMAP_OVERVIEW: the whole map, in the middle of the screen
+ */
+typedef enum minimapmode_e
+{
+	MINIMAP_OFF,
+	MINIMAP_CORNER,
+	MINIMAP_OVERVIEW
+} minimapmode_t;
+
+/**
+ * struct minimaplevel_s - one level of the coverage pyramid
+ * @cover: wall coverage of each texel, 0 for open to 255 for all walls,
+ * texel (x, y) at cover[x * width + y]
+ * @width: number of texels in a row
+ * @height: number of rows
+ */
+typedef struct minimaplevel_s
+{
+	uint8_t *cover;
+	int width;
+	int height;
+} minimaplevel_t;
+
+/**
+ * struct minimap_s - minimap and overview of a maze
+ * @mode: what is shown
+ * @zoom: scale of the corner view: 2^zoom cells per pixel when positive,
+ * 2^-zoom pixels per cell when negative
+ * @maze: maze the pyramid was built from, NULL until it is first shown
+ * @mapWidth: number of cells in a row of @maze
+ * @mapHeight: number of rows in @maze
+ * @levels: the pyramid, level 0 holding one texel per cell
+ * @levelCount: number of levels, the last one a single texel
+ * @painted: false when the colours below must be converted again
+ * @colors: pixel of each wall coverage
+ * @outside: pixel of texels outside the map
+ * @player: pixel of the player
+ * @view: pixel of the edges of the view
+ * @layer: the view as last drawn, with a row stride of SCREEN_WIDTH
+ * @valid: false when the whole layer must be drawn again
+ * @window: where the layer goes on the screen, x and w along the screen
+ * columns
+ * @scale: scale of the layer, as @zoom
+ * @originX: map row of the top of the layer, in pixels of @scale
+ * @originY: map column of the left of the layer, in pixels of @scale
+ * @dirty: parts of the map to rasterise again if in view, in pixels of
+ * @scale: x and w along map rows, y and h along map columns
+ * @dirtyCount: number of entries in @dirty
+ */
+typedef struct minimap_s
+{
+	minimapmode_t mode;
+	int zoom;
+	const int *maze;
+	int mapWidth;
+	int mapHeight;
+	minimaplevel_t levels[MINIMAP_LEVELS];
+	int levelCount;
+	bool painted;
+	pixel_t colors[256];
+	pixel_t outside;
+	pixel_t player;
+	pixel_t view;
+	pixel_t *layer;
+	bool valid;
+	SDL_Rect window;
+	int scale;
+	int originX;
+	int originY;
+	SDL_Rect dirty[MINIMAP_DIRTY];
+	int dirtyCount;
+} minimap_t;
+
+minimap_t *minimap_Create(void);
+void minimap_Destroy(minimap_t *minimap);
+void minimap_Cycle(minimap_t *minimap);
+void minimap_Zoom(minimap_t *minimap, int steps);
+void minimap_Invalidate(minimap_t *minimap);
+void minimap_Repair(minimap_t *minimap, const SDL_Rect *rects, int count);
+void minimap_Draw(minimap_t *minimap, GameState *state);
+
+#endif
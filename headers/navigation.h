@@ -0,0 +1,87 @@
+#ifndef _NAVIGATION_H_
+#define _NAVIGATION_H_
+
+#include "defs.h"
+
+#define NAV_UNREACHABLE UINT32_MAX
+
+/*
+ * Navigation works directly on the maze array loaded by readMapFromFile:
+ * cell (x, y) lives at maze[x * width + y] and is walkable when it is 0,
+ * the same convention movePlayer and renderWalls use.
+ */
+
+/**
+ * struct flowfield_s - BFS distance field towards a set of goal cells
+ * @maze: maze the field was built on, must outlive the field
+ * @width: number of cells in a maze row (row stride)
+ * @height: number of rows in the maze
+ * @goals: goal cells every distance is measured to
+ * @goalCount: number of entries in @goals
+ * @dist: steps from each cell to the nearest goal, or NAV_UNREACHABLE
+ * @mark: per-cell scratch flags used by the incremental updates
+ */
+typedef struct flowfield_s
+{
+	const int *maze;
+	int width;
+	int height;
+	SDL_Point *goals;
+	int goalCount;
+	uint32_t *dist;
+	uint8_t *mark;
+} flowfield_t;
+
+/**
+ * struct heapnode_s - entry of the jump point search open list
+ * @cost: estimated total cost through the cell
+ * @cell: index of the cell in the maze
+ */
+typedef struct heapnode_s
+{
+	float cost;
+	int cell;
+} heapnode_t;
+
+/**
+ * struct jpsearch_s - reusable scratch space for jump point search
+ * @maze: maze searched, must outlive the search context
+ * @width: number of cells in a maze row (row stride)
+ * @height: number of rows in the maze
+ * @cost: cost from the start to each visited cell
+ * @parent: previous jump point of each visited cell
+ * @stamp: generation tag telling which cells belong to the current search
+ * @generation: tag of the current search
+ * @heap: binary min-heap used as the open list
+ * @heapSize: number of entries in @heap
+ * @heapCapacity: allocated entries in @heap
+ */
+typedef struct jpsearch_s
+{
+	const int *maze;
+	int width;
+	int height;
+	float *cost;
+	int *parent;
+	uint32_t *stamp;
+	uint32_t generation;
+	heapnode_t *heap;
+	int heapSize;
+	int heapCapacity;
+} jpsearch_t;
+
+bool nav_IsWalkable(const int *maze, int width, int height, int x, int y);
+flowfield_t *nav_CreateFlowField(const int *maze, int width, int height,
+		const SDL_Point *goals, int goalCount);
+void nav_DestroyFlowField(flowfield_t *field);
+void nav_BuildFlowField(flowfield_t *field);
+void nav_CellChanged(flowfield_t *field, int x, int y);
+int nav_QueryBatch(const flowfield_t *field, const point_t *positions,
+		point_t *directions, int count);
+
+jpsearch_t *nav_CreateSearch(const int *maze, int width, int height);
+void nav_DestroySearch(jpsearch_t *search);
+int nav_FindPath(jpsearch_t *search, SDL_Point start, SDL_Point goal,
+		SDL_Point *path, int maxLength);
+
+#endif
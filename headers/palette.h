@@ -0,0 +1,20 @@
+#ifndef _PALETTE_H_
+#define _PALETTE_H_
+
+#include "defs.h"
+
+/*
+ * Colours are xRGB words (0x00RRGGBB), the format extract_TexturePixels
+ * produces. The functions work on plain arrays so they are usable in every
+ * build; MAZE_PALETTE builds keep the results in GameState.
+ */
+
+bool palette_Quantise(const uint32_t *colors, size_t count,
+		uint32_t palette[PALETTE_SIZE]);
+uint8_t palette_Nearest(const uint32_t palette[PALETTE_SIZE], uint32_t color);
+void palette_BuildColormap(const uint32_t palette[PALETTE_SIZE],
+		uint8_t colormap[SHADE_LEVELS][PALETTE_SIZE]);
+void palette_Expand(const uint32_t palette[PALETTE_SIZE],
+		const uint8_t *indices, uint32_t *pixels, int count);
+
+#endif
@@ -3,9 +3,17 @@
 
 #include "defs.h"
 
-void movePlayer(GameState * state, int *maze, double directionX,
+#define INPUT_FORWARD 0x01
+#define INPUT_BACKWARD 0x02
+#define INPUT_STRAFE 0x04
+#define INPUT_TURN_RIGHT 0x08
+#define INPUT_TURN_LEFT 0x10
+
+bool movePlayer(GameState * state, int *maze, double directionX,
 		double directionY, double modifier);
 void rotatePlayer(GameState *state, double modifier, int direction);
+uint8_t readPlayerInput(void);
+bool applyPlayerInput(GameState *state, uint8_t input, double seconds);
 void handlePlayerMovement(GameState *state);
 
 #endif
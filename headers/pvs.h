@@ -0,0 +1,89 @@
+#ifndef _PVS_H_
+#define _PVS_H_
+
+#include "defs.h"
+
+#define PVS_QUADRANTS 4
+#define PVS_BLOCK_SHIFT 2
+#define PVS_EXACT 128
+#define PVS_COARSE_SHIFT 8
+#define PVS_UNBOUNDED UINT8_MAX
+#define PVS_MAGIC 0x3256504D
+
+/*
+ * A ray cast by renderWalls only ever steps away from its start in x and
+ * in y, so every cell it crosses is reachable from the start cell by a
+ * staircase of floor cells heading into the ray's quadrant. For each
+ * floor cell and each quadrant the visibility data stores how many DDA
+ * steps it takes to reach the farthest cell of that staircase region,
+ * which bounds every ray leaving the cell. PVS_UNBOUNDED means the bound
+ * did not fit and the ray must check the map edges instead.
+ *
+ * A ray that has a bound only skips the map edge checks; it still stops
+ * at the first wall, so any larger bound works as well. castRay only
+ * looks the bound up for rays still going after RAY_CHECKED_STEPS steps. The data keeps
+ * one byte per quadrant for each block of 1 << PVS_BLOCK_SHIFT cells
+ * square, the largest bound of its cells rounded up: exact below
+ * PVS_EXACT steps, then in steps of 1 << PVS_COARSE_SHIFT. That is a
+ * sixteenth of the size of the maze itself.
+ */
+
+/**
+ * struct pvsheader_s - header of a visibility file stored next to a map
+ * @magic: PVS_MAGIC
+ * @width: number of cells in a row of the map
+ * @height: number of rows of the map
+ * @mapHash: hash of the map the data was computed for
+ */
+typedef struct pvsheader_s
+{
+	uint32_t magic;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mapHash;
+} pvsheader_t;
+
+/**
+ * struct pvsedit_s - state kept to update visibility data after edits
+ * @maze: maze the data was built on, must outlive the context
+ * @width: number of cells in a row
+ * @height: number of rows
+ * @pvs: the visibility data kept up to date
+ * @reach: per cell and quadrant, how far the staircase region of the
+ * cell extends in x and in y, which the bounds are derived from
+ * @stamp: generation tag telling which cells are queued
+ * @generation: tag of the current update step
+ * @cells: two lists of cells, the current and the next wavefront
+ * @capacity: number of entries each list can hold
+ */
+typedef struct pvsedit_s
+{
+	const int *maze;
+	int width;
+	int height;
+	uint8_t *pvs;
+	uint16_t *reach;
+	uint32_t *stamp;
+	uint32_t generation;
+	int *cells[2];
+	int capacity;
+} pvsedit_t;
+
+size_t pvs_Size(int width, int height);
+size_t pvs_Index(int width, int x, int y, int quadrant);
+uint8_t pvs_Encode(long steps);
+int pvs_Bound(const uint8_t *pvs, int width, int x, int y, int quadrant);
+uint8_t *pvs_Build(const int *maze, int width, int height);
+bool pvs_BuildQuadrant(const int *maze, int width, int height,
+		int quadrant, uint8_t *pvs);
+uint32_t pvs_HashMap(const int *maze, int width, int height);
+uint8_t *pvs_Load(const int *maze, int width, int height,
+		const char *mapFilename);
+bool loadMapVisibility(GameState *state, const char *mapFilename);
+
+pvsedit_t *pvs_CreateEdit(const int *maze, int width, int height,
+		uint8_t *pvs);
+void pvs_DestroyEdit(pvsedit_t *edit);
+bool pvs_CellChanged(pvsedit_t *edit, int x, int y);
+
+#endif
@@ -4,12 +4,61 @@
 #include "defs.h"
 #include "textures.h"
 #include "graphics.h"
+#include "pvs.h"
+#include "lighting.h"
+#include "binning.h"
+#include "minimap.h"
+#include "metrics.h"
 
-void drawWallStrips(GameState * state, SDL_Point map, point_t rayPos,
-		point_t rayDir, double distToWall, int x, int side, int textured);
-void calculateRayPosition(GameState *state, int stripe, point_t *rayPosition,
-		point_t *rayDirection, SDL_Point *tilePosition, point_t *deltaDistance,
-		SDL_Point *stepDirection, point_t *sideDistance);
+/*
+ * Smallest distance castRay reports, so a camera pressed against a wall
+ * still gives a wall slice height that fits every real_t mode
+ */
+#define RAY_MIN_DISTANCE REAL(1.0 / 32)
+
+/*
+ * Distance castRay gives a ray running (almost) parallel to the grid lines
+ * of one axis before it crosses one: no ray in a map of 16384 cells gets
+ * that far along the other axis, and a DDA sum adding it to such a
+ * distance still fits fixed point
+ */
+#define RAY_FAR REAL_FROM_INT((1 << 14) - 1)
+
+/*
+ * Steps a ray takes checking the map edges before castRay looks up its
+ * bound in the visibility data. Most rays of a maze of narrow passages end
+ * sooner, and for them the lookup would cost more than the checks it saves.
+ */
+#define RAY_CHECKED_STEPS 8
+
+/**
+ * struct rayhit_s - Result of casting one ray through the maze
+ * @position: origin of the ray (the camera position)
+ * @direction: direction of the ray
+ * @map: cell the ray stopped in
+ * @side: 0 if an x side of the cell was hit, 1 for a y side
+ * @distance: distance from the camera plane to the wall hit, at least
+ * RAY_MIN_DISTANCE
+ * @wallX: where along the wall face the ray hit, between 0 and 1
+ * @steps: number of DDA steps taken
+ */
+typedef struct rayhit_s
+{
+	vec_t position;
+	vec_t direction;
+	SDL_Point map;
+	int side;
+	real_t distance;
+	real_t wallX;
+	int steps;
+} rayhit_t;
+
+void drawWallStrips(GameState * state, SDL_Point map, vec_t rayPos,
+		vec_t rayDir, real_t distToWall, int x, int side, int textured);
+void calculateRayPosition(GameState *state, int stripe, vec_t *rayPosition,
+		vec_t *rayDirection, SDL_Point *tilePosition, vec_t *deltaDistance,
+		SDL_Point *stepDirection, vec_t *sideDistance);
+bool castRay(GameState *state, int column, rayhit_t *ray);
 void renderWalls(GameState *state, int textured);
 void castCeilingAndFloor(GameState *state);
 
@@ -0,0 +1,92 @@
+#ifndef _RELOAD_H_
+#define _RELOAD_H_
+
+#include "defs.h"
+#include "lighting.h"
+
+/*
+ * Hot reload watches the map being played and the texture directory with
+ * inotify on a background thread. When a file is written, that thread
+ * reads the map again (with its visibility data and lighting) or decodes
+ * the one texture that changed, and publishes the result as a single
+ * pointer. The game loop picks it up between frames with reload_Apply,
+ * which only swaps pointers and copies the changed texture slots; the
+ * data it replaces goes back to the thread to be freed. Palette builds
+ * quantise all textures again on the thread, since the palette is shared.
+ */
+
+/**
+ * struct reloaddata_s - data read by the watcher, waiting to be swapped in
+ * @maze: the map read again, or NULL if it did not change
+ * @mapWidth: number of cells in a row of @maze
+ * @mapHeight: number of rows of @maze
+ * @pvs: visibility data of @maze
+ * @lighting: baked lighting of @maze, or NULL for the unlit look
+ * @textures: bit per texture slot whose pixels are in @tiles
+ * @tiles: pixels of the changed textures
+ * @palette: palette of the textures in palette builds
+ * @colormap: shade rows of @palette in palette builds
+ * @detected: performance counter at the first change of the batch
+ * @ready: performance counter when the data was published
+ */
+typedef struct reloaddata_s
+{
+	int *maze;
+	int mapWidth;
+	int mapHeight;
+	uint8_t *pvs;
+	lighting_t *lighting;
+	unsigned int textures;
+	pixel_t tiles[TEXTURE_COUNT][TEXTURE_HEIGHT][TEXTURE_WIDTH];
+#ifdef MAZE_PALETTE
+	uint32_t palette[PALETTE_SIZE];
+	uint8_t colormap[SHADE_LEVELS][PALETTE_SIZE];
+#endif
+	uint64_t detected;
+	uint64_t ready;
+} reloaddata_t;
+
+/**
+ * struct reload_s - file watcher of a running game
+ * @thread: the watcher thread
+ * @notify: inotify descriptor
+ * @mapWatch: watch of the directory holding the map
+ * @textureWatch: watch of the texture directory
+ * @mapFile: path of the map being played
+ * @mapName: file name part of @mapFile
+ * @textureDir: directory holding the texture files
+ * @texels: last xRGB texels of every texture, kept in palette builds
+ * @pending: reloaddata_t published for reload_Apply, or NULL
+ * @retired: reloaddata_t holding replaced data for the thread to free
+ * @stop: set to 1 to end the thread
+ * @reloads: number of batches swapped in
+ * @latency: time from the last change swapped in to its swap, in seconds
+ * @apply: time the last swap held up its frame, in seconds
+ * @latencyMax: longest time from a change to its swap, in seconds
+ * @applyMax: longest time a swap held up its frame, in seconds
+ */
+typedef struct reload_s
+{
+	SDL_Thread *thread;
+	int notify;
+	int mapWatch;
+	int textureWatch;
+	char *mapFile;
+	const char *mapName;
+	const char *textureDir;
+	uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	void *pending;
+	void *retired;
+	SDL_atomic_t stop;
+	int reloads;
+	double latency;
+	double apply;
+	double latencyMax;
+	double applyMax;
+} reload_t;
+
+reload_t *reload_Start(char *mapFile, const char *textureDir);
+bool reload_Apply(reload_t *reload, GameState *state);
+void reload_Stop(reload_t *reload);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#include "defs.h"
+
+#define REPLAY_MAGIC 0x504C524D
+#define REPLAY_FRAME_SIZE 3
+
+/**
+ * enum replaymode_e - what a replay does with the frames of a run
+ * @REPLAY_RECORD: input and timestep of every frame are written to a file
+ * @REPLAY_PLAY: frames are read back instead of the keyboard and clock
+ */
+typedef enum replaymode_e
+{
+	REPLAY_RECORD,
+	REPLAY_PLAY
+} replaymode_t;
+
+/**
+ * struct replayheader_s - start of a replay file
+ * @magic: REPLAY_MAGIC
+ * @mapHash: hash of the map the run was recorded on
+ * @position: player position when the run started
+ * @direction: player direction when the run started
+ * @viewPlane: camera plane when the run started
+ */
+typedef struct replayheader_s
+{
+	uint32_t magic;
+	uint32_t mapHash;
+	point_t position;
+	point_t direction;
+	point_t viewPlane;
+} replayheader_t;
+
+/**
+ * struct replay_s - recording or playback of a run
+ * @mode: whether frames are recorded or played back
+ * @file: file frames are appended to while recording
+ * @frames: frames read from the file while playing, REPLAY_FRAME_SIZE
+ * bytes each: the input bits, then the timestep in ms (little endian)
+ * @frameCount: number of frames recorded or available
+ * @cursor: next frame to play
+ */
+typedef struct replay_s
+{
+	replaymode_t mode;
+	FILE *file;
+	uint8_t *frames;
+	size_t frameCount;
+	size_t cursor;
+} replay_t;
+
+replay_t *replay_Open(GameState *state, const char *path, replaymode_t mode);
+void replay_Record(replay_t *replay, uint8_t input, uint16_t elapsed);
+bool replay_Next(replay_t *replay, uint8_t *input, uint16_t *elapsed);
+void replay_Close(replay_t *replay);
+
+#endif
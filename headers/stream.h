@@ -0,0 +1,98 @@
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include "defs.h"
+
+#define STREAM_SLOTS 8
+#define STREAM_FPS 60
+
+/*
+ * A stream records every finished frame of the game as video. The frame
+ * is copied into a ring of STREAM_SLOTS frames when it is presented, and
+ * a writer thread converts and writes it. In the window rendering never
+ * waits on the disk: when the ring is full the frame is dropped and
+ * counted instead. Without a window nothing has to keep pace, so the game
+ * waits for a free slot and every frame is written.
+ *
+ * STREAM_Y4M writes YUV4MPEG2 at STREAM_FPS with 4:2:0 BT.601 studio
+ * range colour. STREAM_ARGB writes bare frames of 32-bit ARGB words in
+ * host byte order (bgra bytes on little endian machines), with no header.
+ * An output starting with '|' is a command the frames are piped to.
+ */
+
+/**
+ * enum streamformat_e - formats a stream can write
+ * @STREAM_Y4M: YUV4MPEG2, 4:2:0
+ * @STREAM_ARGB: raw 32-bit ARGB frames
+ */
+typedef enum streamformat_e
+{
+	STREAM_Y4M,
+	STREAM_ARGB
+} streamformat_t;
+
+/**
+ * struct streamframe_s - one frame waiting in the ring
+ * @pixels: the frame buffer as rendered
+ * @palette: palette the frame was rendered with (MAZE_PALETTE builds only)
+ */
+typedef struct streamframe_s
+{
+	pixel_t pixels[SCREEN_HEIGHT][SCREEN_WIDTH];
+#ifdef MAZE_PALETTE
+	uint32_t palette[PALETTE_SIZE];
+#endif
+} streamframe_t;
+
+/**
+ * struct stream_s - video output of a run
+ * @file: file or pipe the frames are written to
+ * @piped: true if @file was opened with popen
+ * @format: format of the frames
+ * @wait: true to wait for a free slot instead of dropping the frame
+ * @thread: the writer thread
+ * @lock: guards @first, @count and @closing
+ * @queued: signalled when a frame is queued or the stream closes
+ * @freed: signalled when the writer is done with a slot
+ * @slots: the ring of frames
+ * @first: slot of the oldest queued frame
+ * @count: number of queued frames
+ * @closing: true once no more frames will be queued
+ * @argb: writer scratch frame of ARGB pixels
+ * @yuv: writer scratch frame of Y, U and V planes
+ * @written: number of frames written
+ * @dropped: number of frames dropped because the ring was full
+ * @failed: true once a write failed; later frames are dropped
+ */
+typedef struct stream_s
+{
+	FILE *file;
+	bool piped;
+	streamformat_t format;
+	bool wait;
+	SDL_Thread *thread;
+	SDL_mutex *lock;
+	SDL_cond *queued;
+	SDL_cond *freed;
+	streamframe_t *slots;
+	int first;
+	int count;
+	bool closing;
+	uint32_t *argb;
+	uint8_t *yuv;
+	unsigned long written;
+	unsigned long dropped;
+	bool failed;
+} stream_t;
+
+bool parseStreamFormat(const char *name, streamformat_t *format);
+stream_t *stream_Open(const char *output, streamformat_t format, bool wait);
+void stream_Frame(stream_t *stream, const GameState *state);
+void stream_Close(stream_t *stream);
+
+void stream_YUV420(const uint32_t *argb, int width, int height,
+		uint8_t *y, uint8_t *u, uint8_t *v);
+void stream_YUV420Scalar(const uint32_t *argb, int width, int height,
+		int x0, uint8_t *y, uint8_t *u, uint8_t *v);
+
+#endif
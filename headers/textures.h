@@ -5,12 +5,20 @@
 #include <SDL2/SDL_image.h>
 #include "defs.h"
 
+#define TEXTURE_DIR "assets/textures"
+
 void get_TexturePaths(char *textureFiles[]);
 bool loadTextures(SDL_Surface * parsedOrigin[]);
 bool loadMapTextures(GameState *state);
-point_t get_EnvPixelPosition(SDL_Point mapPos, point_t rayDir,
-		double wallX, int wallSide);
-void cast_EnvTextures(GameState *state, SDL_Point mapPos,
-		point_t rayDir, double distToWall,
-		double wallX, int drawEnd, int col, int wallSide);
+const char *get_TextureName(int slot);
+int get_TextureSlot(const char *name);
+bool load_TextureSlot(const char *dir, int slot,
+		uint32_t texels[TEXTURE_HEIGHT][TEXTURE_WIDTH]);
+vec_t get_EnvPixelPosition(SDL_Point mapPos, vec_t rayDir,
+		real_t wallX, int wallSide);
+void init_EnvRows(void);
+const real_t *get_EnvRows(const GameState *state, const uint8_t **rowLevel);
+void cast_EnvTextures(GameState *state, SDL_Point mapPos, vec_t rayPos,
+		vec_t rayDir, real_t distToWall,
+		real_t wallX, int drawEnd, int col, int wallSide);
 #endif
@@ -0,0 +1,72 @@
+#ifndef _WORKERS_H_
+#define _WORKERS_H_
+
+#include "defs.h"
+
+/*
+ * A worker pool runs passes of independent work items on a fixed set of
+ * threads. The thread running a pass takes part in it as the first
+ * worker, so a pool of one thread starts none. Items are taken one at a
+ * time from a shared counter, and the pass returns once every item is
+ * done; the threads sleep between passes.
+ */
+
+struct workers_s;
+
+/**
+ * workfunc_t - does one work item of a pass
+ * @context: context given to workers_Run
+ * @worker: index of the worker doing the item, 0 for the caller
+ * @item: index of the item
+ */
+typedef void (*workfunc_t)(void *context, int worker, int item);
+
+/**
+ * struct worker_s - a thread of a worker pool
+ * @pool: pool the thread works for
+ * @thread: the thread, NULL for the thread running the passes
+ * @generation: last pass the thread took part in
+ */
+typedef struct worker_s
+{
+	struct workers_s *pool;
+	SDL_Thread *thread;
+	unsigned int generation;
+} worker_t;
+
+/**
+ * struct workers_s - pool of worker threads
+ * @threads: number of threads working, the caller included
+ * @workers: @threads workers; the first is the caller's
+ * @lock: guards @generation, @busy and @stop
+ * @wake: signalled when a pass starts or the pool stops
+ * @done: signalled when the last worker finishes a pass
+ * @generation: number of the current pass
+ * @busy: number of worker threads still in the pass
+ * @stop: true once the threads should end
+ * @work: work of the current pass
+ * @context: context of the current pass
+ * @items: number of work items in the pass
+ * @next: next work item to take
+ */
+typedef struct workers_s
+{
+	int threads;
+	worker_t *workers;
+	SDL_mutex *lock;
+	SDL_cond *wake;
+	SDL_cond *done;
+	unsigned int generation;
+	int busy;
+	bool stop;
+	workfunc_t work;
+	void *context;
+	int items;
+	SDL_atomic_t next;
+} workers_t;
+
+workers_t *workers_Create(int threads, const char *name);
+void workers_Run(workers_t *pool, workfunc_t work, void *context, int items);
+void workers_Destroy(workers_t *pool);
+
+#endif
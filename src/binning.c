@@ -0,0 +1,283 @@
+#include "../headers/binning.h"
+#include "../headers/raycast.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * binner_Cast - Casts the rays of one strip into the hit list, placing
+ * each wall slice the way drawTexturedWallStrips does
+ * @context: Pointer to the renderer
+ * @worker: Index of the worker, unused
+ * @strip: Index of the strip
+ *
+ * Return: void
+ */
+static void binner_Cast(void *context, int worker, int strip)
+{
+	binner_t *binner = context;
+	GameState *state = binner->state;
+	bincolumn_t *column;
+	rayhit_t ray;
+	vec_t floorPos;
+	int x, end, tileIndex, texX, level;
+
+	(void)worker;
+	end = (strip + 1) * BIN_WIDTH < SCREEN_WIDTH ? (strip + 1) * BIN_WIDTH :
+		SCREEN_WIDTH;
+	for (x = strip * BIN_WIDTH; x < end; x++)
+	{
+		column = &binner->columns[x];
+		column->texels = NULL;
+		column->drawStart = column->drawEnd = SCREEN_HEIGHT;
+		if (!castRay(state, x, &ray) || ray.map.x < 0 ||
+		    ray.map.x >= state->mapHeight || ray.map.y < 0 ||
+		    ray.map.y >= state->mapWidth)
+			continue;
+		texX = real_Floor(ray.wallX * TEXTURE_WIDTH);
+		if (texX < 0 || texX >= TEXTURE_WIDTH)
+			continue;
+		if ((ray.side == 0 && ray.direction.x > 0) ||
+		    (ray.side == 1 && ray.direction.y < 0))
+			texX = TEXTURE_WIDTH - texX - 1;
+		tileIndex = state->maze[ray.map.x * state->mapWidth + ray.map.y] - 1;
+		column->distance = ray.distance;
+		column->wallX = ray.wallX;
+		column->cell = ray.map;
+		column->side = ray.side;
+		column->sliceHeight = real_Floor(REAL_DIV(REAL_FROM_INT(SCREEN_HEIGHT),
+			ray.distance));
+		column->drawStart = -column->sliceHeight / 2 + SCREEN_HEIGHT / 2;
+		if (column->drawStart < 0)
+			column->drawStart = 0;
+		column->drawEnd = column->sliceHeight / 2 + SCREEN_HEIGHT / 2;
+		if (column->drawEnd >= SCREEN_HEIGHT)
+			column->drawEnd = SCREEN_HEIGHT - 1;
+		level = lighting_WallLevel(state->lighting, ray.map,
+			ray.side * 2 + (ray.side == 0 ? ray.direction.x >= 0 :
+			ray.direction.y >= 0), ray.wallX, ray.distance);
+		column->texels = state->shades[level][tileIndex][texX];
+		floorPos = get_EnvPixelPosition(ray.map, ray.direction, ray.wallX,
+			ray.side);
+		column->toWall.x = floorPos.x - ray.position.x;
+		column->toWall.y = floorPos.y - ray.position.y;
+		column->inverseDist = REAL_DIV(REAL_ONE, ray.distance);
+	}
+}
+
+/**
+ * binner_Wall - Draws the rows of a column that hold wall or nothing
+ * @column: Hit list entry of the column
+ * @first: First screen row to draw
+ * @last: Screen row past the last one to draw
+ * @pixel: Pixel of row @first in the tile; rows are BIN_WIDTH apart
+ *
+ * Return: void
+ */
+static void binner_Wall(const bincolumn_t *column, int first, int last,
+		pixel_t *pixel)
+{
+	const pixel_t *texels = column->texels;
+	int slice = column->sliceHeight;
+	int start = column->drawStart > first ? column->drawStart : first;
+	int end = column->drawEnd < last ? column->drawEnd : last;
+	int y, texY;
+
+	if (texels == NULL || start > end)
+		start = end = last;
+	for (y = first; y < start; y++)
+		pixel[(y - first) * BIN_WIDTH] = 0;
+	for (; y < end; y++)
+	{
+		texY = ((((y << 1) - SCREEN_HEIGHT + slice)
+			<< (int)log2(TEXTURE_HEIGHT)) / slice) >> 1;
+		pixel[(y - first) * BIN_WIDTH] = texY >= 0 && texY < TEXTURE_HEIGHT ?
+			texels[texY] : 0;
+	}
+	for (; y < last; y++)
+		pixel[(y - first) * BIN_WIDTH] = 0;
+}
+
+/**
+ * binner_Floor - Draws the floor rows of a column in a band and the
+ * ceiling rows mirroring them, the way cast_EnvTextures does
+ * @binner: Pointer to the renderer
+ * @column: Hit list entry of the column
+ * @first: First floor row of the band
+ * @last: Floor row past the band
+ * @floor: Pixel of row @first in the bottom band
+ * @ceiling: Pixel of row SCREEN_HEIGHT - @first in the top band
+ *
+ * Return: void
+ */
+static void binner_Floor(const binner_t *binner, const bincolumn_t *column,
+		int first, int last, pixel_t *floor, pixel_t *ceiling)
+{
+	const GameState *state = binner->state;
+	pixel_t (*shade)[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	const uint8_t *rowLevel;
+	const real_t *rowDistance = get_EnvRows(state, &rowLevel);
+	vec_t camera = binner->camera, toWall = column->toWall, position;
+	real_t inverseDist = column->inverseDist, weight;
+	SDL_Point tex;
+	int y;
+
+	for (y = column->drawEnd < first ? first : column->drawEnd + 1; y < last;
+	     y++)
+	{
+		weight = REAL_MUL(rowDistance[y], inverseDist);
+		position.x = camera.x + REAL_MUL(weight, toWall.x);
+		position.y = camera.y + REAL_MUL(weight, toWall.y);
+		tex.x = real_Floor(REAL_FRAC(position.x) * TEXTURE_WIDTH);
+		tex.y = real_Floor(REAL_FRAC(position.y) * TEXTURE_HEIGHT);
+		shade = state->shades[rowLevel[y]];
+		floor[(y - first) * BIN_WIDTH] = shade[4][tex.y][tex.x];
+		ceiling[(first - y) * BIN_WIDTH] = shade[5][tex.y][tex.x];
+	}
+}
+
+/**
+ * binner_Stream - Copies a row of a tile to the frame buffer. With SSE2
+ * the whole cache lines of the row are written with stores that bypass
+ * the cache; the partial lines at its ends take ordinary stores, since a
+ * streamed partial line costs more than it saves.
+ * @dst: Destination in the frame buffer
+ * @src: Row of the tile
+ * @size: Number of bytes
+ *
+ * Return: void
+ */
+static void binner_Stream(void *dst, const void *src, size_t size)
+{
+#ifdef __SSE2__
+	uint8_t *d = dst;
+	const uint8_t *s = src;
+	size_t head = (BIN_LINE - ((uintptr_t)d & (BIN_LINE - 1))) &
+		(BIN_LINE - 1);
+
+	head = head < size ? head : size;
+	memcpy(d, s, head);
+	for (d += head, s += head, size -= head; size >= BIN_LINE;
+	     d += BIN_LINE, s += BIN_LINE, size -= BIN_LINE)
+	{
+		_mm_stream_si128((__m128i *)d, _mm_loadu_si128((const __m128i *)s));
+		_mm_stream_si128((__m128i *)d + 1, _mm_loadu_si128(
+			(const __m128i *)s + 1));
+		_mm_stream_si128((__m128i *)d + 2, _mm_loadu_si128(
+			(const __m128i *)s + 2));
+		_mm_stream_si128((__m128i *)d + 3, _mm_loadu_si128(
+			(const __m128i *)s + 3));
+	}
+	memcpy(d, s, size);
+#else
+	memcpy(dst, src, size);
+#endif
+}
+
+/**
+ * binner_Raster - Draws one tile into the worker's buffer, then streams it
+ * to the frame buffer
+ * @context: Pointer to the renderer
+ * @worker: Index of the worker
+ * @tile: Index of the tile, band after band of BIN_STRIPS strips
+ *
+ * Return: void
+ */
+static void binner_Raster(void *context, int worker, int tile)
+{
+	const binner_t *binner = context;
+	bintile_t *buffer = &binner->tiles[worker];
+	const bincolumn_t *column;
+	GameState *state = binner->state;
+	int x0, width, first, last, top, bottom, c, y;
+
+	x0 = tile % BIN_STRIPS * BIN_WIDTH;
+	width = x0 + BIN_WIDTH < SCREEN_WIDTH ? BIN_WIDTH : SCREEN_WIDTH - x0;
+	first = SCREEN_HEIGHT / 2 + tile / BIN_STRIPS * BIN_ROWS;
+	last = first + BIN_ROWS < SCREEN_HEIGHT ? first + BIN_ROWS :
+		SCREEN_HEIGHT;
+	/* Ceiling rows mirror floor rows; row 0 and the horizon have no pair */
+	top = last == SCREEN_HEIGHT ? 0 : SCREEN_HEIGHT - last + 1;
+	bottom = first == SCREEN_HEIGHT / 2 ? SCREEN_HEIGHT / 2 :
+		SCREEN_HEIGHT - first + 1;
+	for (c = 0; c < width; c++)
+	{
+		column = &binner->columns[x0 + c];
+		y = SCREEN_HEIGHT - column->drawEnd > top ?
+			SCREEN_HEIGHT - column->drawEnd : top;
+		if (top == 0 && y > 0)
+			binner_Wall(column, 0, 1, &buffer->top[0][c]);
+		if (y < bottom)
+			binner_Wall(column, y, bottom, &buffer->top[y - top][c]);
+		y = column->drawEnd + 1 < last ? column->drawEnd + 1 : last;
+		binner_Wall(column, first, y, &buffer->bottom[0][c]);
+		binner_Floor(binner, column, first, last, &buffer->bottom[0][c],
+			&buffer->top[SCREEN_HEIGHT - first - top][c]);
+	}
+	for (y = top; y < bottom; y++)
+		binner_Stream(&state->screenBuffer[y][x0], buffer->top[y - top],
+			width * sizeof(pixel_t));
+	for (y = first; y < last; y++)
+		binner_Stream(&state->screenBuffer[y][x0], buffer->bottom[y - first],
+			width * sizeof(pixel_t));
+#ifdef __SSE2__
+	_mm_sfence();
+#endif
+}
+
+/**
+ * binner_Render - Draws a textured frame of the state into its frame
+ * buffer, every pixel of it
+ * @binner: Pointer to the renderer
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+void binner_Render(binner_t *binner, GameState *state)
+{
+	init_EnvRows();
+	binner->state = state;
+	binner->camera.x = REAL(state->position.x);
+	binner->camera.y = REAL(state->position.y);
+	workers_Run(binner->pool, binner_Cast, binner, BIN_STRIPS);
+	workers_Run(binner->pool, binner_Raster, binner, BIN_STRIPS * BIN_BANDS);
+}
+
+/**
+ * binner_Create - Starts a binned renderer
+ * @threads: Number of threads to render with, the caller included
+ *
+ * Return: Pointer to the renderer, or NULL on failure
+ */
+binner_t *binner_Create(int threads)
+{
+	binner_t *binner = calloc(1, sizeof(binner_t));
+
+	if (binner == NULL)
+		return (NULL);
+	binner->pool = workers_Create(threads, "binner");
+	if (binner->pool)
+		binner->tiles = calloc(binner->pool->threads, sizeof(bintile_t));
+	if (binner->tiles == NULL)
+	{
+		binner_Destroy(binner);
+		return (NULL);
+	}
+	return (binner);
+}
+
+/**
+ * binner_Destroy - Stops the worker threads and frees the renderer
+ * @binner: Pointer to the renderer, may be NULL
+ *
+ * Return: void
+ */
+void binner_Destroy(binner_t *binner)
+{
+	if (binner == NULL)
+		return;
+	workers_Destroy(binner->pool);
+	free(binner->tiles);
+	free(binner);
+}
@@ -0,0 +1,705 @@
+#include "../headers/control.h"
+#include "../headers/player.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define CONTROL_RING_SIZE (CONTROL_SLOTS * sizeof(controlslot_t))
+#define CONTROL_CAMERA_LIMIT 1024.0
+#define CONTROL_WALL_GAP 1e-3
+
+/**
+ * control_Transfer - Sends or receives bytes until all of them went through
+ * @fd: The socket
+ * @bytes: Bytes to send, or buffer receiving them
+ * @size: Number of bytes
+ * @receive: true to receive, false to send
+ *
+ * Return: true on success, false if the connection failed or closed
+ */
+static bool control_Transfer(int fd, uint8_t *bytes, size_t size,
+		bool receive)
+{
+	ssize_t done;
+
+	while (size > 0)
+	{
+		done = receive ? recv(fd, bytes, size, MSG_WAITALL) :
+			send(fd, bytes, size, MSG_NOSIGNAL);
+		if (done <= 0)
+			return (false);
+		bytes += done;
+		size -= done;
+	}
+	return (true);
+}
+
+/**
+ * control_Send - Sends a message in a single call when the socket allows
+ * @fd: The socket
+ * @header: Header of the message, @header->length bytes of payload follow
+ * @payload: The payload, may be NULL without one
+ * @memory: Descriptor to pass along with the message, or -1
+ *
+ * Return: true on success, false if the connection failed
+ */
+bool control_Send(int fd, const controlheader_t *header,
+		const void *payload, int memory)
+{
+	char buffer[CMSG_SPACE(sizeof(int))];
+	struct iovec parts[2];
+	struct msghdr message;
+	struct cmsghdr *passed;
+	ssize_t sent;
+	int part;
+
+	memset(&message, 0, sizeof(message));
+	parts[0].iov_base = (void *)header;
+	parts[0].iov_len = sizeof(controlheader_t);
+	parts[1].iov_base = (void *)payload;
+	parts[1].iov_len = header->length;
+	message.msg_iov = parts;
+	message.msg_iovlen = header->length ? 2 : 1;
+	if (memory >= 0)
+	{
+		memset(buffer, 0, sizeof(buffer));
+		message.msg_control = buffer;
+		message.msg_controllen = sizeof(buffer);
+		passed = CMSG_FIRSTHDR(&message);
+		passed->cmsg_level = SOL_SOCKET;
+		passed->cmsg_type = SCM_RIGHTS;
+		passed->cmsg_len = CMSG_LEN(sizeof(int));
+		memcpy(CMSG_DATA(passed), &memory, sizeof(int));
+	}
+	sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+	if (sent < 0)
+		return (false);
+	for (part = 0; part < (int)message.msg_iovlen; part++)
+	{
+		if ((size_t)sent < parts[part].iov_len &&
+		    !control_Transfer(fd, (uint8_t *)parts[part].iov_base + sent,
+		    parts[part].iov_len - sent, false))
+			return (false);
+		sent = (size_t)sent < parts[part].iov_len ? 0 :
+			sent - (ssize_t)parts[part].iov_len;
+	}
+	return (true);
+}
+
+/**
+ * control_Receive - Receives a message, dropping the payload bytes that
+ * do not fit
+ * @fd: The socket
+ * @header: Receives the header of the message
+ * @payload: Receives the payload
+ * @size: Size of @payload
+ * @memory: Receives a descriptor passed along with the message or -1,
+ * NULL if none is expected
+ *
+ * Return: true on success, false if the connection failed or closed
+ */
+bool control_Receive(int fd, controlheader_t *header, void *payload,
+		size_t size, int *memory)
+{
+	char buffer[CMSG_SPACE(sizeof(int))];
+	struct iovec part = {NULL, sizeof(controlheader_t)};
+	struct msghdr message;
+	struct cmsghdr *passed;
+	uint8_t rest[256];
+	size_t kept, dropped;
+	ssize_t got;
+
+	memset(&message, 0, sizeof(message));
+	part.iov_base = header;
+	message.msg_iov = &part;
+	message.msg_iovlen = 1;
+	message.msg_control = buffer;
+	message.msg_controllen = sizeof(buffer);
+	got = recvmsg(fd, &message, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+	if (memory)
+		*memory = -1;
+	passed = got > 0 ? CMSG_FIRSTHDR(&message) : NULL;
+	if (passed && passed->cmsg_level == SOL_SOCKET &&
+	    passed->cmsg_type == SCM_RIGHTS)
+	{
+		if (memory)
+			memcpy(memory, CMSG_DATA(passed), sizeof(int));
+		else
+			close(*(int *)CMSG_DATA(passed));
+	}
+	if (got <= 0 || !control_Transfer(fd, (uint8_t *)header + got,
+	    sizeof(controlheader_t) - got, true))
+		return (false);
+	kept = header->length < size ? header->length : size;
+	if (!control_Transfer(fd, payload, kept, true))
+		return (false);
+	for (dropped = header->length - kept; dropped > 0; dropped -= kept)
+	{
+		kept = dropped < sizeof(rest) ? dropped : sizeof(rest);
+		if (!control_Transfer(fd, rest, kept, true))
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * control_Reply - Answers a request of the client, dropping the client if
+ * the reply cannot be sent
+ * @control: Pointer to the control socket
+ * @request: Header of the request
+ * @status: A controlstatus_t
+ * @payload: Payload of the reply
+ * @length: Size of @payload
+ *
+ * Return: void
+ */
+static void control_Reply(control_t *control, const controlheader_t *request,
+		int status, const void *payload, size_t length)
+{
+	controlheader_t header;
+
+	header.type = request->type;
+	header.status = status;
+	header.length = length;
+	header.sequence = request->sequence;
+	if (!control_Send(control->client, &header, payload,
+	    request->type == CONTROL_HELLO ? control->memory : -1))
+	{
+		close(control->client);
+		control->client = -1;
+	}
+}
+
+/**
+ * control_State - Describes the player for a reply
+ * @control: Pointer to the control socket
+ * @state: Pointer to the GameState
+ * @reply: Receives the description
+ *
+ * Return: void
+ */
+static void control_State(control_t *control, const GameState *state,
+		controlstate_t *reply)
+{
+	memset(reply, 0, sizeof(controlstate_t));
+	reply->camera.position = state->position;
+	reply->camera.direction = state->direction;
+	reply->camera.viewPlane = state->viewPlane;
+	reply->time = state->time;
+	reply->steps = control->steps;
+	reply->slot = control->slot;
+	reply->frame = control->slot >= 0 ? control->ring[control->slot].frame : 0;
+	reply->blocked = control->blocked;
+}
+
+/**
+ * control_Bounded - Checks that values are finite and not too large
+ * @values: The values
+ * @count: Number of values
+ * @limit: Largest magnitude allowed
+ *
+ * Return: true if every value is within @limit, else false
+ */
+static bool control_Bounded(const double *values, int count, double limit)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		if (!(fabs(values[i]) <= limit))
+			return (false);
+	return (true);
+}
+
+/**
+ * control_Open - Tells whether a cell is open floor
+ * @state: Pointer to the GameState
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: true if the cell is in the map and walkable, else false
+ */
+static bool control_Open(const GameState *state, int x, int y)
+{
+	return (x >= 0 && x < state->mapHeight && y >= 0 && y < state->mapWidth &&
+		!state->maze[x * state->mapWidth + y]);
+}
+
+/**
+ * control_Cell - Finds the cell holding a coordinate, clamped to the ring
+ * of cells around the map
+ * @value: The coordinate
+ * @size: Number of cells along the axis
+ *
+ * Return: The cell, from -1 to @size
+ */
+static int control_Cell(double value, int size)
+{
+	if (value < 0)
+		return (-1);
+	return (value >= size ? size : (int)value);
+}
+
+/**
+ * control_Trace - Walks the cells a segment crosses until one is a wall.
+ * The walk ends on the cell holding the end of the segment, so a segment
+ * ending on a grid line never steps past it.
+ * @state: Pointer to the GameState
+ * @ray: The segment
+ * @hit: Receives the result
+ *
+ * Return: void
+ */
+static void control_Trace(const GameState *state, const controlray_t *ray,
+		controlhit_t *hit)
+{
+	double dx = ray->to.x - ray->from.x, dy = ray->to.y - ray->from.y;
+	double nextX, nextY, t = 0;
+	int stepX = dx < 0 ? -1 : 1, stepY = dy < 0 ? -1 : 1;
+	int endX = control_Cell(ray->to.x, state->mapHeight);
+	int endY = control_Cell(ray->to.y, state->mapWidth);
+
+	hit->cell.x = control_Cell(ray->from.x, state->mapHeight);
+	hit->cell.y = control_Cell(ray->from.y, state->mapWidth);
+	nextX = dx == 0 ? 2 : (dx < 0 ? ray->from.x - hit->cell.x :
+		hit->cell.x + 1 - ray->from.x) / fabs(dx);
+	nextY = dy == 0 ? 2 : (dy < 0 ? ray->from.y - hit->cell.y :
+		hit->cell.y + 1 - ray->from.y) / fabs(dy);
+	hit->reserved = 0;
+	while (!(hit->hit = !control_Open(state, hit->cell.x, hit->cell.y)) &&
+	       (hit->cell.x != endX || hit->cell.y != endY))
+	{
+		if (hit->cell.y == endY || (hit->cell.x != endX && nextX < nextY))
+		{
+			t = nextX;
+			nextX += 1 / fabs(dx);
+			hit->cell.x += stepX;
+		}
+		else
+		{
+			t = nextY;
+			nextY += 1 / fabs(dy);
+			hit->cell.y += stepY;
+		}
+	}
+	hit->fraction = hit->hit ? t : 1;
+}
+
+/**
+ * control_Sweep - Moves the player along a vector, stopping just short of
+ * the first wall in the way instead of jumping over it
+ * @state: Pointer to the GameState
+ * @dx: Distance to move along map rows
+ * @dy: Distance to move along map columns
+ *
+ * Return: true if the whole distance was moved, false if a wall stopped it
+ */
+static bool control_Sweep(GameState *state, double dx, double dy)
+{
+	double length = sqrt(dx * dx + dy * dy), t;
+	controlray_t ray;
+	controlhit_t hit;
+	point_t to;
+
+	if (length == 0)
+		return (true);
+	ray.from = state->position;
+	ray.to.x = ray.from.x + dx;
+	ray.to.y = ray.from.y + dy;
+	control_Trace(state, &ray, &hit);
+	t = hit.hit ? hit.fraction - CONTROL_WALL_GAP / length : 1;
+	to.x = ray.from.x + dx * t;
+	to.y = ray.from.y + dy * t;
+	if (t > 0 && control_Open(state, control_Cell(to.x, state->mapHeight),
+		control_Cell(to.y, state->mapWidth)))
+		state->position = to;
+	return (!hit.hit);
+}
+
+/**
+ * control_Serve - Answers a request that does not step the game
+ * @control: Pointer to the control socket
+ * @state: Pointer to the GameState
+ * @header: Header of the request, its payload is in @control->request
+ *
+ * Return: void
+ */
+static void control_Serve(control_t *control, GameState *state,
+		const controlheader_t *header)
+{
+	controlinfo_t info = {CONTROL_VERSION, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT,
+		sizeof(pixel_t), CONTROL_SLOTS, sizeof(controlslot_t)};
+	int status = CONTROL_OK, rays = header->length / sizeof(controlray_t), i;
+	controlcamera_t camera;
+	controlstate_t reply;
+	controlmove_t move;
+	double values[4];
+	controlray_t ray;
+	controlhit_t hit;
+
+	control->slot = -1;
+	control->blocked = false;
+	switch (header->length == 0 ? header->type : 0)
+	{
+	case CONTROL_HELLO:
+		info.mapWidth = state->mapWidth;
+		info.mapHeight = state->mapHeight;
+		control_Reply(control, header, CONTROL_OK, &info, sizeof(info));
+		return;
+	case CONTROL_QUIT:
+		control_Reply(control, header, CONTROL_OK, NULL, 0);
+		state->quit = 1;
+		return;
+	case CONTROL_QUERY:
+		break;
+	default:
+		status = CONTROL_BAD_REQUEST;
+	}
+	if (header->type == CONTROL_SET_CAMERA &&
+	    header->length == sizeof(camera))
+	{
+		memcpy(&camera, control->request, sizeof(camera));
+		values[0] = camera.direction.x;
+		values[1] = camera.direction.y;
+		values[2] = camera.viewPlane.x;
+		values[3] = camera.viewPlane.y;
+		status = CONTROL_IN_WALL;
+		if (!control_Bounded(values, 4, CONTROL_CAMERA_LIMIT) ||
+		    !control_Bounded(&camera.position.x, 1, DBL_MAX) ||
+		    !control_Bounded(&camera.position.y, 1, DBL_MAX))
+			status = CONTROL_BAD_REQUEST;
+		else if (control_Open(state, control_Cell(camera.position.x,
+			 state->mapHeight), control_Cell(camera.position.y,
+			 state->mapWidth)))
+		{
+			state->position = camera.position;
+			state->direction = camera.direction;
+			state->viewPlane = camera.viewPlane;
+			status = CONTROL_OK;
+		}
+	}
+	else if (header->type == CONTROL_MOVE && header->length == sizeof(move))
+	{
+		memcpy(&move, control->request, sizeof(move));
+		status = CONTROL_BAD_REQUEST;
+		values[0] = move.forward;
+		values[1] = move.strafe;
+		values[2] = move.turn;
+		if (control_Bounded(values, 3, state->mapWidth + state->mapHeight))
+		{
+			control->blocked = !control_Sweep(state,
+				state->direction.x * move.forward,
+				state->direction.y * move.forward);
+			control->blocked |= !control_Sweep(state,
+				state->viewPlane.x * move.strafe,
+				state->viewPlane.y * move.strafe);
+			rotatePlayer(state, move.turn, 1);
+			status = CONTROL_OK;
+		}
+	}
+	else if (header->type == CONTROL_TRACE && rays > 0 &&
+		 header->length == rays * sizeof(controlray_t))
+	{
+		for (i = 0; i < rays; i++)
+		{
+			memcpy(&ray, control->request + i * sizeof(ray), sizeof(ray));
+			values[0] = ray.from.x;
+			values[1] = ray.from.y;
+			values[2] = ray.to.x;
+			values[3] = ray.to.y;
+			if (!control_Bounded(values, 4, DBL_MAX))
+				break;
+			control_Trace(state, &ray, &hit);
+			memcpy(control->reply + i * sizeof(hit), &hit, sizeof(hit));
+		}
+		if (i == rays)
+		{
+			control_Reply(control, header, CONTROL_OK, control->reply,
+				rays * sizeof(hit));
+			return;
+		}
+		status = CONTROL_BAD_REQUEST;
+	}
+	control_State(control, state, &reply);
+	control_Reply(control, header, status, &reply, sizeof(reply));
+}
+
+/**
+ * control_Accept - Takes the next client waiting to connect
+ * @control: Pointer to the control socket
+ * @wait: true to wait for a client, false to return at once
+ *
+ * Return: true if a client connected, else false
+ */
+static bool control_Accept(control_t *control, bool wait)
+{
+	struct pollfd ready = {0, POLLIN, 0};
+
+	ready.fd = control->listener;
+	if (poll(&ready, 1, wait ? -1 : 0) <= 0)
+		return (false);
+	control->client = accept(control->listener, NULL, NULL);
+	return (control->client >= 0);
+}
+
+/**
+ * control_Next - Answers the last step, then serves the client until it
+ * asks for the next one. Without a window this waits for the client; with
+ * one it returns when no request is waiting, so the window stays live.
+ * @control: Pointer to the control socket, may be NULL
+ * @state: Pointer to the GameState
+ * @input: Receives the INPUT_* bits of the step
+ * @elapsed: Receives the timestep of the step, in ms
+ *
+ * Return: true if a step is to be taken, else false
+ */
+bool control_Next(control_t *control, GameState *state, uint8_t *input,
+		uint16_t *elapsed)
+{
+	struct pollfd ready = {0, POLLIN, 0};
+	controlheader_t header;
+	controlstate_t reply;
+	controlstep_t step;
+
+	if (control == NULL)
+		return (false);
+	if (control->pending.type && control->client >= 0)
+	{
+		control_State(control, state, &reply);
+		control_Reply(control, &control->pending, CONTROL_OK, &reply,
+			sizeof(reply));
+	}
+	control->pending.type = 0;
+	control->render = false;
+	while (!state->quit)
+	{
+		if (control->client < 0 && !control_Accept(control, !state->window))
+			return (false);
+		ready.fd = control->client;
+		if (state->window && poll(&ready, 1, 0) <= 0)
+			return (false);
+		if (!control_Receive(control->client, &header, control->request,
+		    sizeof(control->request), NULL))
+		{
+			close(control->client);
+			control->client = -1;
+		}
+		else if (header.type == CONTROL_STEP &&
+			 header.length == sizeof(controlstep_t))
+		{
+			memcpy(&step, control->request, sizeof(step));
+			control->pending = header;
+			control->render = step.render != 0;
+			control->slot = -1;
+			control->steps++;
+			*input = step.input;
+			*elapsed = step.elapsed;
+			return (true);
+		}
+		else
+			control_Serve(control, state, &header);
+	}
+	return (false);
+}
+
+/**
+ * control_Frame - Copies the finished frame into the ring if the step
+ * being taken asked for it
+ * @control: Pointer to the control socket, may be NULL
+ * @state: Pointer to the GameState holding the frame
+ *
+ * Return: void
+ */
+void control_Frame(control_t *control, const GameState *state)
+{
+	controlslot_t *slot;
+
+	if (control == NULL || !control->render || control->slot >= 0)
+		return;
+	control->slot = control->frames % CONTROL_SLOTS;
+	slot = &control->ring[control->slot];
+	slot->frame = control->frames++;
+#ifdef MAZE_PALETTE
+	memcpy(slot->palette, state->palette, sizeof(slot->palette));
+#endif
+	memcpy(slot->pixels, state->screenBuffer, sizeof(slot->pixels));
+}
+
+/**
+ * control_Start - Opens the control socket and its frame ring
+ * @path: Path to bind the socket to; a socket left there is replaced
+ *
+ * Return: Pointer to the control socket, or NULL on failure
+ */
+control_t *control_Start(const char *path)
+{
+	control_t *control = calloc(1, sizeof(control_t));
+	struct sockaddr_un address;
+	char name[] = "/dev/shm/mazzerre.XXXXXX";
+	struct stat existing;
+	void *ring = MAP_FAILED;
+	bool bound = false;
+
+	if (control == NULL)
+		return (NULL);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	control->path = strdup(path);
+	control->listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	control->memory = mkstemp(name);
+	control->client = -1;
+	control->slot = -1;
+	if (control->memory >= 0)
+		unlink(name);
+	if (control->path && strlen(path) < sizeof(address.sun_path) &&
+	    control->listener >= 0 && control->memory >= 0)
+	{
+		strcpy(address.sun_path, path);
+		if (stat(path, &existing) == 0 && S_ISSOCK(existing.st_mode))
+			unlink(path);
+		bound = bind(control->listener, (struct sockaddr *)&address,
+			sizeof(address)) == 0;
+	}
+	if (bound && listen(control->listener, 1) == 0 &&
+	    ftruncate(control->memory, CONTROL_RING_SIZE) == 0)
+		ring = mmap(NULL, CONTROL_RING_SIZE, PROT_READ | PROT_WRITE,
+			MAP_SHARED, control->memory, 0);
+	if (ring == MAP_FAILED)
+	{
+		fprintf(stderr, "Error: Unable to open control socket %s\n", path);
+		if (bound)
+			unlink(path);
+		if (control->listener >= 0)
+			close(control->listener);
+		if (control->memory >= 0)
+			close(control->memory);
+		free(control->path);
+		free(control);
+		return (NULL);
+	}
+	control->ring = ring;
+	return (control);
+}
+
+/**
+ * control_Stop - Closes the control socket and frees it
+ * @control: Pointer to the control socket, may be NULL
+ *
+ * Return: void
+ */
+void control_Stop(control_t *control)
+{
+	if (control == NULL)
+		return;
+	if (control->client >= 0)
+		close(control->client);
+	close(control->listener);
+	unlink(control->path);
+	munmap(control->ring, CONTROL_RING_SIZE);
+	close(control->memory);
+	free(control->path);
+	free(control);
+}
+
+#else
+
+/**
+ * control_Send - Unix sockets are only used on Linux
+ * @fd: The socket
+ * @header: Header of the message
+ * @payload: The payload
+ * @memory: Descriptor to pass along
+ *
+ * Return: false
+ */
+bool control_Send(int fd, const controlheader_t *header,
+		const void *payload, int memory)
+{
+	(void)fd;
+	(void)header;
+	(void)payload;
+	(void)memory;
+	return (false);
+}
+
+/**
+ * control_Receive - Unix sockets are only used on Linux
+ * @fd: The socket
+ * @header: Receives the header
+ * @payload: Receives the payload
+ * @size: Size of @payload
+ * @memory: Receives a passed descriptor
+ *
+ * Return: false
+ */
+bool control_Receive(int fd, controlheader_t *header, void *payload,
+		size_t size, int *memory)
+{
+	(void)fd;
+	(void)header;
+	(void)payload;
+	(void)size;
+	(void)memory;
+	return (false);
+}
+
+/**
+ * control_Start - The control socket needs Linux
+ * @path: Path to bind the socket to
+ *
+ * Return: NULL
+ */
+control_t *control_Start(const char *path)
+{
+	fprintf(stderr, "Error: Unable to open control socket %s\n", path);
+	return (NULL);
+}
+
+/**
+ * control_Next - Nothing to serve without a control socket
+ * @control: NULL
+ * @state: Pointer to the GameState
+ * @input: Receives the INPUT_* bits of the step
+ * @elapsed: Receives the timestep of the step
+ *
+ * Return: false
+ */
+bool control_Next(control_t *control, GameState *state, uint8_t *input,
+		uint16_t *elapsed)
+{
+	(void)control;
+	(void)state;
+	(void)input;
+	(void)elapsed;
+	return (false);
+}
+
+/**
+ * control_Frame - Nothing to copy without a control socket
+ * @control: NULL
+ * @state: Pointer to the GameState
+ *
+ * Return: void
+ */
+void control_Frame(control_t *control, const GameState *state)
+{
+	(void)control;
+	(void)state;
+}
+
+/**
+ * control_Stop - Nothing to close without a control socket
+ * @control: NULL
+ *
+ * Return: void
+ */
+void control_Stop(control_t *control)
+{
+	(void)control;
+}
+
+#endif
@@ -0,0 +1,166 @@
+#include "../headers/control.h"
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * control_Connect - Connects to the control socket of a game and maps its
+ * frame ring
+ * @path: Path of the socket
+ *
+ * Return: Pointer to the connection, or NULL on failure
+ */
+controlclient_t *control_Connect(const char *path)
+{
+	controlclient_t *client = calloc(1, sizeof(controlclient_t));
+	struct sockaddr_un address;
+	controlheader_t header;
+	void *ring = MAP_FAILED;
+	int memory = -1;
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (client == NULL || strlen(path) >= sizeof(address.sun_path))
+	{
+		free(client);
+		return (NULL);
+	}
+	strcpy(address.sun_path, path);
+	client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (client->fd >= 0 && connect(client->fd, (struct sockaddr *)&address,
+	    sizeof(address)) == 0 && control_Post(client, CONTROL_HELLO, NULL, 0) &&
+	    control_Receive(client->fd, &header, &client->info,
+	    sizeof(client->info), &memory) && header.status == CONTROL_OK &&
+	    header.length == sizeof(controlinfo_t) &&
+	    client->info.version == CONTROL_VERSION &&
+	    client->info.slots == CONTROL_SLOTS &&
+	    client->info.slotSize == sizeof(controlslot_t) && memory >= 0)
+		ring = mmap(NULL, CONTROL_SLOTS * sizeof(controlslot_t), PROT_READ,
+			MAP_SHARED, memory, 0);
+	if (memory >= 0)
+		close(memory);
+	if (ring == MAP_FAILED)
+	{
+		if (client->fd >= 0)
+			close(client->fd);
+		free(client);
+		return (NULL);
+	}
+	client->ring = ring;
+	return (client);
+}
+
+/**
+ * control_Post - Sends a request without waiting for its reply, so
+ * requests to several games can be in flight at once
+ * @client: Pointer to the connection
+ * @type: Type of the request
+ * @payload: Payload of the request, may be NULL without one
+ * @length: Size of @payload
+ *
+ * Return: true on success, false if the connection failed
+ */
+bool control_Post(controlclient_t *client, controltype_t type,
+		const void *payload, uint16_t length)
+{
+	controlheader_t header;
+
+	header.type = type;
+	header.status = 0;
+	header.length = length;
+	header.sequence = client->sequence++;
+	return (control_Send(client->fd, &header, payload, -1));
+}
+
+/**
+ * control_Wait - Receives the reply to the oldest request posted
+ * @client: Pointer to the connection
+ * @header: Receives the header of the reply
+ * @reply: Receives the payload, cut to @size bytes
+ * @size: Size of @reply
+ *
+ * Return: true on success, false if the connection failed
+ */
+bool control_Wait(controlclient_t *client, controlheader_t *header,
+		void *reply, size_t size)
+{
+	return (control_Receive(client->fd, header, reply, size, NULL));
+}
+
+/**
+ * control_Request - Sends a request and waits for its reply
+ * @client: Pointer to the connection
+ * @type: Type of the request
+ * @payload: Payload of the request, may be NULL without one
+ * @length: Size of @payload
+ * @reply: Receives the payload of the reply, cut to @size bytes
+ * @size: Size of @reply
+ *
+ * Return: Status of the reply, or -1 if the connection failed
+ */
+int control_Request(controlclient_t *client, controltype_t type,
+		const void *payload, uint16_t length, void *reply, size_t size)
+{
+	controlheader_t header;
+
+	if (!control_Post(client, type, payload, length) ||
+	    !control_Wait(client, &header, reply, size) || header.type != type)
+		return (-1);
+	return (header.status);
+}
+
+/**
+ * control_Step - Steps the game and waits until it is done
+ * @client: Pointer to the connection
+ * @input: INPUT_* bits held during the step
+ * @elapsed: Time the step advances the game, in ms
+ * @render: true to render the frame after the step into the ring
+ * @state: Receives the player after the step
+ *
+ * Return: true on success, else false
+ */
+bool control_Step(controlclient_t *client, uint8_t input, uint16_t elapsed,
+		bool render, controlstate_t *state)
+{
+	controlstep_t step;
+
+	step.input = input;
+	step.render = render;
+	step.elapsed = elapsed;
+	return (control_Request(client, CONTROL_STEP, &step, sizeof(step), state,
+		sizeof(controlstate_t)) == CONTROL_OK);
+}
+
+/**
+ * control_Slot - Finds the frame a reply refers to, in place in the ring
+ * @client: Pointer to the connection
+ * @state: Reply to a step that asked for a frame
+ *
+ * Return: The slot, or NULL if the reply has no frame or a later step
+ * has written over it
+ */
+const controlslot_t *control_Slot(const controlclient_t *client,
+		const controlstate_t *state)
+{
+	if (state->slot < 0 || state->slot >= CONTROL_SLOTS ||
+	    client->ring[state->slot].frame != state->frame)
+		return (NULL);
+	return (&client->ring[state->slot]);
+}
+
+/**
+ * control_Disconnect - Closes a connection; the game waits for the next
+ * client
+ * @client: Pointer to the connection, may be NULL
+ *
+ * Return: void
+ */
+void control_Disconnect(controlclient_t *client)
+{
+	if (client == NULL)
+		return;
+	munmap((void *)client->ring, CONTROL_SLOTS * sizeof(controlslot_t));
+	close(client->fd);
+	free(client);
+}
@@ -0,0 +1,370 @@
+#include "../headers/crowd.h"
+#include "../headers/navigation.h"
+
+#define CROWD_CELL (2 * CROWD_MAX_RADIUS)
+
+/**
+ * crowd_PushOut - Pushes a circle out of the wall cells it overlaps
+ * @maze: Pointer to the maze
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ * @x: Row coordinate of the centre, updated
+ * @y: Column coordinate of the centre, updated
+ * @radius: Radius of the circle
+ *
+ * Return: true if a wall was touched, else false
+ */
+static bool crowd_PushOut(const int *maze, int width, int height, double *x,
+		double *y, double radius)
+{
+	int cx, cy, x0 = (int)floor(*x - radius), y0 = (int)floor(*y - radius);
+	int x1 = (int)floor(*x + radius), y1 = (int)floor(*y + radius);
+	double qx, qy, dx, dy, d;
+	bool touched = false;
+
+	for (cx = x0; cx <= x1; cx++)
+		for (cy = y0; cy <= y1; cy++)
+		{
+			if (nav_IsWalkable(maze, width, height, cx, cy))
+				continue;
+			/* Closest point of the cell to the centre */
+			qx = *x < cx ? cx : *x > cx + 1 ? cx + 1 : *x;
+			qy = *y < cy ? cy : *y > cy + 1 ? cy + 1 : *y;
+			dx = *x - qx;
+			dy = *y - qy;
+			d = dx * dx + dy * dy;
+			if (d >= radius * radius)
+				continue;
+			touched = true;
+			if (d > 1e-18)
+			{
+				d = sqrt(d);
+				*x += dx / d * (radius - d);
+				*y += dy / d * (radius - d);
+			}
+			else if (fmin(*x - cx, cx + 1 - *x) < fmin(*y - cy, cy + 1 - *y))
+				*x = *x - cx < cx + 1 - *x ? cx - radius : cx + 1 + radius;
+			else
+				*y = *y - cy < cy + 1 - *y ? cy - radius : cy + 1 + radius;
+		}
+	return (touched);
+}
+
+/**
+ * crowd_Slide - Moves a circle through the maze, sliding along the walls
+ * it touches. The move is made in steps of at most half the radius, so
+ * the circle never skips over a wall.
+ * @maze: Pointer to the maze, where nonzero cells are walls
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ * @x: Row coordinate of the centre, updated
+ * @y: Column coordinate of the centre, updated
+ * @dx: Move along the rows
+ * @dy: Move along the columns
+ * @radius: Radius of the circle, between 0 and CROWD_MAX_RADIUS
+ *
+ * Return: true if the whole move was made, false if a wall changed it
+ */
+bool crowd_Slide(const int *maze, int width, int height, double *x,
+		double *y, double dx, double dy, double radius)
+{
+	int steps = (int)ceil(sqrt(dx * dx + dy * dy) / (radius / 2));
+	bool touched = false;
+	int i;
+
+	for (i = 0; i < steps; i++)
+	{
+		*x += dx / steps;
+		*y += dy / steps;
+		touched |= crowd_PushOut(maze, width, height, x, y, radius);
+	}
+	return (!touched);
+}
+
+/**
+ * crowd_Key - Finds the bucket of a grid cell. Cells are numbered row by
+ * row and wrapped around the table, so the cells of a row next to each
+ * other land in buckets next to each other.
+ * @crowd: Pointer to the crowd
+ * @cx: Row of the grid cell
+ * @cy: Column of the grid cell
+ *
+ * Return: Index of the bucket
+ */
+static uint32_t crowd_Key(const crowd_t *crowd, int cx, int cy)
+{
+	return (((uint32_t)cx * crowd->stride + (uint32_t)cy) & crowd->mask);
+}
+
+/**
+ * crowd_Last - Finds the end of a chunk of agents
+ * @crowd: Pointer to the crowd
+ * @chunk: Index of the chunk
+ *
+ * Return: Index past the last agent of the chunk
+ */
+static int crowd_Last(const crowd_t *crowd, int chunk)
+{
+	return (crowd->count - chunk * CROWD_CHUNK > CROWD_CHUNK ?
+		(chunk + 1) * CROWD_CHUNK : crowd->count);
+}
+
+/**
+ * crowd_Hash - Finds the bucket of a chunk of agents
+ * @context: Pointer to the crowd
+ * @worker: Index of the worker, unused
+ * @chunk: Index of the chunk
+ *
+ * Return: void
+ */
+static void crowd_Hash(void *context, int worker, int chunk)
+{
+	crowd_t *crowd = context;
+	int i, last = crowd_Last(crowd, chunk);
+
+	(void)worker;
+	for (i = chunk * CROWD_CHUNK; i < last; i++)
+		crowd->keys[i] = crowd_Key(crowd, (int)(crowd->x[i] / CROWD_CELL),
+			(int)(crowd->y[i] / CROWD_CELL));
+}
+
+/**
+ * crowd_Sort - Sorts the agents by bucket, filling @start and @order
+ * @crowd: Pointer to the crowd
+ *
+ * Return: void
+ */
+static void crowd_Sort(crowd_t *crowd)
+{
+	uint32_t k, sum = 0;
+	int i;
+
+	memset(crowd->start, 0, (crowd->mask + 2) * sizeof(uint32_t));
+	for (i = 0; i < crowd->count; i++)
+		crowd->start[crowd->keys[i]]++;
+	for (k = 0; k <= crowd->mask + 1; k++)
+	{
+		sum += crowd->start[k];
+		crowd->start[k] = sum;
+	}
+	/* Filled backwards, each bucket lists its agents in order */
+	for (i = crowd->count - 1; i >= 0; i--)
+		crowd->order[--crowd->start[crowd->keys[i]]] = i;
+}
+
+/**
+ * crowd_Separate - Sums the pushes that move an agent out of the agents
+ * it overlaps, half the overlap each, the other agent taking the other
+ * half in its own update
+ * @crowd: Pointer to the crowd
+ * @i: Index of the agent
+ * @sx: Receives the push along the rows
+ * @sy: Receives the push along the columns
+ *
+ * Return: void
+ */
+static void crowd_Separate(const crowd_t *crowd, int i, double *sx,
+		double *sy)
+{
+	int cx = (int)(crowd->x[i] / CROWD_CELL);
+	int cy = (int)(crowd->y[i] / CROWD_CELL);
+	uint32_t keys[9], k, e;
+	double dx, dy, d, reach;
+	int n, m, j;
+
+	*sx = *sy = 0;
+	for (n = 0; n < 9; n++)
+	{
+		keys[n] = crowd_Key(crowd, cx + n / 3 - 1, cy + n % 3 - 1);
+		for (m = 0; m < n && keys[m] != keys[n]; m++)
+			;
+		if (m < n)
+			continue;
+		for (e = crowd->start[keys[n]], k = crowd->start[keys[n] + 1]; e < k;
+		     e++)
+		{
+			j = crowd->order[e];
+			dx = crowd->x[i] - crowd->x[j];
+			dy = crowd->y[i] - crowd->y[j];
+			reach = crowd->radius[i] + crowd->radius[j];
+			d = dx * dx + dy * dy;
+			if (j == i || d >= reach * reach)
+				continue;
+			if (d > 1e-18)
+			{
+				d = sqrt(d);
+				*sx += dx / d * (reach - d) / 2;
+				*sy += dy / d * (reach - d) / 2;
+			}
+			else
+				*sx += i < j ? -reach / 2 : reach / 2;
+		}
+	}
+}
+
+/**
+ * crowd_Move - Separates and moves a chunk of agents, taken in bucket
+ * order so that agents close together are updated together
+ * @context: Pointer to the crowd
+ * @worker: Index of the worker, unused
+ * @chunk: Index of the chunk of entries of @order
+ *
+ * Return: void
+ */
+static void crowd_Move(void *context, int worker, int chunk)
+{
+	crowd_t *crowd = context;
+	int e, i, last = crowd_Last(crowd, chunk);
+	double sx, sy, push, x, y;
+
+	(void)worker;
+	for (e = chunk * CROWD_CHUNK; e < last; e++)
+	{
+		i = crowd->order[e];
+		crowd_Separate(crowd, i, &sx, &sy);
+		/* A packed crowd spreads out over several ticks */
+		push = sqrt(sx * sx + sy * sy);
+		if (push > crowd->radius[i])
+		{
+			sx *= crowd->radius[i] / push;
+			sy *= crowd->radius[i] / push;
+		}
+		x = crowd->x[i];
+		y = crowd->y[i];
+		crowd->blocked[i] = !crowd_Slide(crowd->maze, crowd->width,
+			crowd->height, &x, &y, crowd->vx[i] * crowd->seconds + sx,
+			crowd->vy[i] * crowd->seconds + sy, crowd->radius[i]);
+		crowd->nextX[i] = x;
+		crowd->nextY[i] = y;
+	}
+}
+
+/**
+ * crowd_Update - Moves every agent of the crowd by one tick
+ * @crowd: Pointer to the crowd
+ * @seconds: Length of the tick
+ *
+ * Return: void
+ */
+void crowd_Update(crowd_t *crowd, double seconds)
+{
+	double *swap;
+	int chunks;
+
+	if (crowd->count == 0)
+		return;
+	crowd->seconds = seconds;
+	chunks = (crowd->count + CROWD_CHUNK - 1) / CROWD_CHUNK;
+	workers_Run(crowd->pool, crowd_Hash, crowd, chunks);
+	crowd_Sort(crowd);
+	workers_Run(crowd->pool, crowd_Move, crowd, chunks);
+	swap = crowd->x;
+	crowd->x = crowd->nextX;
+	crowd->nextX = swap;
+	swap = crowd->y;
+	crowd->y = crowd->nextY;
+	crowd->nextY = swap;
+}
+
+/**
+ * crowd_Add - Adds a standing agent to the crowd
+ * @crowd: Pointer to the crowd
+ * @x: Row coordinate of the agent
+ * @y: Column coordinate of the agent
+ * @radius: Radius of the agent, above 0 and at most CROWD_MAX_RADIUS
+ *
+ * Return: Index of the agent, or -1 if the crowd is full, the radius is
+ * out of range or the agent does not fit between the walls there
+ */
+int crowd_Add(crowd_t *crowd, double x, double y, double radius)
+{
+	double fitX = x, fitY = y;
+	int i = crowd->count;
+
+	if (i == crowd->capacity || !(radius > 0 && radius <= CROWD_MAX_RADIUS) ||
+	    !nav_IsWalkable(crowd->maze, crowd->width, crowd->height, (int)floor(x),
+	    (int)floor(y)) || crowd_PushOut(crowd->maze, crowd->width,
+	    crowd->height, &fitX, &fitY, radius))
+		return (-1);
+	crowd->x[i] = x;
+	crowd->y[i] = y;
+	crowd->vx[i] = 0;
+	crowd->vy[i] = 0;
+	crowd->radius[i] = radius;
+	crowd->blocked[i] = 0;
+	crowd->count++;
+	return (i);
+}
+
+/**
+ * crowd_Create - Creates an empty crowd and starts its worker threads
+ * @maze: Pointer to the maze, where nonzero cells are walls
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ * @capacity: Largest number of agents
+ * @threads: Number of threads to update with, the caller included
+ *
+ * Return: Pointer to the crowd, or NULL on failure
+ */
+crowd_t *crowd_Create(const int *maze, int width, int height, int capacity,
+		int threads)
+{
+	crowd_t *crowd = calloc(1, sizeof(crowd_t));
+	size_t n = capacity > 0 ? capacity : 1;
+
+	if (crowd == NULL)
+		return (NULL);
+	crowd->maze = maze;
+	crowd->width = width;
+	crowd->height = height;
+	crowd->capacity = n;
+	for (crowd->mask = 1; crowd->mask < 2 * n; crowd->mask <<= 1)
+		;
+	crowd->mask--;
+	crowd->stride = (uint32_t)(width / CROWD_CELL) + 2;
+	crowd->x = malloc(n * sizeof(double));
+	crowd->y = malloc(n * sizeof(double));
+	crowd->vx = malloc(n * sizeof(double));
+	crowd->vy = malloc(n * sizeof(double));
+	crowd->radius = malloc(n * sizeof(double));
+	crowd->blocked = malloc(n);
+	crowd->nextX = malloc(n * sizeof(double));
+	crowd->nextY = malloc(n * sizeof(double));
+	crowd->keys = malloc(n * sizeof(uint32_t));
+	crowd->start = malloc((crowd->mask + 2) * sizeof(uint32_t));
+	crowd->order = malloc(n * sizeof(uint32_t));
+	if (!crowd->x || !crowd->y || !crowd->vx || !crowd->vy ||
+	    !crowd->radius || !crowd->blocked || !crowd->nextX ||
+	    !crowd->nextY || !crowd->keys || !crowd->start || !crowd->order ||
+	    (crowd->pool = workers_Create(threads, "crowd")) == NULL)
+	{
+		crowd_Destroy(crowd);
+		return (NULL);
+	}
+	return (crowd);
+}
+
+/**
+ * crowd_Destroy - Stops the worker threads and frees the crowd
+ * @crowd: Pointer to the crowd, may be NULL
+ *
+ * Return: void
+ */
+void crowd_Destroy(crowd_t *crowd)
+{
+	if (crowd == NULL)
+		return;
+	workers_Destroy(crowd->pool);
+	free(crowd->order);
+	free(crowd->start);
+	free(crowd->keys);
+	free(crowd->nextY);
+	free(crowd->nextX);
+	free(crowd->blocked);
+	free(crowd->radius);
+	free(crowd->vy);
+	free(crowd->vx);
+	free(crowd->y);
+	free(crowd->x);
+	free(crowd);
+}
@@ -1,5 +1,9 @@
 #include "../headers/graphics.h"
 #include "../headers/defs.h"
+#include "../headers/palette.h"
+#include "../headers/stream.h"
+#include "../headers/control.h"
+#include "../headers/metrics.h"
 
 /**
  * init_SDLInstance - Initialize SDL window and renderer
@@ -65,6 +69,30 @@ void destroy_SDLInstance(GameState *state)
 	SDL_Quit();
 }
 
+/**
+ * present_Buffer - Copies screenBuffer into the streaming texture,
+ * expanding palette indices to xRGB in palette builds
+ * @state: Pointer to the GameState structure
+ * Return: void
+ */
+static void present_Buffer(GameState *state)
+{
+#ifdef MAZE_PALETTE
+	void *pixels;
+	int pitch, y;
+
+	if (SDL_LockTexture(state->texture, NULL, &pixels, &pitch) != 0)
+		return;
+	for (y = 0; y < SCREEN_HEIGHT; y++)
+		palette_Expand(state->palette, state->screenBuffer[y],
+			(uint32_t *)((uint8_t *)pixels + y * pitch), SCREEN_WIDTH);
+	SDL_UnlockTexture(state->texture);
+#else
+	SDL_UpdateTexture(state->texture, NULL, state->screenBuffer,
+		SCREEN_WIDTH * sizeof(pixel_t));
+#endif
+}
+
 /**
  * update_SDLFrames - Updating renderer with updated buffer / texture
  * @state: Pointer to the GameState structure
@@ -73,31 +101,41 @@ void destroy_SDLInstance(GameState *state)
  */
 void update_SDLFrames(GameState *state, int textured)
 {
-	int x, y;
-
-	if (!state || !state->renderer)
+	if (!state)
 	{
 		return;  /* Check for NULL pointers */
 	}
+	metrics_UploadStart(state->metrics);
+
+	/* Hand the finished frame to the video output and control ring */
+	if (textured)
+	{
+		stream_Frame(state->stream, state);
+		control_Frame(state->control, state);
+	}
+
+	/* Headless: nothing to present, only start the next frame clean */
+	if (!state->renderer)
+	{
+		if (textured && !state->binner)
+			memset(state->screenBuffer, 0, sizeof(state->screenBuffer));
+		metrics_Presented(state->metrics);
+		return;
+	}
 
 	/* Draw buffer to renderer */
 	if (textured && state->texture)
 	{
-		SDL_UpdateTexture(state->texture, NULL, state->screenBuffer,
-			SCREEN_WIDTH * 4);
+		present_Buffer(state);
 		SDL_RenderClear(state->renderer);
 		SDL_RenderCopy(state->renderer, state->texture, NULL, NULL);
 
-		/* Clear buffer */
-		for (x = 0; x < SCREEN_WIDTH; x++)
-		{
-			for (y = 0; y < SCREEN_HEIGHT; y++)
-			{
-				state->screenBuffer[y][x] = 0;
-			}
-		}
+		/* Clear buffer; the binned renderer writes every pixel itself */
+		if (!state->binner)
+			memset(state->screenBuffer, 0, sizeof(state->screenBuffer));
 	}
 
 	/* Update screen */
 	SDL_RenderPresent(state->renderer);
+	metrics_Presented(state->metrics);
 }
@@ -0,0 +1,298 @@
+#include "../headers/navigation.h"
+
+#define JPS_SQRT2 1.41421356f
+
+/**
+ * jps_Walkable - Checks if a cell of the searched maze can be entered
+ * @s: Pointer to the search context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: true if the cell is walkable, else false
+ */
+static bool jps_Walkable(const jpsearch_t *s, int x, int y)
+{
+	return (nav_IsWalkable(s->maze, s->width, s->height, x, y));
+}
+
+/**
+ * jps_HeapPush - Adds a cell to the open list
+ * @s: Pointer to the search context
+ * @cell: Index of the cell
+ * @cost: Estimated total cost through the cell
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool jps_HeapPush(jpsearch_t *s, int cell, float cost)
+{
+	heapnode_t *grown, node;
+	int i = s->heapSize++;
+
+	if (s->heapSize > s->heapCapacity)
+	{
+		s->heapCapacity = s->heapCapacity ? s->heapCapacity * 2 : 256;
+		grown = realloc(s->heap, s->heapCapacity * sizeof(heapnode_t));
+		if (grown == NULL)
+		{
+			s->heapSize--;
+			return (false);
+		}
+		s->heap = grown;
+	}
+	node.cost = cost;
+	node.cell = cell;
+	while (i > 0 && s->heap[(i - 1) / 2].cost > cost)
+	{
+		s->heap[i] = s->heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	s->heap[i] = node;
+	return (true);
+}
+
+/**
+ * jps_HeapPop - Removes the cheapest cell from the open list
+ * @s: Pointer to the search context, the list must not be empty
+ *
+ * Return: Index of the cell
+ */
+static int jps_HeapPop(jpsearch_t *s)
+{
+	int cell = s->heap[0].cell, i = 0, child;
+	heapnode_t last = s->heap[--s->heapSize];
+
+	while ((child = 2 * i + 1) < s->heapSize)
+	{
+		if (child + 1 < s->heapSize &&
+		    s->heap[child + 1].cost < s->heap[child].cost)
+			child++;
+		if (s->heap[child].cost >= last.cost)
+			break;
+		s->heap[i] = s->heap[child];
+		i = child;
+	}
+	s->heap[i] = last;
+	return (cell);
+}
+
+/**
+ * jps_Jump - Walks from a cell in one direction until it reaches the goal,
+ * a wall, or a cell with a forced neighbour. Diagonal moves may not cut
+ * wall corners, so a diagonal step needs both orthogonal cells open.
+ * @s: Pointer to the search context
+ * @x: Row of the first cell of the walk
+ * @y: Column of the first cell of the walk
+ * @dir: Step direction, one of the eight grid neighbours
+ * @goal: Goal cell of the search
+ *
+ * Return: Index of the jump point found, or -1
+ */
+static int jps_Jump(const jpsearch_t *s, int x, int y, SDL_Point dir,
+		SDL_Point goal)
+{
+	SDL_Point rowDir = {dir.x, 0}, colDir = {0, dir.y};
+
+	while (jps_Walkable(s, x, y))
+	{
+		if (x == goal.x && y == goal.y)
+			return (x * s->width + y);
+		if (dir.x && dir.y)
+		{
+			if (jps_Jump(s, x + dir.x, y, rowDir, goal) >= 0 ||
+			    jps_Jump(s, x, y + dir.y, colDir, goal) >= 0)
+				return (x * s->width + y);
+		}
+		else if (dir.x && ((jps_Walkable(s, x, y - 1) &&
+			!jps_Walkable(s, x - dir.x, y - 1)) ||
+			(jps_Walkable(s, x, y + 1) && !jps_Walkable(s, x - dir.x, y + 1))))
+			return (x * s->width + y);
+		else if (dir.y && ((jps_Walkable(s, x - 1, y) &&
+			!jps_Walkable(s, x - 1, y - dir.y)) ||
+			(jps_Walkable(s, x + 1, y) && !jps_Walkable(s, x + 1, y - dir.y))))
+			return (x * s->width + y);
+		if (!jps_Walkable(s, x + dir.x, y) || !jps_Walkable(s, x, y + dir.y))
+			return (-1);
+		x += dir.x;
+		y += dir.y;
+	}
+	return (-1);
+}
+
+/**
+ * jps_Neighbours - Lists the directions worth exploring from a jump point,
+ * pruned by the direction it was reached from
+ * @s: Pointer to the search context
+ * @cell: Index of the jump point
+ * @dirs: Receives up to eight directions
+ *
+ * Return: Number of directions written
+ */
+static int jps_Neighbours(const jpsearch_t *s, int cell, SDL_Point *dirs)
+{
+	int x = cell / s->width, y = cell % s->width, n = 0, dx, dy, i, j;
+
+	dx = s->parent[cell] < 0 ? 0 : x - s->parent[cell] / s->width;
+	dy = s->parent[cell] < 0 ? 0 : y - s->parent[cell] % s->width;
+	dx = (dx > 0) - (dx < 0);
+	dy = (dy > 0) - (dy < 0);
+	for (i = -1; i <= 1; i++)
+	{
+		for (j = -1; j <= 1; j++)
+		{
+			if ((i == 0 && j == 0) || !jps_Walkable(s, x + i, y + j) ||
+			    (i && j && (!jps_Walkable(s, x + i, y) ||
+			    !jps_Walkable(s, x, y + j))))
+				continue;
+			if ((dx && i == -dx) || (dy && j == -dy))
+				continue;
+			dirs[n].x = i;
+			dirs[n++].y = j;
+		}
+	}
+	return (n);
+}
+
+/**
+ * jps_Expand - Jumps from a closed jump point in every pruned direction and
+ * queues the jump points found
+ * @s: Pointer to the search context
+ * @cell: Index of the jump point
+ * @goal: Goal cell of the search
+ *
+ * Return: void
+ */
+static void jps_Expand(jpsearch_t *s, int cell, SDL_Point goal)
+{
+	SDL_Point dirs[8];
+	int x = cell / s->width, y = cell % s->width, n, i, next, dx, dy;
+	float cost, h;
+
+	n = jps_Neighbours(s, cell, dirs);
+	for (i = 0; i < n; i++)
+	{
+		next = jps_Jump(s, x + dirs[i].x, y + dirs[i].y, dirs[i], goal);
+		if (next < 0 || s->stamp[next] == s->generation + 1)
+			continue;
+		dx = abs(next / s->width - x);
+		dy = abs(next % s->width - y);
+		cost = s->cost[cell] + (dx > dy ? dx - dy : dy - dx) +
+			JPS_SQRT2 * (dx < dy ? dx : dy);
+		if (s->stamp[next] == s->generation && cost >= s->cost[next])
+			continue;
+		s->stamp[next] = s->generation;
+		s->cost[next] = cost;
+		s->parent[next] = cell;
+		dx = abs(next / s->width - goal.x);
+		dy = abs(next % s->width - goal.y);
+		h = (dx > dy ? dx - dy : dy - dx) + JPS_SQRT2 * (dx < dy ? dx : dy);
+		jps_HeapPush(s, next, cost + h);
+	}
+}
+
+/**
+ * nav_FindPath - Finds a shortest 8-connected route between two cells
+ * with jump point search, for one-off queries that do not warrant a
+ * flow field
+ * @search: Pointer to a search context built on the maze
+ * @start: Start cell
+ * @goal: Goal cell
+ * @path: Receives the jump points of the route, start and goal included;
+ * consecutive points are joined by straight or diagonal lines
+ * @maxLength: Number of entries @path can hold
+ *
+ * Return: Number of points written, or -1 if there is no route or it
+ * does not fit in @path
+ */
+int nav_FindPath(jpsearch_t *search, SDL_Point start, SDL_Point goal,
+		SDL_Point *path, int maxLength)
+{
+	int cell, goalCell = goal.x * search->width + goal.y, n, i;
+
+	if (!jps_Walkable(search, start.x, start.y) ||
+	    !jps_Walkable(search, goal.x, goal.y))
+		return (-1);
+	search->generation += 2;
+	if (search->generation < 2)
+	{
+		memset(search->stamp, 0, (size_t)search->width * search->height *
+			sizeof(uint32_t));
+		search->generation = 2;
+	}
+	search->heapSize = 0;
+	cell = start.x * search->width + start.y;
+	search->stamp[cell] = search->generation;
+	search->cost[cell] = 0;
+	search->parent[cell] = -1;
+	jps_HeapPush(search, cell, 0);
+	while (search->heapSize > 0 && cell != goalCell)
+	{
+		cell = jps_HeapPop(search);
+		if (search->stamp[cell] == search->generation + 1)
+			continue;
+		search->stamp[cell] = search->generation + 1;
+		if (cell != goalCell)
+			jps_Expand(search, cell, goal);
+	}
+	if (cell != goalCell)
+		return (-1);
+	for (n = 1, i = goalCell; search->parent[i] >= 0; i = search->parent[i])
+		n++;
+	if (n > maxLength)
+		return (-1);
+	for (i = n - 1, cell = goalCell; i >= 0; i--, cell = search->parent[cell])
+	{
+		path[i].x = cell / search->width;
+		path[i].y = cell % search->width;
+	}
+	return (n);
+}
+
+/**
+ * nav_CreateSearch - Allocates a jump point search context for a maze
+ * @maze: Pointer to the maze array, kept by the context
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ *
+ * Return: Pointer to the new context, or NULL on failure
+ */
+jpsearch_t *nav_CreateSearch(const int *maze, int width, int height)
+{
+	jpsearch_t *search;
+	size_t cells = (size_t)width * height;
+
+	if (maze == NULL || width <= 0 || height <= 0)
+		return (NULL);
+	search = calloc(1, sizeof(jpsearch_t));
+	if (search == NULL)
+		return (NULL);
+	search->maze = maze;
+	search->width = width;
+	search->height = height;
+	search->cost = malloc(cells * sizeof(float));
+	search->parent = malloc(cells * sizeof(int));
+	search->stamp = calloc(cells, sizeof(uint32_t));
+	if (search->cost == NULL || search->parent == NULL ||
+	    search->stamp == NULL)
+	{
+		nav_DestroySearch(search);
+		return (NULL);
+	}
+	return (search);
+}
+
+/**
+ * nav_DestroySearch - Frees a jump point search context
+ * @search: Pointer to the context, may be NULL
+ *
+ * Return: void
+ */
+void nav_DestroySearch(jpsearch_t *search)
+{
+	if (search == NULL)
+		return;
+	free(search->cost);
+	free(search->parent);
+	free(search->stamp);
+	free(search->heap);
+	free(search);
+}
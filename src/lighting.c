@@ -0,0 +1,398 @@
+#include "../headers/lighting.h"
+
+static const int faceNormal[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+/**
+ * light_Visible - Walks the grid from a point to a light and checks that
+ * no wall stands in between
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @from: Start point
+ * @light: Pointer to the light
+ *
+ * Return: true if the light reaches the point, else false
+ */
+static bool light_Visible(const int *maze, int width, int height,
+		point_t from, const light_t *light)
+{
+	point_t delta = {light->x - from.x, light->y - from.y}, next, step;
+	int x = (int)floor(from.x), y = (int)floor(from.y);
+	int ex = (int)floor(light->x), ey = (int)floor(light->y);
+	int sx = delta.x < 0 ? -1 : 1, sy = delta.y < 0 ? -1 : 1;
+
+	if (x < 0 || x >= height || y < 0 || y >= width || maze[x * width + y])
+		return (false);
+	step.x = delta.x == 0 ? INFINITY : fabs(1 / delta.x);
+	step.y = delta.y == 0 ? INFINITY : fabs(1 / delta.y);
+	next.x = (sx > 0 ? x + 1 - from.x : from.x - x) * step.x;
+	next.y = (sy > 0 ? y + 1 - from.y : from.y - y) * step.y;
+	while ((x != ex || y != ey) && (next.x <= 1 || next.y <= 1))
+	{
+		if (next.x < next.y)
+		{
+			next.x += step.x;
+			x += sx;
+		}
+		else
+		{
+			next.y += step.y;
+			y += sy;
+		}
+		if (x < 0 || x >= height || y < 0 || y >= width || maze[x * width + y])
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * light_Face - Adds the contribution of one light to the samples of a face
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @light: Pointer to the light
+ * @cell: Wall cell the face belongs to
+ * @face: Face number, see lighting.h
+ * @samples: LIGHTMAP_LUXELS brightness sums of the face
+ *
+ * Return: void
+ */
+static void light_Face(const int *maze, int width, int height,
+		const light_t *light, SDL_Point cell, int face, float *samples)
+{
+	const int *n = faceNormal[face];
+	point_t at;
+	double u, dx, dy, distance, facing;
+	int k;
+
+	for (k = 0; k < LIGHTMAP_LUXELS; k++)
+	{
+		u = (k + 0.5) / LIGHTMAP_LUXELS;
+		at.x = cell.x + (n[0] ? (n[0] > 0) : u) + n[0] * 1e-4;
+		at.y = cell.y + (n[1] ? (n[1] > 0) : u) + n[1] * 1e-4;
+		dx = light->x - at.x;
+		dy = light->y - at.y;
+		distance = sqrt(dx * dx + dy * dy);
+		if (distance >= light->radius || distance == 0)
+			continue;
+		facing = (n[0] * dx + n[1] * dy) / distance;
+		if (facing <= 0 || !light_Visible(maze, width, height, at, light))
+			continue;
+		samples[k] += light->intensity * (1 - distance / light->radius) * facing;
+	}
+}
+
+/**
+ * light_Reach - Gives the range of cells a light can change the samples of
+ * @lighting: Pointer to the lighting
+ * @light: Pointer to the light
+ * @range: Receives the first row and column (x, y) and the last ones (w, h)
+ *
+ * Return: void
+ */
+static void light_Reach(const lighting_t *lighting, const light_t *light,
+		SDL_Rect *range)
+{
+	range->x = (int)floor(light->x - light->radius) - 1;
+	range->y = (int)floor(light->y - light->radius) - 1;
+	range->w = (int)floor(light->x + light->radius) + 1;
+	range->h = (int)floor(light->y + light->radius) + 1;
+	range->x = range->x < 0 ? 0 : range->x;
+	range->y = range->y < 0 ? 0 : range->y;
+	range->w = range->w >= lighting->height ? lighting->height - 1 : range->w;
+	range->h = range->h >= lighting->width ? lighting->width - 1 : range->h;
+}
+
+/**
+ * lighting_Blocks - Gives a sample block to every block a light reaches
+ * and lists the lights reaching each of them
+ * @lighting: Pointer to the lighting with its lights, blocks must be zeroed
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool lighting_Blocks(lighting_t *lighting)
+{
+	int i, pass, bx, by;
+	uint32_t *block;
+	SDL_Rect range;
+
+	for (pass = 0; pass < 3; pass++)
+	{
+		for (i = 0; i < lighting->lightCount; i++)
+		{
+			light_Reach(lighting, &lighting->lights[i], &range);
+			for (bx = range.x / LIGHT_BLOCK; bx <= range.w / LIGHT_BLOCK; bx++)
+				for (by = range.y / LIGHT_BLOCK; by <= range.h / LIGHT_BLOCK;
+				     by++)
+				{
+					block = &lighting->blocks[bx * lighting->blockWidth + by];
+					if (pass == 0 && *block == 0)
+						*block = ++lighting->blockCount;
+					else if (pass == 1)
+						lighting->lightStart[*block]++;
+					else if (pass == 2)
+						lighting->lightIndex[lighting->lightStart[*block - 1]++] = i;
+				}
+		}
+		if (pass == 0)
+		{
+			lighting->lightStart = calloc(lighting->blockCount + 1,
+				sizeof(uint32_t));
+			lighting->stamp = calloc(lighting->blockCount + 1, sizeof(uint32_t));
+			if (lighting->lightStart == NULL || lighting->stamp == NULL)
+				return (false);
+		}
+		else if (pass == 1)
+		{
+			for (i = 1; i <= (int)lighting->blockCount; i++)
+				lighting->lightStart[i] += lighting->lightStart[i - 1];
+			lighting->lightIndex = malloc(lighting->lightStart[
+				lighting->blockCount] * sizeof(uint32_t) + 1);
+			if (lighting->lightIndex == NULL)
+				return (false);
+		}
+	}
+	for (i = (int)lighting->blockCount; i > 0; i--)
+		lighting->lightStart[i] = lighting->lightStart[i - 1];
+	lighting->lightStart[0] = 0;
+	return (true);
+}
+
+/**
+ * lighting_BakeBlock - Sums the light reaching every exposed face of one
+ * lit block and stores it quantised
+ * @lighting: Pointer to the lighting, with its blocks assigned
+ * @maze: Pointer to the maze array
+ * @bx: Row of the block
+ * @by: Column of the block
+ *
+ * Return: void
+ */
+static void lighting_BakeBlock(lighting_t *lighting, const int *maze,
+		int bx, int by)
+{
+	uint32_t block = lighting->blocks[bx * lighting->blockWidth + by], i;
+	int w = lighting->width, h = lighting->height, f, k, x, y;
+	float sums[LIGHT_BLOCK_BYTES];
+	uint8_t *luxels;
+	SDL_Rect range;
+	SDL_Point cell;
+
+	if (block == 0)
+		return;
+	for (k = 0; k < LIGHT_BLOCK_BYTES; k++)
+		sums[k] = lighting->brightness;
+	for (i = lighting->lightStart[block - 1]; i < lighting->lightStart[block];
+	     i++)
+	{
+		light_Reach(lighting, &lighting->lights[lighting->lightIndex[i]],
+			&range);
+		for (x = bx * LIGHT_BLOCK; x < (bx + 1) * LIGHT_BLOCK; x++)
+			for (y = by * LIGHT_BLOCK; y < (by + 1) * LIGHT_BLOCK; y++)
+			{
+				if (x < range.x || x > range.w || y < range.y || y > range.h ||
+				    x >= h || y >= w || !maze[x * w + y])
+					continue;
+				cell.x = x;
+				cell.y = y;
+				for (f = 0; f < 4; f++)
+					light_Face(maze, w, h,
+						&lighting->lights[lighting->lightIndex[i]], cell, f,
+						sums + (((x % LIGHT_BLOCK) * LIGHT_BLOCK + y %
+						LIGHT_BLOCK) * 4 + f) * LIGHTMAP_LUXELS);
+			}
+	}
+	luxels = lighting->luxels + (size_t)(block - 1) * LIGHT_BLOCK_BYTES;
+	for (k = 0; k < LIGHT_BLOCK_BYTES; k++)
+	{
+		f = (int)(sums[k] * (k / LIGHTMAP_LUXELS % 4 >= 2 ? 0.5 : 1) *
+			SHADE_LEVELS + 0.5);
+		luxels[k] = f > SHADE_LEVELS ? SHADE_LEVELS : f;
+	}
+}
+
+/**
+ * lighting_CellChanged - Rebakes the blocks whose samples may change after
+ * one maze cell was opened or closed: every block reached by a light that
+ * reaches the cell
+ * @lighting: Pointer to the lighting, may be NULL
+ * @maze: Pointer to the maze array, holding the new value of the cell
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: void
+ */
+void lighting_CellChanged(lighting_t *lighting, const int *maze, int x,
+		int y)
+{
+	uint32_t block, lit, i;
+	SDL_Rect range;
+	int bx, by;
+
+	if (lighting == NULL || x < 0 || x >= lighting->height || y < 0 ||
+	    y >= lighting->width)
+		return;
+	block = lighting->blocks[x / LIGHT_BLOCK * lighting->blockWidth +
+		y / LIGHT_BLOCK];
+	if (block == 0)
+		return;
+	if (++lighting->generation == 0)
+	{
+		memset(lighting->stamp, 0, (lighting->blockCount + 1) *
+			sizeof(uint32_t));
+		lighting->generation = 1;
+	}
+	for (i = lighting->lightStart[block - 1]; i < lighting->lightStart[block];
+	     i++)
+	{
+		light_Reach(lighting, &lighting->lights[lighting->lightIndex[i]],
+			&range);
+		if (x < range.x || x > range.w || y < range.y || y > range.h)
+			continue;
+		for (bx = range.x / LIGHT_BLOCK; bx <= range.w / LIGHT_BLOCK; bx++)
+			for (by = range.y / LIGHT_BLOCK; by <= range.h / LIGHT_BLOCK; by++)
+			{
+				lit = lighting->blocks[bx * lighting->blockWidth + by];
+				if (lighting->stamp[lit] == lighting->generation)
+					continue;
+				lighting->stamp[lit] = lighting->generation;
+				lighting_BakeBlock(lighting, maze, bx, by);
+			}
+	}
+}
+
+/**
+ * lighting_Shades - Fills the shade level table and the levels of the
+ * floor and ceiling rows
+ * @lighting: Pointer to the lighting
+ * @fogDistance: Distance at which fog turns everything dark, 0 for none
+ *
+ * Return: void
+ */
+static void lighting_Shades(lighting_t *lighting, double fogDistance)
+{
+	int light, bucket, level, y;
+	double fog, distance;
+
+	lighting->fogScale = fogDistance > 0 ? FOG_BUCKETS / fogDistance : 0;
+	for (light = 0; light <= SHADE_LEVELS; light++)
+		for (bucket = 0; bucket < FOG_BUCKETS; bucket++)
+		{
+			fog = lighting->fogScale > 0 ?
+				1 - (double)bucket / (FOG_BUCKETS - 1) : 1;
+			level = SHADE_LEVELS - (int)(light * fog + 0.5);
+			lighting->shade[light][bucket] = level < SHADE_LEVELS ?
+				level : SHADE_LEVELS - 1;
+		}
+	for (y = SCREEN_HEIGHT / 2 + 1; y < SCREEN_HEIGHT; y++)
+	{
+		distance = SCREEN_HEIGHT / (2.0 * y - SCREEN_HEIGHT);
+		bucket = (int)(distance * lighting->fogScale);
+		lighting->rowLevel[y] = lighting->shade[lighting->ambient[0]][
+			bucket < FOG_BUCKETS ? bucket : FOG_BUCKETS - 1];
+	}
+}
+
+/**
+ * lighting_Create - Bakes the lighting of a map
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @lights: Point lights of the map
+ * @lightCount: Number of lights
+ * @ambient: Brightness of faces no light reaches, 1 being full light
+ * @fogDistance: Distance at which fog turns everything dark, 0 for none
+ *
+ * Return: Pointer to the lighting, or NULL on failure
+ */
+lighting_t *lighting_Create(const int *maze, int width, int height,
+		const light_t *lights, int lightCount, double ambient,
+		double fogDistance)
+{
+	lighting_t *lighting = calloc(1, sizeof(lighting_t));
+	int bx, by;
+
+	if (lighting == NULL)
+		return (NULL);
+	ambient = ambient < 0 ? 0 : ambient > 1 ? 1 : ambient;
+	lighting->brightness = ambient;
+	lighting->lightCount = lightCount;
+	lighting->lights = malloc(lightCount * sizeof(light_t) + 1);
+	if (lighting->lights != NULL && lightCount > 0)
+		memcpy(lighting->lights, lights, lightCount * sizeof(light_t));
+	lighting->width = width;
+	lighting->height = height;
+	lighting->blockWidth = (width + LIGHT_BLOCK - 1) / LIGHT_BLOCK;
+	lighting->ambient[0] = (uint8_t)(ambient * SHADE_LEVELS + 0.5);
+	lighting->ambient[1] = (uint8_t)(ambient * SHADE_LEVELS / 2 + 0.5);
+	lighting->blocks = calloc((size_t)lighting->blockWidth *
+		((height + LIGHT_BLOCK - 1) / LIGHT_BLOCK), sizeof(uint32_t));
+	if (lighting->blocks != NULL && lighting->lights != NULL &&
+	    lighting_Blocks(lighting))
+		lighting->luxels = malloc(lighting->blockCount * LIGHT_BLOCK_BYTES + 1);
+	if (lighting->luxels == NULL)
+	{
+		lighting_Destroy(lighting);
+		return (NULL);
+	}
+	for (bx = 0; bx < (height + LIGHT_BLOCK - 1) / LIGHT_BLOCK; bx++)
+		for (by = 0; by < lighting->blockWidth; by++)
+			lighting_BakeBlock(lighting, maze, bx, by);
+	lighting_Shades(lighting, fogDistance);
+	return (lighting);
+}
+
+/**
+ * lighting_Destroy - Frees baked lighting
+ * @lighting: Pointer to the lighting, may be NULL
+ *
+ * Return: void
+ */
+void lighting_Destroy(lighting_t *lighting)
+{
+	if (lighting == NULL)
+		return;
+	free(lighting->blocks);
+	free(lighting->luxels);
+	free(lighting->lights);
+	free(lighting->lightStart);
+	free(lighting->lightIndex);
+	free(lighting->stamp);
+	free(lighting);
+}
+
+/**
+ * lighting_WallLevel - Looks up the shade level of one wall column
+ * @lighting: Pointer to the lighting, NULL for the unlit look where only
+ * y sides are darkened
+ * @map: Wall cell hit, inside the map
+ * @face: Face hit, see lighting.h
+ * @wallX: Where along the face the ray hit, between 0 and 1
+ * @distance: Distance of the wall from the camera
+ *
+ * Return: Shade level, 0 for full brightness
+ */
+int lighting_WallLevel(const lighting_t *lighting, SDL_Point map, int face,
+		real_t wallX, real_t distance)
+{
+	uint32_t block;
+	int bucket = 0, luxel, light;
+
+	if (lighting == NULL)
+		return (face >= 2 ? SHADE_LEVELS / 2 : 0);
+	if (lighting->fogScale > 0)
+	{
+		bucket = (int)(REAL_TO_DOUBLE(distance) * lighting->fogScale);
+		bucket = bucket < FOG_BUCKETS ? bucket : FOG_BUCKETS - 1;
+	}
+	block = lighting->blocks[map.x / LIGHT_BLOCK * lighting->blockWidth +
+		map.y / LIGHT_BLOCK];
+	if (block == 0)
+		return (lighting->shade[lighting->ambient[face >> 1]][bucket]);
+	luxel = real_Floor(wallX * LIGHTMAP_LUXELS);
+	luxel = luxel < LIGHTMAP_LUXELS ? luxel : LIGHTMAP_LUXELS - 1;
+	light = lighting->luxels[(block - 1) * LIGHT_BLOCK_BYTES + (((map.x %
+		LIGHT_BLOCK) * LIGHT_BLOCK + map.y % LIGHT_BLOCK) * 4 + face) *
+		LIGHTMAP_LUXELS + luxel];
+	return (lighting->shade[light][bucket]);
+}
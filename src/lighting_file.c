@@ -0,0 +1,118 @@
+#include "../headers/lighting.h"
+#include <ctype.h>
+
+/**
+ * struct lightlist_s - lighting settings read from a map file
+ * @lights: the point lights
+ * @count: number of lights
+ * @capacity: number of lights allocated
+ * @ambient: ambient brightness, negative when the file sets none
+ * @fog: fog distance, 0 for none
+ * @found: true if the file has any lighting line
+ */
+typedef struct lightlist_s
+{
+	light_t *lights;
+	int count;
+	int capacity;
+	double ambient;
+	double fog;
+	bool found;
+} lightlist_t;
+
+/**
+ * parseLightLine - Parses one lighting line of a map file
+ * @line: The line, cell rows are ignored
+ * @list: Settings read so far
+ *
+ * Return: true on success, false if the line is invalid or memory ran out
+ */
+static bool parseLightLine(const char *line, lightlist_t *list)
+{
+	light_t light, *grown;
+	char extra;
+
+	if (strncmp(line, "light", 5) == 0)
+	{
+		light.radius = 8;
+		if (sscanf(line + 5, "%lf %lf %lf %lf %c", &light.x, &light.y,
+		    &light.intensity, &light.radius, &extra) < 3 || light.radius <= 0)
+			return (false);
+		if (list->count == list->capacity)
+		{
+			list->capacity = list->capacity ? list->capacity * 2 : 16;
+			grown = realloc(list->lights, list->capacity * sizeof(light_t));
+			if (grown == NULL)
+				return (false);
+			list->lights = grown;
+		}
+		list->lights[list->count++] = light;
+	}
+	else if (strncmp(line, "ambient", 7) == 0)
+	{
+		if (sscanf(line + 7, "%lf %c", &list->ambient, &extra) != 1)
+			return (false);
+	}
+	else if (strncmp(line, "fog", 3) == 0)
+	{
+		if (sscanf(line + 3, "%lf %c", &list->fog, &extra) != 1)
+			return (false);
+	}
+	else
+		return (!isalpha((unsigned char)line[0]));
+	list->found = true;
+	return (true);
+}
+
+/**
+ * lighting_Load - Reads the lighting lines of a map file and bakes its
+ * lighting. A map without them keeps the unlit look and gets no lighting.
+ * @maze: Pointer to the maze array read from the file
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @mapFilename: Path the map was read from
+ * @lighting: Receives the lighting, or NULL
+ *
+ * Return: true on success, false on an invalid line or failure
+ */
+bool lighting_Load(const int *maze, int width, int height,
+		const char *mapFilename, lighting_t **lighting)
+{
+	lightlist_t list = {NULL, 0, 0, -1, 0, false};
+	char *line = NULL;
+	size_t lineSize = 0;
+	bool valid = true;
+	FILE *file;
+
+	*lighting = NULL;
+	file = fopen(mapFilename, "r");
+	if (file == NULL)
+		return (false);
+	while (valid && getline(&line, &lineSize, file) != -1)
+		valid = parseLightLine(line, &list);
+	free(line);
+	fclose(file);
+	if (!valid)
+		fprintf(stderr, "Error: Invalid lighting in file\n");
+	else if (list.found)
+		*lighting = lighting_Create(maze, width, height, list.lights,
+			list.count, list.ambient >= 0 ? list.ambient : list.count ? 0.3 : 1,
+			list.fog);
+	free(list.lights);
+	return (valid && (!list.found || *lighting != NULL));
+}
+
+/**
+ * loadMapLighting - Reads the lighting of the current map, see
+ * lighting_Load
+ * @state: Pointer to the GameState holding the map
+ * @mapFilename: Path the map was read from
+ *
+ * Return: true on success, false on an invalid line or failure
+ */
+bool loadMapLighting(GameState *state, const char *mapFilename)
+{
+	lighting_Destroy(state->lighting);
+	return (lighting_Load(state->maze, state->mapWidth, state->mapHeight,
+		mapFilename, &state->lighting));
+}
@@ -3,10 +3,49 @@
 #include "../headers/player.h"
 #include "../headers/raycast.h"
 #include "../headers/map.h"
+#include "../headers/pvs.h"
+#include "../headers/replay.h"
+#include "../headers/lighting.h"
+#include "../headers/reload.h"
+#include "../headers/stream.h"
+#include "../headers/control.h"
+#include "../headers/binning.h"
+#include "../headers/minimap.h"
+#include "../headers/metrics.h"
+#include <unistd.h>
 
 /**
- * handleExitMaze - Game loop that checks if user quits or
- * toggles fullscreen
+ * struct options_s - command line options of the game
+ * @mapFile: path of the map to load
+ * @replayFile: path of the replay to record or play, or NULL
+ * @replayMode: whether @replayFile is recorded or played back
+ * @headless: true to play a replay or serve a control socket without
+ * opening a window
+ * @watch: true to reload the map and textures when they change on disk
+ * @videoFile: file or '|' command every frame is streamed to, or NULL
+ * @videoFormat: format of the streamed frames
+ * @controlFile: path of the control socket driving the game, or NULL
+ * @binned: true to draw frames with the binned renderer on every core
+ * @metricsFile: file or "unix:" socket frame metrics are reported to, or
+ * NULL
+ */
+typedef struct options_s
+{
+	char *mapFile;
+	char *replayFile;
+	replaymode_t replayMode;
+	bool headless;
+	bool watch;
+	char *videoFile;
+	streamformat_t videoFormat;
+	char *controlFile;
+	bool binned;
+	char *metricsFile;
+} options_t;
+
+/**
+ * handleExitMaze - Game loop that checks if user quits, toggles
+ * fullscreen, switches and zooms the minimap or shows the metrics
  * @state: Represents pointer to the Game struct
  *
  * Return: True if user quits, else False
@@ -33,6 +72,20 @@ bool handleExitMaze(GameState *state)
 					SDL_WINDOW_FULLSCREEN) ? 0 :
 					SDL_WINDOW_FULLSCREEN);
 				break;
+			case SDLK_m:
+				minimap_Cycle(state->minimap);
+				break;
+			case SDLK_EQUALS:
+			case SDLK_KP_PLUS:
+				minimap_Zoom(state->minimap, -1);
+				break;
+			case SDLK_MINUS:
+			case SDLK_KP_MINUS:
+				minimap_Zoom(state->minimap, 1);
+				break;
+			case SDLK_F3:
+				metrics_Toggle(state->metrics);
+				break;
 			default:
 				break;
 			}
@@ -56,14 +109,26 @@ void runGameLoop(GameState *state, int textured)
 {
 	while (!state->quit)
 	{
-		if (!textured)
-			castCeilingAndFloor(state);
+		metrics_FrameStart(state->metrics);
+		if (reload_Apply(state->reload, state))
+		{
+			printf("Reloaded %.1f ms after the change, swapped in %.3f ms\n",
+				state->reload->latency * 1000.0, state->reload->apply * 1000.0);
+			minimap_Invalidate(state->minimap);
+		}
+		/* A controlled game without a window only draws requested frames */
+		if (state->window || !state->control || state->control->render)
+		{
+			if (!textured)
+				castCeilingAndFloor(state);
 
-		renderWalls(state, textured);
+			renderWalls(state, textured);
+		}
 
 		handlePlayerMovement(state);
+		metrics_Input(state->metrics);
 
-		if (handleExitMaze(state))
+		if (state->window && handleExitMaze(state))
 			state->quit = 1;
 	}
 }
@@ -73,9 +138,11 @@ void runGameLoop(GameState *state, int textured)
  *
  * @state: the initial state.
  * @maze: the current map of the game.
+ * @width: number of cells in a row of the map.
+ * @height: number of rows in the map.
  * Returns: voide
  */
-void initializeState(GameState *state, int **maze)
+void initializeState(GameState *state, int **maze, int width, int height)
 {
 	memset(state, 0, sizeof(GameState));
 
@@ -88,36 +155,146 @@ void initializeState(GameState *state, int **maze)
 	state->time = 0;
 	state->quit = false;
 	state->maze = *maze;
+	state->mapWidth = width;
+	state->mapHeight = height;
+	findOpenCell(*maze, width, height, &state->position);
+}
+
+/**
+ * parseArguments - Reads the command line options
+ * @argc: number of arguments
+ * @argv: arguments: [-w] [-c socket [-H]] | [-r replay | -p replay [-H]]
+ * [-o video [-f y4m|argb]] [-t] [-j metrics] [map]
+ * @options: receives the options
+ *
+ * Return: true if the options are valid, else false
+ */
+bool parseArguments(int argc, char **argv, options_t *options)
+{
+	int option;
+
+	memset(options, 0, sizeof(options_t));
+	options->mapFile = "assets/maps/map_01";
+	while ((option = getopt(argc, argv, "r:p:Hwo:f:c:tj:")) != -1)
+	{
+		if (option == 'r' || option == 'p')
+		{
+			options->replayFile = optarg;
+			options->replayMode = option == 'r' ? REPLAY_RECORD :
+				REPLAY_PLAY;
+		}
+		else if (option == 'H')
+			options->headless = true;
+		else if (option == 'w')
+			options->watch = true;
+		else if (option == 'o')
+			options->videoFile = optarg;
+		else if (option == 'c')
+			options->controlFile = optarg;
+		else if (option == 't')
+			options->binned = true;
+		else if (option == 'j')
+			options->metricsFile = optarg;
+		else if (option != 'f' || !parseStreamFormat(optarg,
+			 &options->videoFormat))
+			break;
+	}
+	if (optind < argc)
+		options->mapFile = argv[optind++];
+	if (option != -1 || optind < argc || (options->headless &&
+	    !options->controlFile && (!options->replayFile ||
+	    options->replayMode != REPLAY_PLAY)) || (options->replayFile &&
+	    (options->watch || options->controlFile)))
+	{
+		fprintf(stderr, "Usage: %s [-w] [-c socket [-H]] | [-r replay | "
+			"-p replay [-H]] [-o video [-f y4m|argb]] [-t] [-j metrics] "
+			"[map]\n",
+			argv[0]);
+		return (false);
+	}
+	return (true);
 }
 
 /**
  * main - Entry point
+ * @argc: number of arguments
+ * @argv: options, see parseArguments
  *
  * Return: status of the execution
  */
-int main(void)
+int main(int argc, char **argv)
 {
-	char *filename = "assets/maps/map_01";
-	int *map;
+	options_t options;
+	int *map, width, height, status = 0;
 	GameState state;
 	int textured = true;
+	uint64_t start;
 
-	map = readMapFromFile(filename);
+	if (!parseArguments(argc, argv, &options))
+		return (1);
+	map = readMapFromFile(options.mapFile, &width, &height);
 	if (map == NULL)
 		return (1);
 
-	initializeState(&state, &map);
-	if (!init_SDLInstance(&state))
+	initializeState(&state, &map, width, height);
+	loadMapVisibility(&state, options.mapFile);
+	if (options.replayFile)
+		state.replay = replay_Open(&state, options.replayFile,
+			options.replayMode);
+	if (options.videoFile)
+		state.stream = stream_Open(options.videoFile, options.videoFormat,
+			options.headless);
+	if (options.controlFile)
+		state.control = control_Start(options.controlFile);
+	if (options.binned)
+		state.binner = binner_Create(SDL_GetCPUCount());
+	state.metrics = metrics_Create(options.metricsFile, 0);
+	if (!loadMapLighting(&state, options.mapFile) ||
+	    (options.replayFile && state.replay == NULL) ||
+	    (options.videoFile && state.stream == NULL) ||
+	    (options.controlFile && state.control == NULL) ||
+	    (options.binned && state.binner == NULL) || state.metrics == NULL)
+		status = 1;
+	else if (!options.headless && !init_SDLInstance(&state))
+		status = 1;
+	else if (textured && !loadMapTextures(&state))
 	{
-		free(map);
-		destroy_SDLInstance(&state);
-		return (1);
+		status = 1;
+		if (!options.headless)
+			destroy_SDLInstance(&state);
 	}
-	if (textured)
-		loadMapTextures(&state);
-	runGameLoop(&state, textured);
-
-	destroy_SDLInstance(&state);
-	free(map);
-	return (0);
+	else
+	{
+		if (textured && !options.headless)
+			state.minimap = minimap_Create();
+		if (options.watch)
+			state.reload = reload_Start(options.mapFile, TEXTURE_DIR);
+		start = SDL_GetPerformanceCounter();
+		runGameLoop(&state, textured);
+		if (options.headless && state.replay)
+			printf("Replayed %lu frames in %.3f s\n",
+				(unsigned long)state.replay->cursor,
+				(double)(SDL_GetPerformanceCounter() - start) /
+				SDL_GetPerformanceFrequency());
+		else if (options.headless)
+			printf("Served %lu steps and %lu frames in %.3f s\n",
+				(unsigned long)state.control->steps,
+				(unsigned long)state.control->frames,
+				(double)(SDL_GetPerformanceCounter() - start) /
+				SDL_GetPerformanceFrequency());
+		else
+			destroy_SDLInstance(&state);
+	}
+	metrics_Destroy(state.metrics);
+	minimap_Destroy(state.minimap);
+	binner_Destroy(state.binner);
+	control_Stop(state.control);
+	stream_Close(state.stream);
+	reload_Stop(state.reload);
+	replay_Close(state.replay);
+	lighting_Destroy(state.lighting);
+	free(state.pvs);
+	free(state.maze);
+	free(state.shades);
+	return (status);
 }
@@ -1,18 +1,63 @@
 #include "../headers/map.h"
 #include "../headers/defs.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 /**
- * readMapFromFile - Reads a map from a file.
+ * parseMapRow - Parses one line of a map file into the end of the map
+ * @line: The line to parse
+ * @map: Pointer to the map array, grown when needed
+ * @size: Pointer to the number of cells already stored
+ * @capacity: Pointer to the number of cells allocated
+ *
+ * Return: Number of cells read from the line, or -1 on failure
+ */
+static int parseMapRow(char *line, int **map, size_t *size, size_t *capacity)
+{
+	size_t needed = *size + strlen(line) / 2 + 1;
+	char *end;
+	int count = 0, *grown;
+	long value;
+
+	if (needed > *capacity)
+	{
+		*capacity = needed > *capacity * 2 ? needed : *capacity * 2;
+		grown = realloc(*map, *capacity * sizeof(int));
+		if (grown == NULL)
+			return (-1);
+		*map = grown;
+	}
+	for (;; count++)
+	{
+		value = strtol(line, &end, 10);
+		if (end == line)
+			break;
+		(*map)[(*size)++] = (int)value;
+		line = end;
+	}
+	while (*line == ' ' || *line == '\t' || *line == '\r' || *line == '\n')
+		line++;
+	return (*line ? -1 : count);
+}
+
+/**
+ * readMapFromFile - Reads a map from a file. Every line holds one row of
+ * whitespace separated cells, and all rows must have the same length.
+ * Lines starting with a letter are settings such as lights, read by
+ * loadMapLighting, and are skipped.
  * @filename: The file containing the map.
+ * @width: Receives the number of cells in a row.
+ * @height: Receives the number of rows.
  *
  * Return: Pointer to the 2D map, or NULL on failure.
  */
-int *readMapFromFile(char *filename)
+int *readMapFromFile(char *filename, int *width, int *height)
 {
 	FILE *file;
-	int *map, i, j;
+	int *map = NULL, count = 0;
+	char *line = NULL;
+	size_t lineSize = 0, size = 0, capacity = 0;
 
 	file = fopen(filename, "r");
 	if (file == NULL)
@@ -20,32 +65,27 @@ int *readMapFromFile(char *filename)
 		fprintf(stderr, "Error: Unable to open file %s\n", filename);
 		return (NULL);
 	}
-
-	/* Allocate memory for the map */
-	map = malloc(MAP_WIDTH * MAP_HEIGHT * sizeof(int));
-	if (map == NULL)
+	*width = 0;
+	*height = 0;
+	while (getline(&line, &lineSize, file) != -1)
 	{
-		fclose(file);
-		return (NULL);
+		if (isalpha((unsigned char)line[0]))
+			continue;
+		count = parseMapRow(line, &map, &size, &capacity);
+		if (count == 0)
+			continue;
+		if (count < 0 || (*height > 0 && count != *width))
+			break;
+		*width = count;
+		(*height)++;
 	}
-
-	/* Read the map data */
-	for (i = 0; i < MAP_HEIGHT; i++)
+	if (count < 0 || (count > 0 && count != *width) || *height == 0)
 	{
-		for (j = 0; j < MAP_WIDTH; j++)
-		{
-			int value;
-
-			if (fscanf(file, "%d", &value) != 1)
-			{
-				fprintf(stderr, "Error: Invalid data in file\n");
-				free(map);
-				fclose(file);
-				return (NULL);
-			}
-			map[i * MAP_WIDTH + j] = value;
-		}
+		fprintf(stderr, "Error: Invalid data in file\n");
+		free(map);
+		map = NULL;
 	}
+	free(line);
 	fclose(file);
 	return (map);
 }
@@ -53,10 +93,12 @@ int *readMapFromFile(char *filename)
 /**
  * printMap - Prints the map in rows and columns.
  * @map: Pointer to the 2D map array.
+ * @width: Number of cells in a row.
+ * @height: Number of rows.
  *
  * Return: void
  */
-void printMap(int *map)
+void printMap(int *map, int width, int height)
 {
 	int i, j;
 
@@ -66,12 +108,39 @@ void printMap(int *map)
 		return;
 	}
 
-	for (i = 0; i < MAP_HEIGHT; i++)
+	for (i = 0; i < height; i++)
 	{
-		for (j = 0; j < MAP_WIDTH; j++)
+		for (j = 0; j < width; j++)
 		{
-			printf("%d ", map[i * MAP_WIDTH + j]);
+			printf("%d ", map[i * width + j]);
 		}
 		printf("\n");
 	}
 }
+
+/**
+ * findOpenCell - Moves a position to the centre of an empty cell,
+ * keeping it where it is when its cell is already empty
+ * @map: Pointer to the 2D map array.
+ * @width: Number of cells in a row.
+ * @height: Number of rows.
+ * @position: Position to check and update.
+ *
+ * Return: true if an empty cell was found, else false
+ */
+bool findOpenCell(int *map, int width, int height, point_t *position)
+{
+	int x = (int)position->x, y = (int)position->y, i;
+
+	if (x >= 0 && x < height && y >= 0 && y < width && !map[x * width + y])
+		return (true);
+	for (i = 0; i < width * height; i++)
+	{
+		if (map[i])
+			continue;
+		position->x = i / width + 0.5;
+		position->y = i % width + 0.5;
+		return (true);
+	}
+	return (false);
+}
@@ -0,0 +1,156 @@
+#include "../headers/mapedit.h"
+#include "../headers/lighting.h"
+
+/**
+ * mapedit_Create - Prepares a loaded map for edits. The visibility data of
+ * the state, if any, gets an update context; flow fields are added with
+ * mapedit_AddFlowField.
+ * @state: Pointer to the GameState holding the map
+ *
+ * Return: Pointer to the context, or NULL on failure
+ */
+mapedit_t *mapedit_Create(GameState *state)
+{
+	mapedit_t *edit = calloc(1, sizeof(mapedit_t));
+	int tiles;
+
+	if (edit == NULL)
+		return (NULL);
+	edit->state = state;
+	edit->tileWidth = (state->mapWidth + MAPEDIT_TILE - 1) / MAPEDIT_TILE;
+	tiles = edit->tileWidth *
+		((state->mapHeight + MAPEDIT_TILE - 1) / MAPEDIT_TILE);
+	edit->dirty = calloc(tiles, sizeof(bool));
+	edit->dirtyTiles = malloc(tiles * sizeof(int));
+	if (state->pvs)
+		edit->pvs = pvs_CreateEdit(state->maze, state->mapWidth,
+			state->mapHeight, state->pvs);
+	if (edit->dirty == NULL || edit->dirtyTiles == NULL ||
+	    (state->pvs && edit->pvs == NULL))
+	{
+		mapedit_Destroy(edit);
+		return (NULL);
+	}
+	return (edit);
+}
+
+/**
+ * mapedit_Destroy - Frees an edit context, the map and its data stay
+ * @edit: Pointer to the context, may be NULL
+ *
+ * Return: void
+ */
+void mapedit_Destroy(mapedit_t *edit)
+{
+	if (edit == NULL)
+		return;
+	pvs_DestroyEdit(edit->pvs);
+	free(edit->fields);
+	free(edit->dirty);
+	free(edit->dirtyTiles);
+	free(edit);
+}
+
+/**
+ * mapedit_AddFlowField - Registers a flow field to repair after each edit
+ * @edit: Pointer to the context
+ * @field: Pointer to a field built on the edited maze, must outlive the
+ * context
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool mapedit_AddFlowField(mapedit_t *edit, flowfield_t *field)
+{
+	flowfield_t **grown;
+
+	if (edit->fieldCount == edit->fieldCapacity)
+	{
+		edit->fieldCapacity = edit->fieldCapacity ? edit->fieldCapacity * 2 : 4;
+		grown = realloc(edit->fields, edit->fieldCapacity *
+			sizeof(flowfield_t *));
+		if (grown == NULL)
+			return (false);
+		edit->fields = grown;
+	}
+	edit->fields[edit->fieldCount++] = field;
+	return (true);
+}
+
+/**
+ * mapedit_SetCell - Changes one cell of the map and repairs the data
+ * derived from it. When the visibility data cannot be repaired it is
+ * dropped, and rays fall back to checking the map edges.
+ * @edit: Pointer to the context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @value: New cell value, 0 for floor
+ *
+ * Return: true if the cell changed, false if it is off the map or already
+ * holds the value
+ */
+bool mapedit_SetCell(mapedit_t *edit, int x, int y, int value)
+{
+	GameState *state = edit->state;
+	int *cell, tile, i;
+
+	if (x < 0 || x >= state->mapHeight || y < 0 || y >= state->mapWidth)
+		return (false);
+	cell = &state->maze[x * state->mapWidth + y];
+	if (*cell == value)
+		return (false);
+	tile = x / MAPEDIT_TILE * edit->tileWidth + y / MAPEDIT_TILE;
+	if (!edit->dirty[tile])
+	{
+		edit->dirty[tile] = true;
+		edit->dirtyTiles[edit->dirtyCount++] = tile;
+	}
+	if (!*cell == !value)
+	{
+		*cell = value;
+		return (true);
+	}
+	*cell = value;
+	if (edit->pvs && !pvs_CellChanged(edit->pvs, x, y))
+	{
+		fprintf(stderr, "Warning: visibility data dropped after an edit\n");
+		pvs_DestroyEdit(edit->pvs);
+		edit->pvs = NULL;
+		free(state->pvs);
+		state->pvs = NULL;
+	}
+	for (i = 0; i < edit->fieldCount; i++)
+		nav_CellChanged(edit->fields[i], x, y);
+	lighting_CellChanged(state->lighting, state->maze, x, y);
+	return (true);
+}
+
+/**
+ * mapedit_TakeDirty - Hands out the tiles changed since the last call
+ * @edit: Pointer to the context
+ * @rects: Receives the tiles in cells: x and w along rows, y and h along
+ * columns, clipped to the map
+ * @max: Number of entries @rects can hold; tiles that do not fit are
+ * kept for the next call
+ *
+ * Return: Number of entries written to @rects
+ */
+int mapedit_TakeDirty(mapedit_t *edit, SDL_Rect *rects, int max)
+{
+	int count = 0, tile;
+
+	while (count < max && edit->dirtyCount > 0)
+	{
+		tile = edit->dirtyTiles[--edit->dirtyCount];
+		edit->dirty[tile] = false;
+		rects[count].x = tile / edit->tileWidth * MAPEDIT_TILE;
+		rects[count].y = tile % edit->tileWidth * MAPEDIT_TILE;
+		rects[count].w = edit->state->mapHeight - rects[count].x;
+		rects[count].h = edit->state->mapWidth - rects[count].y;
+		rects[count].w = rects[count].w < MAPEDIT_TILE ?
+			rects[count].w : MAPEDIT_TILE;
+		rects[count].h = rects[count].h < MAPEDIT_TILE ?
+			rects[count].h : MAPEDIT_TILE;
+		count++;
+	}
+	return (count);
+}
@@ -0,0 +1,236 @@
+#include "../headers/mapgen.h"
+
+/**
+ * struct memorymap_s - destination of generateMapToMemory
+ * @map: the map being filled
+ * @rows: number of rows stored so far
+ */
+typedef struct memorymap_s
+{
+	int *map;
+	int rows;
+} memorymap_t;
+
+/**
+ * struct mapfile_s - destination of generateMapToFile
+ * @file: the file written to
+ * @line: text of the row being written
+ */
+typedef struct mapfile_s
+{
+	FILE *file;
+	char *line;
+} mapfile_t;
+
+/**
+ * mapgen_Hash - Mixes a seed and a cell into a pseudo random number,
+ * so any cell can be generated without generating the ones before it
+ * @seed: Seed of the map
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: The pseudo random number
+ */
+uint32_t mapgen_Hash(uint32_t seed, int x, int y)
+{
+	uint32_t h = seed ^ ((uint32_t)x * 0x9E3779B1u) ^
+		((uint32_t)y * 0x85EBCA77u);
+
+	h ^= h >> 16;
+	h *= 0x7FEB352Du;
+	h ^= h >> 15;
+	h *= 0x846CA68Bu;
+	h ^= h >> 16;
+	return (h);
+}
+
+/**
+ * mapgen_Next - xorshift32 step for generators that walk the map in order
+ * @state: Pointer to the generator state, must not be 0
+ *
+ * Return: The next pseudo random number
+ */
+uint32_t mapgen_Next(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return (*state);
+}
+
+/**
+ * mapgen_Chance - Draws a number and tests it against a chance
+ * @state: Pointer to the generator state, must not be 0
+ * @percent: Chance of success in percent
+ *
+ * Return: true with a probability of @percent out of 100
+ */
+bool mapgen_Chance(uint32_t *state, int percent)
+{
+	return ((int)(mapgen_Next(state) % 100) < percent);
+}
+
+/**
+ * mapgen_Wall - Picks the wall texture of a cell
+ * @options: Options of the map
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: A wall value between 1 and 4
+ */
+int mapgen_Wall(const mapgen_t *options, int x, int y)
+{
+	return (1 + (int)(mapgen_Hash(options->seed, x, y) % 4));
+}
+
+/**
+ * generateMap - Generates a map and hands it row by row to a callback
+ * @options: Options of the map, at least 3x3 cells
+ * @emit: Called with every row from top to bottom
+ * @data: Passed to @emit
+ *
+ * Return: true if all rows were generated, false on failure
+ */
+bool generateMap(const mapgen_t *options, maprow_fn emit, void *data)
+{
+	int *row, rows, y;
+
+	if (options->width < 3 || options->height < 3)
+		return (false);
+	row = malloc(options->width * sizeof(int));
+	if (row == NULL)
+		return (false);
+	if (options->style == MAPGEN_CAVERN)
+		rows = mapgen_Cavern(options, row, emit, data);
+	else if (options->style == MAPGEN_CORRIDOR)
+		rows = mapgen_Corridor(options, row, emit, data);
+	else
+		rows = mapgen_Perfect(options, row, emit, data);
+	while (rows >= 0 && rows < options->height)
+	{
+		for (y = 0; y < options->width; y++)
+			row[y] = mapgen_Wall(options, rows, y);
+		rows = emit(row, options->width, data) ? rows + 1 : -1;
+	}
+	free(row);
+	return (rows >= 0);
+}
+
+/**
+ * parseMapStyle - Converts a style name to a map style
+ * @name: One of "perfect", "cavern" or "corridor"
+ * @style: Receives the style
+ *
+ * Return: true if the name is known, else false
+ */
+bool parseMapStyle(const char *name, mapstyle_t *style)
+{
+	if (strcmp(name, "perfect") == 0)
+		*style = MAPGEN_PERFECT;
+	else if (strcmp(name, "cavern") == 0)
+		*style = MAPGEN_CAVERN;
+	else if (strcmp(name, "corridor") == 0)
+		*style = MAPGEN_CORRIDOR;
+	else
+		return (false);
+	return (true);
+}
+
+/**
+ * writeMapRow - Writes a row in the text format readMapFromFile reads
+ * @row: Cells of the row
+ * @width: Number of cells
+ * @data: The mapfile_t to write to
+ *
+ * Return: true on success, false if the write failed
+ */
+static bool writeMapRow(const int *row, int width, void *data)
+{
+	mapfile_t *out = data;
+	int y, n = 0;
+
+	for (y = 0; y < width; y++)
+	{
+		if (row[y] >= 0 && row[y] < 10)
+			out->line[n++] = '0' + row[y];
+		else
+			n += sprintf(out->line + n, "%d", row[y]);
+		out->line[n++] = y + 1 < width ? ' ' : '\n';
+	}
+	return (fwrite(out->line, 1, n, out->file) == (size_t)n);
+}
+
+/**
+ * generateMapToFile - Generates a map straight into a map file, holding
+ * only one row in memory at a time
+ * @options: Options of the map
+ * @filename: Path of the file, "-" for the standard output
+ *
+ * Return: true on success, false on failure
+ */
+bool generateMapToFile(const mapgen_t *options, const char *filename)
+{
+	mapfile_t out;
+	bool done;
+
+	out.line = malloc((size_t)options->width * 12 + 1);
+	if (out.line == NULL)
+		return (false);
+	out.file = strcmp(filename, "-") ? fopen(filename, "w") : stdout;
+	if (out.file == NULL)
+	{
+		fprintf(stderr, "Error: Unable to open file %s\n", filename);
+		free(out.line);
+		return (false);
+	}
+	done = generateMap(options, writeMapRow, &out);
+	if (out.file != stdout)
+		done = fclose(out.file) == 0 && done;
+	else
+		done = fflush(out.file) == 0 && done;
+	free(out.line);
+	return (done);
+}
+
+/**
+ * storeMapRow - Appends a row to a map held in memory
+ * @row: Cells of the row
+ * @width: Number of cells
+ * @data: The memorymap_t being filled
+ *
+ * Return: Always true
+ */
+static bool storeMapRow(const int *row, int width, void *data)
+{
+	memorymap_t *memory = data;
+
+	memcpy(memory->map + (size_t)memory->rows * width, row,
+		width * sizeof(int));
+	memory->rows++;
+	return (true);
+}
+
+/**
+ * generateMapToMemory - Generates a map into a maze array laid out like
+ * the one readMapFromFile returns
+ * @options: Options of the map
+ *
+ * Return: Pointer to the map, or NULL on failure
+ */
+int *generateMapToMemory(const mapgen_t *options)
+{
+	memorymap_t memory = {NULL, 0};
+
+	if (options->width < 3 || options->height < 3)
+		return (NULL);
+	memory.map = malloc((size_t)options->width * options->height *
+		sizeof(int));
+	if (memory.map == NULL)
+		return (NULL);
+	if (!generateMap(options, storeMapRow, &memory))
+	{
+		free(memory.map);
+		return (NULL);
+	}
+	return (memory.map);
+}
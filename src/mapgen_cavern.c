@@ -0,0 +1,90 @@
+#include "../headers/mapgen.h"
+
+#define CAVERN_OCTAVES 2
+
+static const int cavernScale[CAVERN_OCTAVES] = {16, 5};
+static const float cavernWeight[CAVERN_OCTAVES] = {0.65f, 0.35f};
+
+/**
+ * cavern_Smooth - Eases an interpolation factor so the noise has no creases
+ * @t: Factor between 0 and 1
+ *
+ * Return: The eased factor
+ */
+static float cavern_Smooth(float t)
+{
+	return (t * t * (3.0f - 2.0f * t));
+}
+
+/**
+ * cavern_LatticeRow - Interpolates the noise lattice down to one map row,
+ * leaving one value per lattice column to blend along the row
+ * @options: Options of the map
+ * @octave: Index of the noise octave
+ * @x: Index of the map row
+ * @values: Receives width / scale + 2 values
+ *
+ * Return: void
+ */
+static void cavern_LatticeRow(const mapgen_t *options, int octave, int x,
+		float *values)
+{
+	int scale = cavernScale[octave], lx = x / scale, j;
+	float t = cavern_Smooth((float)(x % scale) / scale), a, b;
+	uint32_t seed = options->seed + (uint32_t)octave * 0x68E31DA4u;
+
+	for (j = 0; j < options->width / scale + 2; j++)
+	{
+		a = mapgen_Hash(seed, lx, j) / 4294967296.0f;
+		b = mapgen_Hash(seed, lx + 1, j) / 4294967296.0f;
+		values[j] = a + (b - a) * t;
+	}
+}
+
+/**
+ * mapgen_Cavern - Generates open caves by thresholding smooth value noise.
+ * Every cell depends only on the seed and its position, so rows stream
+ * out with one lattice row per octave held.
+ * @options: Options of the map
+ * @row: Buffer for the cells of a row
+ * @emit: Row callback
+ * @data: Passed to @emit
+ *
+ * Return: Number of rows emitted, or -1 on failure
+ */
+int mapgen_Cavern(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data)
+{
+	float *values[CAVERN_OCTAVES], noise, t, threshold;
+	int x, y, k, scale, emitted = -1;
+
+	threshold = 0.5f + (options->density - 50) / 190.0f;
+	for (k = 0; k < CAVERN_OCTAVES; k++)
+		values[k] = malloc((options->width / cavernScale[k] + 2) *
+			sizeof(float));
+	for (x = 0; values[0] != NULL && values[1] != NULL &&
+		x < options->height; x++)
+	{
+		for (k = 0; k < CAVERN_OCTAVES; k++)
+			cavern_LatticeRow(options, k, x, values[k]);
+		for (y = 0; y < options->width; y++)
+		{
+			for (k = 0, noise = 0; k < CAVERN_OCTAVES; k++)
+			{
+				scale = cavernScale[k];
+				t = cavern_Smooth((float)(y % scale) / scale);
+				noise += cavernWeight[k] * (values[k][y / scale] +
+					(values[k][y / scale + 1] - values[k][y / scale]) * t);
+			}
+			row[y] = noise >= threshold && x > 0 && y > 0 &&
+				x < options->height - 1 && y < options->width - 1 ? 0 :
+				mapgen_Wall(options, x, y);
+		}
+		if (!emit(row, options->width, data))
+			break;
+		emitted = x + 1;
+	}
+	for (k = 0; k < CAVERN_OCTAVES; k++)
+		free(values[k]);
+	return (emitted == options->height ? emitted : -1);
+}
@@ -0,0 +1,231 @@
+#include "../headers/mapgen.h"
+
+/*
+ * Maze styles work on a grid of rooms: room (r, c) is map cell
+ * (2r + 1, 2c + 1) and the map cells between rooms are the walls that get
+ * carved. Rooms are generated one row at a time, so only a few arrays as
+ * long as a row are ever held.
+ */
+
+/**
+ * maze_EmitRow - Builds and emits one map row of a room grid
+ * @options: Options of the map
+ * @row: Buffer for the cells of the row
+ * @x: Index of the map row; odd rows hold rooms, even rows the walls
+ * between two room rows
+ * @link: Per room, whether it opens east (odd rows) or south (even rows),
+ * or NULL for a solid row
+ * @keep: Percentage of the remaining walls between rooms kept standing
+ * @rng: Pointer to the generator state
+ * @emit: Row callback
+ * @data: Passed to @emit
+ *
+ * Return: The value returned by @emit
+ */
+static bool maze_EmitRow(const mapgen_t *options, int *row, int x,
+		const uint8_t *link, int keep, uint32_t *rng, maprow_fn emit,
+		void *data)
+{
+	int rooms = (options->width - 1) / 2, y, c;
+
+	for (y = 0; y < options->width; y++)
+		row[y] = mapgen_Wall(options, x, y);
+	for (c = 0; link != NULL && c < rooms; c++)
+	{
+		y = x % 2 ? 2 * c + 2 : 2 * c + 1;
+		if (x % 2)
+			row[2 * c + 1] = 0;
+		if (x % 2 && c == rooms - 1)
+			continue;
+		if (link[c] || (keep < 100 && !mapgen_Chance(rng, keep)))
+			row[y] = 0;
+	}
+	return (emit(row, options->width, data));
+}
+
+/**
+ * eller_Find - Finds the set a room belongs to
+ * @parent: Union-find parents of the rooms of the current row
+ * @c: Column of the room
+ *
+ * Return: Column of the room representing the set
+ */
+static int eller_Find(int *parent, int c)
+{
+	while (parent[c] != c)
+	{
+		parent[c] = parent[parent[c]];
+		c = parent[c];
+	}
+	return (c);
+}
+
+/**
+ * eller_Join - Randomly opens walls between neighbouring rooms of
+ * different sets; on the last row every such wall is opened
+ * @parent: Union-find parents of the rooms of the row
+ * @right: Receives whether each room opens east
+ * @rooms: Number of rooms in a row
+ * @last: True on the last row
+ * @rng: Pointer to the generator state
+ *
+ * Return: void
+ */
+static void eller_Join(int *parent, uint8_t *right, int rooms, bool last,
+		uint32_t *rng)
+{
+	int c, a, b;
+
+	for (c = 0; c < rooms; c++)
+	{
+		right[c] = 0;
+		if (c == rooms - 1)
+			break;
+		a = eller_Find(parent, c);
+		b = eller_Find(parent, c + 1);
+		if (a != b && (last || mapgen_Chance(rng, 50)))
+		{
+			parent[b] = a;
+			right[c] = 1;
+		}
+	}
+}
+
+/**
+ * eller_Drop - Opens at least one wall south of every set and builds the
+ * sets of the next row: rooms reached from above keep their set, the
+ * others start a set of their own
+ * @parent: Union-find parents, updated to the next row
+ * @scratch: Two arrays of @rooms ints
+ * @down: Receives whether each room opens south
+ * @rooms: Number of rooms in a row
+ * @rng: Pointer to the generator state
+ *
+ * Return: void
+ */
+static void eller_Drop(int *parent, int *scratch, uint8_t *down, int rooms,
+		uint32_t *rng)
+{
+	int *first = scratch, *last = scratch + rooms, c, root;
+
+	for (c = 0; c < rooms; c++)
+	{
+		first[eller_Find(parent, c)] = -1;
+		last[eller_Find(parent, c)] = -1;
+	}
+	for (c = 0; c < rooms; c++)
+	{
+		root = eller_Find(parent, c);
+		down[c] = mapgen_Chance(rng, 50);
+		if (down[c] || last[root] < 0 || down[last[root]] == 0)
+			last[root] = c;
+	}
+	for (c = 0; c < rooms; c++)
+		down[last[eller_Find(parent, c)]] = 1;
+	for (c = 0; c < rooms; c++)
+		last[c] = eller_Find(parent, c);
+	for (c = 0; c < rooms; c++)
+	{
+		parent[c] = c;
+		if (!down[c])
+			continue;
+		if (first[last[c]] < 0)
+			first[last[c]] = c;
+		parent[c] = first[last[c]];
+	}
+}
+
+/**
+ * mapgen_Perfect - Generates a perfect maze with Eller's algorithm
+ * @options: Options of the map
+ * @row: Buffer for the cells of a row
+ * @emit: Row callback
+ * @data: Passed to @emit
+ *
+ * Return: Number of rows emitted, or -1 on failure
+ */
+int mapgen_Perfect(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data)
+{
+	int rooms = (options->width - 1) / 2, r, c, *parent, emitted = -1;
+	int roomRows = (options->height - 1) / 2;
+	uint32_t rng = mapgen_Hash(options->seed, -1, -1) | 1;
+	uint8_t *links;
+
+	parent = malloc(rooms * 3 * sizeof(int));
+	links = malloc(rooms * 2);
+	if (parent != NULL && links != NULL &&
+	    maze_EmitRow(options, row, 0, NULL, 100, &rng, emit, data))
+	{
+		for (c = 0; c < rooms; c++)
+			parent[c] = c;
+		for (r = 0; r < roomRows; r++)
+		{
+			eller_Join(parent, links, rooms, r == roomRows - 1, &rng);
+			if (!maze_EmitRow(options, row, 2 * r + 1, links,
+					options->density, &rng, emit, data))
+				break;
+			if (r == roomRows - 1)
+				emitted = 2 * roomRows;
+			else
+				eller_Drop(parent, parent + rooms, links + rooms, rooms, &rng);
+			if (r < roomRows - 1 && !maze_EmitRow(options, row, 2 * r + 2,
+					links + rooms, options->density, &rng, emit, data))
+				break;
+		}
+	}
+	free(parent);
+	free(links);
+	return (emitted);
+}
+
+/**
+ * mapgen_Corridor - Generates long corridors with the Sidewinder
+ * algorithm: every room row is cut into runs, each run is one corridor
+ * and opens north through a single random room
+ * @options: Options of the map
+ * @row: Buffer for the cells of a row
+ * @emit: Row callback
+ * @data: Passed to @emit
+ *
+ * Return: Number of rows emitted, or -1 on failure
+ */
+int mapgen_Corridor(const mapgen_t *options, int *row, maprow_fn emit,
+		void *data)
+{
+	int rooms = (options->width - 1) / 2, r, c, start, emitted = -1;
+	int roomRows = (options->height - 1) / 2;
+	uint32_t rng = mapgen_Hash(options->seed, -1, -1) | 1;
+	uint8_t *right = malloc(rooms * 2), *north = right + rooms;
+
+	if (right == NULL ||
+	    !maze_EmitRow(options, row, 0, NULL, 100, &rng, emit, data))
+	{
+		free(right);
+		return (-1);
+	}
+	for (r = 0; r < roomRows; r++)
+	{
+		memset(north, 0, rooms);
+		for (c = 0, start = 0; c < rooms; c++)
+		{
+			right[c] = c < rooms - 1;
+			if (r == 0 || (c < rooms - 1 &&
+			    !mapgen_Chance(&rng, 100 - options->density)))
+				continue;
+			north[start + mapgen_Next(&rng) % (c - start + 1)] = 1;
+			right[c] = 0;
+			start = c + 1;
+		}
+		if (r > 0 && !maze_EmitRow(options, row, 2 * r, north, 100, &rng,
+				emit, data))
+			break;
+		if (!maze_EmitRow(options, row, 2 * r + 1, right, 100, &rng,
+				emit, data))
+			break;
+		if (r == roomRows - 1)
+			emitted = 2 * roomRows;
+	}
+	free(right);
+	return (emitted);
+}
@@ -0,0 +1,612 @@
+#include "../headers/metrics.h"
+#include "../headers/palette.h"
+#include <time.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define METRICS_SCALE 2
+#define METRICS_ADVANCE (6 * METRICS_SCALE)
+#define METRICS_SPACING (9 * METRICS_SCALE)
+#define METRICS_MARGIN 8
+#define METRICS_PADDING 4
+#define METRICS_INK 0xFFFFFF
+#define METRICS_SYMBOLS " .-:%/"
+
+/*
+ * 5 x 7 glyphs of the overlay, a row per byte with the leftmost pixel in
+ * bit 4: the digits, the letters, then METRICS_SYMBOLS
+ */
+static const uint8_t metrics_Font[][7] = {
+	{0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E},
+	{0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E},
+	{0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F},
+	{0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E},
+	{0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02},
+	{0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E},
+	{0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E},
+	{0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08},
+	{0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E},
+	{0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C},
+	{0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
+	{0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E},
+	{0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E},
+	{0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C},
+	{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F},
+	{0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10},
+	{0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F},
+	{0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11},
+	{0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E},
+	{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C},
+	{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11},
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F},
+	{0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11},
+	{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11},
+	{0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},
+	{0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10},
+	{0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D},
+	{0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11},
+	{0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E},
+	{0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E},
+	{0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04},
+	{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A},
+	{0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11},
+	{0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04},
+	{0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F},
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C},
+	{0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00},
+	{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00},
+	{0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03},
+	{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}
+};
+
+/**
+ * metrics_Bucket - Finds the histogram bucket of a duration: exact below
+ * 8 us, then 8 buckets for each doubling
+ * @micro: Duration in microseconds
+ *
+ * Return: Index of the bucket
+ */
+static int metrics_Bucket(uint32_t micro)
+{
+	int top = 31;
+
+	if (micro < 8)
+		return (micro);
+	while (!(micro >> top))
+		top--;
+	return ((top - 2) * 8 + (micro >> (top - 3) & 7));
+}
+
+/**
+ * metrics_Value - Finds the duration a histogram bucket stands for, the
+ * middle of the durations it counts
+ * @bucket: Index of the bucket
+ *
+ * Return: Duration in milliseconds
+ */
+static double metrics_Value(int bucket)
+{
+	if (bucket < 8)
+		return (bucket / 1000.0);
+	return ((bucket % 8 + 8.5) * ldexp(1, bucket / 8 - 1) / 1000.0);
+}
+
+/**
+ * metrics_Take - Takes a snapshot of the histograms and works out what was
+ * recorded since the last one
+ * @metrics: Pointer to the metrics
+ * @last: The reader's last snapshot, replaced by the new one
+ * @delta: Receives the count of each bucket since @last
+ *
+ * Return: Seconds since @last
+ */
+static double metrics_Take(metrics_t *metrics, metricsnapshot_t *last,
+		uint32_t delta[METRIC_COUNT][METRICS_BUCKETS])
+{
+	uint64_t now = SDL_GetPerformanceCounter();
+	double seconds = (now - last->time) * metrics->toMicro / 1e6;
+	uint32_t count;
+	int metric, bucket;
+
+	for (metric = 0; metric < METRIC_COUNT; metric++)
+		for (bucket = 0; bucket < METRICS_BUCKETS; bucket++)
+		{
+			count = SDL_AtomicGet(&metrics->counts[metric][bucket]);
+			delta[metric][bucket] = count - last->counts[metric][bucket];
+			last->counts[metric][bucket] = count;
+		}
+	last->time = now;
+	return (seconds);
+}
+
+/**
+ * metrics_Percentile - Finds a percentile of a histogram
+ * @counts: Count of each bucket
+ * @share: Share of the samples at or below the percentile, 1 for the
+ * largest sample
+ *
+ * Return: The percentile in milliseconds, or -1 without samples
+ */
+static double metrics_Percentile(const uint32_t counts[METRICS_BUCKETS],
+		double share)
+{
+	double total = 0, seen = 0;
+	int bucket;
+
+	for (bucket = 0; bucket < METRICS_BUCKETS; bucket++)
+		total += counts[bucket];
+	if (total == 0)
+		return (-1);
+	for (bucket = 0; bucket < METRICS_BUCKETS - 1; bucket++)
+	{
+		seen += counts[bucket];
+		if (seen >= total * share && seen > 0)
+			break;
+	}
+	return (metrics_Value(bucket));
+}
+
+/**
+ * metrics_Format - Writes the JSON line of the period since the last one.
+ * Only the reporter thread calls it on metrics that have an output.
+ * @metrics: Pointer to the metrics
+ * @line: Receives the line, newline included
+ * @size: Size of @line, at least METRICS_JSON
+ *
+ * Return: Length of the line
+ */
+int metrics_Format(metrics_t *metrics, char *line, size_t size)
+{
+	static const char * const names[METRIC_COUNT] = {"frame", "render",
+		"upload", "latency"};
+	static const char * const stats[] = {"p50", "p90", "p99", "max"};
+	static const double shares[] = {0.5, 0.9, 0.99, 1};
+	uint32_t delta[METRIC_COUNT][METRICS_BUCKETS], frames = 0;
+	double seconds = metrics_Take(metrics, &metrics->reported, delta), value;
+	int length, metric, stat, bucket;
+
+	for (bucket = 0; bucket < METRICS_BUCKETS; bucket++)
+		frames += delta[METRIC_FRAME][bucket];
+	length = snprintf(line, size, "{\"time\":%ld,\"uptime\":%.3f,"
+		"\"frames\":%u,\"fps\":%.2f", (long)time(NULL),
+		(metrics->reported.time - metrics->start) * metrics->toMicro / 1e6,
+		frames, seconds > 0 ? frames / seconds : 0);
+	for (metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		length += snprintf(line + length, size - length, ",\"%s\":{",
+			names[metric]);
+		for (stat = 0; stat < 4; stat++)
+		{
+			value = metrics_Percentile(delta[metric], shares[stat]);
+			length += snprintf(line + length, size - length, "%s\"%s\":",
+				stat ? "," : "", stats[stat]);
+			length += value < 0 ? snprintf(line + length, size - length,
+				"null") : snprintf(line + length, size - length, "%.3f", value);
+		}
+		length += snprintf(line + length, size - length, "}");
+	}
+	length += snprintf(line + length, size - length, "}\n");
+	return (length);
+}
+
+#ifdef __linux__
+
+/**
+ * metrics_Connect - Connects to the Unix socket metrics are written to
+ * @path: Path of the socket
+ *
+ * Return: The connected socket, or -1 if nothing listens there
+ */
+static int metrics_Connect(const char *path)
+{
+	struct sockaddr_un address;
+	int fd;
+
+	if (strlen(path) >= sizeof(address.sun_path))
+		return (-1);
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd >= 0 && connect(fd, (struct sockaddr *)&address,
+	    sizeof(address)) != 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+	return (fd);
+}
+
+#endif
+
+/**
+ * metrics_Write - Writes a JSON line to the output. A socket is never
+ * waited on: a line the listener has no room for is dropped, and a line
+ * sent in part closes the connection so the next one starts clean.
+ * @metrics: Pointer to the metrics
+ * @line: The line
+ * @length: Length of @line
+ *
+ * Return: void
+ */
+static void metrics_Write(metrics_t *metrics, const char *line, int length)
+{
+#ifdef __linux__
+	ssize_t sent;
+#endif
+
+	if (metrics->file)
+	{
+		if (fputs(line, metrics->file) >= 0 && fflush(metrics->file) == 0)
+			metrics->written++;
+		else
+			metrics->dropped++;
+		return;
+	}
+#ifdef __linux__
+	if (metrics->fd < 0)
+		metrics->fd = metrics_Connect(metrics->output + 5);
+	sent = metrics->fd < 0 ? -1 : send(metrics->fd, line, length,
+		MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (sent == length)
+	{
+		metrics->written++;
+		return;
+	}
+	if (metrics->fd >= 0 && (sent >= 0 || (errno != EAGAIN &&
+	    errno != EWOULDBLOCK)))
+	{
+		close(metrics->fd);
+		metrics->fd = -1;
+	}
+#else
+	(void)length;
+#endif
+	metrics->dropped++;
+}
+
+/**
+ * metrics_Reporter - Body of the reporter thread: writes a JSON line
+ * every period, and a last one when the metrics are destroyed
+ * @data: Pointer to the metrics
+ *
+ * Return: 0
+ */
+static int metrics_Reporter(void *data)
+{
+	metrics_t *metrics = data;
+	uint32_t deadline = SDL_GetTicks();
+	char line[METRICS_JSON];
+	bool stop = false;
+	int32_t wait;
+
+	while (!stop)
+	{
+		deadline += metrics->period;
+		/* A reporter held up past a whole period starts over from now */
+		if ((int32_t)(SDL_GetTicks() - deadline) > metrics->period)
+			deadline = SDL_GetTicks();
+		SDL_LockMutex(metrics->lock);
+		while (!metrics->stop &&
+		       (wait = (int32_t)(deadline - SDL_GetTicks())) > 0)
+			SDL_CondWaitTimeout(metrics->wake, metrics->lock, wait);
+		stop = metrics->stop;
+		SDL_UnlockMutex(metrics->lock);
+		metrics_Write(metrics, line, metrics_Format(metrics, line,
+			sizeof(line)));
+	}
+	return (0);
+}
+
+/**
+ * metrics_Record - Counts a duration in a histogram
+ * @metrics: Pointer to the metrics, may be NULL
+ * @metric: The histogram
+ * @ticks: The duration, in performance counter ticks
+ *
+ * Return: void
+ */
+void metrics_Record(metrics_t *metrics, metric_t metric, uint64_t ticks)
+{
+	double micro;
+
+	if (metrics == NULL)
+		return;
+	micro = ticks * metrics->toMicro;
+	SDL_AtomicAdd(&metrics->counts[metric][metrics_Bucket(micro <
+		UINT32_MAX ? (uint32_t)micro : UINT32_MAX)], 1);
+}
+
+/**
+ * metrics_FrameStart - Marks the start of a frame of the game loop
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_FrameStart(metrics_t *metrics)
+{
+	uint64_t now = SDL_GetPerformanceCounter();
+
+	if (metrics == NULL)
+		return;
+	if (metrics->frameStart)
+		metrics_Record(metrics, METRIC_FRAME, now - metrics->frameStart);
+	metrics->frameStart = now;
+}
+
+/**
+ * metrics_Input - Marks that the input was sampled; the latency runs
+ * until the next frame is presented
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_Input(metrics_t *metrics)
+{
+	if (metrics && metrics->inputTime == 0)
+		metrics->inputTime = SDL_GetPerformanceCounter();
+}
+
+/**
+ * metrics_UploadStart - Marks the end of drawing and the start of handing
+ * the frame on
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_UploadStart(metrics_t *metrics)
+{
+	uint64_t now = SDL_GetPerformanceCounter();
+
+	if (metrics == NULL)
+		return;
+	if (metrics->frameStart)
+		metrics_Record(metrics, METRIC_RENDER, now - metrics->frameStart);
+	metrics->uploadStart = now;
+}
+
+/**
+ * metrics_Presented - Marks that the frame is on the screen
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_Presented(metrics_t *metrics)
+{
+	uint64_t now = SDL_GetPerformanceCounter();
+
+	if (metrics == NULL)
+		return;
+	if (metrics->uploadStart)
+		metrics_Record(metrics, METRIC_UPLOAD, now - metrics->uploadStart);
+	if (metrics->inputTime)
+		metrics_Record(metrics, METRIC_LATENCY, now - metrics->inputTime);
+	metrics->uploadStart = 0;
+	metrics->inputTime = 0;
+}
+
+/**
+ * metrics_Toggle - Shows or hides the overlay
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_Toggle(metrics_t *metrics)
+{
+	if (metrics == NULL)
+		return;
+	metrics->overlay = !metrics->overlay;
+	metrics->shown.time = 0;
+}
+
+/**
+ * metrics_Refresh - Rewrites the overlay text from what was recorded since
+ * the last refresh
+ * @metrics: Pointer to the metrics
+ * @state: Pointer to the state, whose palette is used in palette builds
+ *
+ * Return: void
+ */
+static void metrics_Refresh(metrics_t *metrics, const GameState *state)
+{
+	static const char * const names[METRIC_COUNT] = {"FRAME", "RENDER",
+		"UPLOAD", "INPUT"};
+	uint32_t delta[METRIC_COUNT][METRICS_BUCKETS], frames = 0;
+	bool shown = metrics->shown.time != 0;
+	double seconds, p50, p99, max;
+	int metric, bucket;
+
+	seconds = metrics_Take(metrics, &metrics->shown, delta);
+	/* Just shown: what came before only starts the first period */
+	if (!shown)
+		memset(delta, 0, sizeof(delta));
+	for (bucket = 0; bucket < METRICS_BUCKETS; bucket++)
+		frames += delta[METRIC_FRAME][bucket];
+	if (frames > 0)
+		snprintf(metrics->lines[0], METRICS_LINE, "FPS %.1f",
+			frames / seconds);
+	else
+		snprintf(metrics->lines[0], METRICS_LINE, "FPS -");
+	snprintf(metrics->lines[1], METRICS_LINE, "MS        P50    P99    MAX");
+	for (metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		p50 = metrics_Percentile(delta[metric], 0.5);
+		p99 = metrics_Percentile(delta[metric], 0.99);
+		max = metrics_Percentile(delta[metric], 1);
+		if (p50 < 0)
+			snprintf(metrics->lines[2 + metric], METRICS_LINE,
+				"%-6s      -      -      -", names[metric]);
+		else
+			snprintf(metrics->lines[2 + metric], METRICS_LINE,
+				"%-6s %6.2f %6.2f %6.2f", names[metric], p50, p99, max);
+	}
+#ifdef MAZE_PALETTE
+	metrics->ink = palette_Nearest(state->palette, METRICS_INK);
+#else
+	(void)state;
+	metrics->ink = METRICS_INK;
+#endif
+}
+
+/**
+ * metrics_Glyph - Finds the glyph of a character, letters in either case
+ * @c: The character
+ *
+ * Return: The glyph, blank for characters the font lacks
+ */
+static const uint8_t *metrics_Glyph(char c)
+{
+	const char *symbol = c ? strchr(METRICS_SYMBOLS, c) : NULL;
+
+	if (c >= '0' && c <= '9')
+		return (metrics_Font[c - '0']);
+	if (c >= 'A' && c <= 'Z')
+		return (metrics_Font[10 + c - 'A']);
+	if (c >= 'a' && c <= 'z')
+		return (metrics_Font[10 + c - 'a']);
+	return (metrics_Font[36 + (symbol ? symbol - METRICS_SYMBOLS : 0)]);
+}
+
+/**
+ * metrics_Text - Draws a line of text into the screen buffer
+ * @state: Pointer to the state
+ * @x: Column of the left of the text
+ * @y: Row of the top of the text
+ * @text: The text, short enough to fit the screen
+ * @ink: Pixel to draw with
+ *
+ * Return: void
+ */
+static void metrics_Text(GameState *state, int x, int y, const char *text,
+		pixel_t ink)
+{
+	const uint8_t *glyph;
+	int row, column;
+
+	for (; *text; text++, x += METRICS_ADVANCE)
+	{
+		glyph = metrics_Glyph(*text);
+		for (row = 0; row < 7 * METRICS_SCALE; row++)
+			for (column = 0; column < 5 * METRICS_SCALE; column++)
+				if (glyph[row / METRICS_SCALE] & 0x10 >> column / METRICS_SCALE)
+					state->screenBuffer[y + row][x + column] = ink;
+	}
+}
+
+/**
+ * metrics_Draw - Draws the overlay into the screen buffer when it is
+ * shown, refreshing its figures every METRICS_OVERLAY_PERIOD ms
+ * @metrics: Pointer to the metrics, may be NULL
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+void metrics_Draw(metrics_t *metrics, GameState *state)
+{
+	int width = METRICS_LINE * METRICS_ADVANCE + 2 * METRICS_PADDING;
+	int height = METRICS_LINES * METRICS_SPACING + 2 * METRICS_PADDING;
+	int row;
+
+	if (metrics == NULL || !metrics->overlay)
+		return;
+	if (metrics->shown.time == 0 || (SDL_GetPerformanceCounter() -
+	    metrics->shown.time) * metrics->toMicro >=
+	    METRICS_OVERLAY_PERIOD * 1000.0)
+		metrics_Refresh(metrics, state);
+	/* Pixel 0 is black in both frame formats */
+	for (row = 0; row < height; row++)
+		memset(&state->screenBuffer[METRICS_MARGIN + row][METRICS_MARGIN], 0,
+			width * sizeof(pixel_t));
+	for (row = 0; row < METRICS_LINES; row++)
+		metrics_Text(state, METRICS_MARGIN + METRICS_PADDING, METRICS_MARGIN +
+			METRICS_PADDING + row * METRICS_SPACING, metrics->lines[row],
+			metrics->ink);
+}
+
+/**
+ * metrics_Create - Starts timing frames, and reporting them when there is
+ * an output
+ * @output: Path of the file JSON lines are appended to, "unix:" followed
+ * by the path of a socket to send them to, or NULL for no reports; must
+ * outlive the metrics
+ * @period: Milliseconds between two reports, METRICS_PERIOD if 0
+ *
+ * Return: Pointer to the metrics, or NULL on failure
+ */
+metrics_t *metrics_Create(const char *output, int period)
+{
+	metrics_t *metrics = calloc(1, sizeof(metrics_t));
+	bool toSocket, reachable;
+
+	if (metrics == NULL)
+		return (NULL);
+	metrics->toMicro = 1e6 / SDL_GetPerformanceFrequency();
+	metrics->start = SDL_GetPerformanceCounter();
+	metrics->reported.time = metrics->start;
+	metrics->fd = -1;
+	metrics->period = period > 0 ? period : METRICS_PERIOD;
+	if (output == NULL)
+		return (metrics);
+	metrics->output = (char *)output;
+	toSocket = strncmp(output, "unix:", 5) == 0;
+	if (!toSocket)
+		metrics->file = fopen(output, "a");
+#ifdef __linux__
+	reachable = metrics->file != NULL || toSocket;
+#else
+	reachable = metrics->file != NULL;
+#endif
+	metrics->lock = SDL_CreateMutex();
+	metrics->wake = SDL_CreateCond();
+	if (reachable && metrics->lock && metrics->wake)
+		metrics->thread = SDL_CreateThread(metrics_Reporter, "metrics",
+			metrics);
+	if (metrics->thread == NULL)
+	{
+		fprintf(stderr, "Error: Unable to report metrics to %s\n", output);
+		metrics_Destroy(metrics);
+		return (NULL);
+	}
+	return (metrics);
+}
+
+/**
+ * metrics_Destroy - Writes the last report, closes the output and frees
+ * the metrics
+ * @metrics: Pointer to the metrics, may be NULL
+ *
+ * Return: void
+ */
+void metrics_Destroy(metrics_t *metrics)
+{
+	if (metrics == NULL)
+		return;
+	if (metrics->thread)
+	{
+		SDL_LockMutex(metrics->lock);
+		metrics->stop = true;
+		SDL_CondSignal(metrics->wake);
+		SDL_UnlockMutex(metrics->lock);
+		SDL_WaitThread(metrics->thread, NULL);
+		fprintf(stderr, "Reported metrics %lu times, %lu dropped\n",
+			metrics->written, metrics->dropped);
+	}
+	if (metrics->file)
+		fclose(metrics->file);
+#ifdef __linux__
+	if (metrics->fd >= 0)
+		close(metrics->fd);
+#endif
+	if (metrics->wake)
+		SDL_DestroyCond(metrics->wake);
+	if (metrics->lock)
+		SDL_DestroyMutex(metrics->lock);
+	free(metrics);
+}
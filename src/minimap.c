@@ -0,0 +1,554 @@
+#include "../headers/minimap.h"
+#include "../headers/palette.h"
+
+/**
+ * minimap_Color - Converts an xRGB colour to the frame format
+ * @state: Pointer to the state, whose palette is used in palette builds
+ * @color: xRGB colour
+ *
+ * Return: The pixel
+ */
+static pixel_t minimap_Color(const GameState *state, uint32_t color)
+{
+#ifdef MAZE_PALETTE
+	return (palette_Nearest(state->palette, color));
+#else
+	(void)state;
+	return (color);
+#endif
+}
+
+/**
+ * minimap_Paint - Converts the colours of the minimap to the frame format,
+ * blending each wall coverage between the open and wall colours
+ * @minimap: Pointer to the minimap
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+static void minimap_Paint(minimap_t *minimap, const GameState *state)
+{
+	uint32_t color;
+	int cover, shift;
+
+	for (cover = 0; cover < 256; cover++)
+	{
+		color = 0;
+		for (shift = 0; shift < 24; shift += 8)
+			color |= (((MINIMAP_OPEN >> shift & 0xFF) * (255 - cover) +
+				(MINIMAP_WALL >> shift & 0xFF) * cover + 127) / 255) << shift;
+		minimap->colors[cover] = minimap_Color(state, color);
+	}
+	minimap->outside = minimap_Color(state, MINIMAP_VOID);
+	minimap->player = minimap_Color(state, MINIMAP_PLAYER);
+	minimap->view = minimap_Color(state, MINIMAP_VIEW);
+	minimap->painted = true;
+	minimap->valid = false;
+}
+
+/**
+ * minimap_Reduce - Averages the four texels of a level under a texel of
+ * the level above, counting texels past the edge as walls
+ * @below: Level below
+ * @x: Row of the texel above
+ * @y: Column of the texel above
+ *
+ * Return: Wall coverage of the texel above
+ */
+static uint8_t minimap_Reduce(const minimaplevel_t *below, int x, int y)
+{
+	int sum = 0, dx, dy;
+
+	for (dx = 2 * x; dx < 2 * x + 2; dx++)
+		for (dy = 2 * y; dy < 2 * y + 2; dy++)
+			sum += dx < below->height && dy < below->width ?
+				below->cover[dx * below->width + dy] : 255;
+	return ((sum + 2) / 4);
+}
+
+/**
+ * minimap_Rebuild - Recomputes the pyramid over a rectangle of cells
+ * @minimap: Pointer to the minimap
+ * @x0: First row of the rectangle
+ * @y0: First column of the rectangle
+ * @x1: Last row of the rectangle
+ * @y1: Last column of the rectangle
+ *
+ * Return: void
+ */
+static void minimap_Rebuild(minimap_t *minimap, int x0, int y0, int x1,
+		int y1)
+{
+	minimaplevel_t *level = &minimap->levels[0];
+	int l, x, y;
+
+	for (x = x0; x <= x1; x++)
+		for (y = y0; y <= y1; y++)
+			level->cover[x * level->width + y] =
+				minimap->maze[x * minimap->mapWidth + y] ? 255 : 0;
+	for (l = 1; l < minimap->levelCount; l++)
+	{
+		level = &minimap->levels[l];
+		x0 >>= 1;
+		y0 >>= 1;
+		x1 >>= 1;
+		y1 >>= 1;
+		for (x = x0; x <= x1; x++)
+			for (y = y0; y <= y1; y++)
+				level->cover[x * level->width + y] =
+					minimap_Reduce(level - 1, x, y);
+	}
+}
+
+/**
+ * minimap_Release - Frees the pyramid
+ * @minimap: Pointer to the minimap
+ *
+ * Return: void
+ */
+static void minimap_Release(minimap_t *minimap)
+{
+	int l;
+
+	for (l = 0; l < minimap->levelCount; l++)
+		free(minimap->levels[l].cover);
+	minimap->levelCount = 0;
+	minimap->maze = NULL;
+	minimap->valid = false;
+}
+
+/**
+ * minimap_Build - Builds the pyramid of the maze of the state
+ * @minimap: Pointer to the minimap
+ * @state: Pointer to the state
+ *
+ * Return: true on success, false if out of memory
+ */
+static bool minimap_Build(minimap_t *minimap, const GameState *state)
+{
+	int width = state->mapWidth, height = state->mapHeight;
+	minimaplevel_t *level;
+
+	minimap_Release(minimap);
+	while (minimap->levelCount < MINIMAP_LEVELS)
+	{
+		level = &minimap->levels[minimap->levelCount];
+		level->width = width;
+		level->height = height;
+		level->cover = malloc((size_t)width * height);
+		if (level->cover == NULL)
+		{
+			fprintf(stderr, "Error: Unable to allocate the minimap\n");
+			minimap_Release(minimap);
+			return (false);
+		}
+		minimap->levelCount++;
+		if (width == 1 && height == 1)
+			break;
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+	}
+	minimap->maze = state->maze;
+	minimap->mapWidth = state->mapWidth;
+	minimap->mapHeight = state->mapHeight;
+	minimap_Rebuild(minimap, 0, 0, state->mapHeight - 1,
+		state->mapWidth - 1);
+	return (true);
+}
+
+/**
+ * minimap_Extent - Finds the size of the map at a scale
+ * @minimap: Pointer to the minimap, with its pyramid
+ * @scale: Scale, as the zoom of the minimap
+ * @rows: Receives the number of pixel rows
+ * @columns: Receives the number of pixel columns
+ *
+ * Return: void
+ */
+static void minimap_Extent(const minimap_t *minimap, int scale, int *rows,
+		int *columns)
+{
+	*rows = scale >= 0 ? minimap->levels[scale].height :
+		minimap->mapHeight << -scale;
+	*columns = scale >= 0 ? minimap->levels[scale].width :
+		minimap->mapWidth << -scale;
+}
+
+/**
+ * minimap_Place - Works out where the view goes on the screen, its scale
+ * and the pixel of the map at its top left corner
+ * @minimap: Pointer to the minimap, with its pyramid
+ * @state: Pointer to the state
+ * @window: Receives the place on the screen
+ * @scale: Receives the scale
+ * @origin: Receives the map pixel at the top left, x along map rows
+ *
+ * Return: void
+ */
+static void minimap_Place(const minimap_t *minimap, const GameState *state,
+		SDL_Rect *window, int *scale, SDL_Point *origin)
+{
+	int rows, columns;
+
+	if (minimap->mode == MINIMAP_CORNER)
+	{
+		*scale = minimap->zoom < minimap->levelCount - 1 ? minimap->zoom :
+			minimap->levelCount - 1;
+		window->x = SCREEN_WIDTH - MINIMAP_SIZE - MINIMAP_MARGIN;
+		window->y = MINIMAP_MARGIN;
+		window->w = MINIMAP_SIZE;
+		window->h = MINIMAP_SIZE;
+		origin->x = (int)floor(ldexp(state->position.x, -*scale)) -
+			MINIMAP_SIZE / 2;
+		origin->y = (int)floor(ldexp(state->position.y, -*scale)) -
+			MINIMAP_SIZE / 2;
+		return;
+	}
+	/* The overview takes the largest scale that fits the screen */
+	for (*scale = -MINIMAP_MAGNIFY; ; (*scale)++)
+	{
+		minimap_Extent(minimap, *scale, &rows, &columns);
+		if (*scale == minimap->levelCount - 1 || (rows <= SCREEN_HEIGHT -
+		    2 * MINIMAP_MARGIN && columns <= SCREEN_WIDTH - 2 * MINIMAP_MARGIN))
+			break;
+	}
+	window->w = columns;
+	window->h = rows;
+	window->x = (SCREEN_WIDTH - columns) / 2;
+	window->y = (SCREEN_HEIGHT - rows) / 2;
+	origin->x = 0;
+	origin->y = 0;
+}
+
+/**
+ * minimap_AddDirty - Marks part of the map to be rasterised again
+ * @minimap: Pointer to the minimap
+ * @x: First pixel row, at the scale of the layer
+ * @y: First pixel column
+ * @w: Number of rows
+ * @h: Number of columns
+ *
+ * Return: void
+ */
+static void minimap_AddDirty(minimap_t *minimap, int x, int y, int w, int h)
+{
+	if (!minimap->valid || w <= 0 || h <= 0)
+		return;
+	/* Past a handful of rectangles, drawing it all is as quick */
+	if (minimap->dirtyCount == MINIMAP_DIRTY)
+	{
+		minimap->valid = false;
+		return;
+	}
+	minimap->dirty[minimap->dirtyCount].x = x;
+	minimap->dirty[minimap->dirtyCount].y = y;
+	minimap->dirty[minimap->dirtyCount].w = w;
+	minimap->dirty[minimap->dirtyCount].h = h;
+	minimap->dirtyCount++;
+}
+
+/**
+ * minimap_Scroll - Moves the content of the layer to a new origin and
+ * marks the pixels it uncovers dirty
+ * @minimap: Pointer to the minimap, with a valid layer
+ * @origin: New origin, at the same scale
+ *
+ * Return: void
+ */
+static void minimap_Scroll(minimap_t *minimap, SDL_Point origin)
+{
+	int dx = origin.x - minimap->originX, dy = origin.y - minimap->originY;
+	int rows = minimap->window.h, columns = minimap->window.w, keep, row;
+
+	if (dx == 0 && dy == 0)
+		return;
+	if (abs(dx) >= rows || abs(dy) >= columns)
+	{
+		minimap->valid = false;
+		return;
+	}
+	keep = columns - abs(dy);
+	/* Rows are moved in the order that reads each before overwriting it */
+	for (row = dx > 0 ? 0 : rows - 1; row >= 0 && row < rows;
+	     row += dx > 0 ? 1 : -1)
+		if (row + dx >= 0 && row + dx < rows)
+			memmove(minimap->layer + row * SCREEN_WIDTH + (dy < 0 ? -dy : 0),
+				minimap->layer + (row + dx) * SCREEN_WIDTH + (dy > 0 ? dy : 0),
+				keep * sizeof(pixel_t));
+	minimap_AddDirty(minimap, dx > 0 ? origin.x + rows - dx : origin.x,
+		origin.y, abs(dx), columns);
+	minimap_AddDirty(minimap, origin.x, dy > 0 ? origin.y + columns - dy :
+		origin.y, rows, abs(dy));
+}
+
+/**
+ * minimap_Raster - Rasterises the part of a dirty rectangle in the layer
+ * @minimap: Pointer to the minimap
+ * @rect: The rectangle, in map pixels as @minimap->dirty
+ *
+ * Return: void
+ */
+static void minimap_Raster(minimap_t *minimap, const SDL_Rect *rect)
+{
+	int scale = minimap->scale, shift = scale < 0 ? -scale : 0;
+	const minimaplevel_t *level = &minimap->levels[scale > 0 ? scale : 0];
+	int x0 = rect->x > minimap->originX ? rect->x : minimap->originX;
+	int y0 = rect->y > minimap->originY ? rect->y : minimap->originY;
+	int x1 = minimap->originX + minimap->window.h, x, y, cx, cy;
+	int y1 = minimap->originY + minimap->window.w;
+	pixel_t *out;
+
+	x1 = rect->x + rect->w < x1 ? rect->x + rect->w : x1;
+	y1 = rect->y + rect->h < y1 ? rect->y + rect->h : y1;
+	for (x = x0; x < x1; x++)
+	{
+		out = minimap->layer + (x - minimap->originX) * SCREEN_WIDTH -
+			minimap->originY;
+		cx = x >> shift;
+		for (y = y0; y < y1; y++)
+		{
+			cy = y >> shift;
+			out[y] = x < 0 || y < 0 || cx >= level->height ||
+				cy >= level->width ? minimap->outside :
+				minimap->colors[level->cover[cx * level->width + cy]];
+		}
+	}
+}
+
+/**
+ * minimap_Line - Draws a line on the screen, clipped to a window
+ * @state: Pointer to the state
+ * @window: The window
+ * @x: Row of the start in the window
+ * @y: Column of the start in the window
+ * @dx: Direction along the rows
+ * @dy: Direction along the columns
+ * @color: Pixel to draw with
+ *
+ * Return: void
+ */
+static void minimap_Line(GameState *state, const SDL_Rect *window, double x,
+		double y, double dx, double dy, pixel_t color)
+{
+	double length = sqrt(dx * dx + dy * dy);
+	int i, row, column;
+
+	for (i = 0; length > 0 && i <= MINIMAP_CONE; i++)
+	{
+		row = (int)floor(x + dx / length * i);
+		column = (int)floor(y + dy / length * i);
+		if (row >= 0 && row < window->h && column >= 0 &&
+		    column < window->w)
+			state->screenBuffer[window->y + row][window->x + column] = color;
+	}
+}
+
+/**
+ * minimap_Overlay - Draws the edges of the view and the player over the
+ * copied layer
+ * @minimap: Pointer to the minimap
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+static void minimap_Overlay(const minimap_t *minimap, GameState *state)
+{
+	const SDL_Rect *window = &minimap->window;
+	double x = ldexp(state->position.x, -minimap->scale) - minimap->originX;
+	double y = ldexp(state->position.y, -minimap->scale) - minimap->originY;
+	int row, column;
+
+	minimap_Line(state, window, x, y, state->direction.x -
+		state->viewPlane.x, state->direction.y - state->viewPlane.y,
+		minimap->view);
+	minimap_Line(state, window, x, y, state->direction.x +
+		state->viewPlane.x, state->direction.y + state->viewPlane.y,
+		minimap->view);
+	for (row = (int)floor(x) - 1; row <= (int)floor(x) + 1; row++)
+		for (column = (int)floor(y) - 1; column <= (int)floor(y) + 1; column++)
+			if (row >= 0 && row < window->h && column >= 0 &&
+			    column < window->w)
+				state->screenBuffer[window->y + row][window->x + column] =
+					minimap->player;
+}
+
+/**
+ * minimap_Draw - Draws the minimap into the screen buffer: scrolls the
+ * layer to the player, rasterises what is dirty, copies the layer and
+ * draws the player over it
+ * @minimap: Pointer to the minimap, may be NULL
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+void minimap_Draw(minimap_t *minimap, GameState *state)
+{
+	SDL_Rect window;
+	SDL_Point origin;
+	int scale, i;
+
+	if (minimap == NULL)
+		return;
+	/* A reloaded map drops the pyramid even while nothing is shown */
+	if (minimap->maze && (minimap->maze != state->maze ||
+	    minimap->mapWidth != state->mapWidth ||
+	    minimap->mapHeight != state->mapHeight))
+		minimap_Release(minimap);
+	if (minimap->mode == MINIMAP_OFF)
+		return;
+	if (minimap->maze == NULL && !minimap_Build(minimap, state))
+	{
+		minimap->mode = MINIMAP_OFF;
+		return;
+	}
+	if (!minimap->painted)
+		minimap_Paint(minimap, state);
+	minimap_Place(minimap, state, &window, &scale, &origin);
+	if (minimap->valid && (scale != minimap->scale ||
+	    memcmp(&window, &minimap->window, sizeof(window)) != 0))
+		minimap->valid = false;
+	if (minimap->valid)
+		minimap_Scroll(minimap, origin);
+	minimap->window = window;
+	minimap->scale = scale;
+	minimap->originX = origin.x;
+	minimap->originY = origin.y;
+	if (!minimap->valid)
+	{
+		minimap->dirty[0].x = origin.x;
+		minimap->dirty[0].y = origin.y;
+		minimap->dirty[0].w = window.h;
+		minimap->dirty[0].h = window.w;
+		minimap->dirtyCount = 1;
+		minimap->valid = true;
+	}
+	for (i = 0; i < minimap->dirtyCount; i++)
+		minimap_Raster(minimap, &minimap->dirty[i]);
+	minimap->dirtyCount = 0;
+	for (i = 0; i < window.h; i++)
+		memcpy(&state->screenBuffer[window.y + i][window.x],
+			minimap->layer + i * SCREEN_WIDTH, window.w * sizeof(pixel_t));
+	minimap_Overlay(minimap, state);
+}
+
+/**
+ * minimap_Repair - Updates the minimap after cells of the maze changed,
+ * redrawing only the changed part of the view
+ * @minimap: Pointer to the minimap, may be NULL
+ * @rects: Changed cells, as handed out by mapedit_TakeDirty: x and w
+ * along rows, y and h along columns
+ * @count: Number of entries in @rects
+ *
+ * Return: void
+ */
+void minimap_Repair(minimap_t *minimap, const SDL_Rect *rects, int count)
+{
+	int i, x0, y0, x1, y1, scale;
+
+	if (minimap == NULL || minimap->maze == NULL)
+		return;
+	scale = minimap->scale;
+	for (i = 0; i < count; i++)
+	{
+		x0 = rects[i].x > 0 ? rects[i].x : 0;
+		y0 = rects[i].y > 0 ? rects[i].y : 0;
+		x1 = rects[i].x + rects[i].w < minimap->mapHeight ?
+			rects[i].x + rects[i].w - 1 : minimap->mapHeight - 1;
+		y1 = rects[i].y + rects[i].h < minimap->mapWidth ?
+			rects[i].y + rects[i].h - 1 : minimap->mapWidth - 1;
+		if (x0 > x1 || y0 > y1)
+			continue;
+		minimap_Rebuild(minimap, x0, y0, x1, y1);
+		if (scale >= 0)
+			minimap_AddDirty(minimap, x0 >> scale, y0 >> scale,
+				(x1 >> scale) - (x0 >> scale) + 1,
+				(y1 >> scale) - (y0 >> scale) + 1);
+		else
+			minimap_AddDirty(minimap, x0 << -scale, y0 << -scale,
+				(x1 - x0 + 1) << -scale, (y1 - y0 + 1) << -scale);
+	}
+}
+
+/**
+ * minimap_Invalidate - Redraws the whole minimap on the next frame with
+ * colours converted again, after the palette changed
+ * @minimap: Pointer to the minimap, may be NULL
+ *
+ * Return: void
+ */
+void minimap_Invalidate(minimap_t *minimap)
+{
+	if (minimap)
+		minimap->painted = false;
+}
+
+/**
+ * minimap_Cycle - Switches from no minimap to the corner view, then to
+ * the overview and back
+ * @minimap: Pointer to the minimap, may be NULL
+ *
+ * Return: void
+ */
+void minimap_Cycle(minimap_t *minimap)
+{
+	if (minimap)
+		minimap->mode = minimap->mode == MINIMAP_OVERVIEW ? MINIMAP_OFF :
+			minimap->mode + 1;
+}
+
+/**
+ * minimap_Zoom - Zooms the corner view out, or in with negative steps
+ * @minimap: Pointer to the minimap, may be NULL
+ * @steps: Number of halvings of the scale
+ *
+ * Return: void
+ */
+void minimap_Zoom(minimap_t *minimap, int steps)
+{
+	if (minimap == NULL)
+		return;
+	minimap->zoom += steps;
+	if (minimap->zoom < -MINIMAP_MAGNIFY)
+		minimap->zoom = -MINIMAP_MAGNIFY;
+	if (minimap->zoom > MINIMAP_LEVELS - 1)
+		minimap->zoom = MINIMAP_LEVELS - 1;
+	if (minimap->levelCount > 0 && minimap->zoom > minimap->levelCount - 1)
+		minimap->zoom = minimap->levelCount - 1;
+}
+
+/**
+ * minimap_Create - Creates a hidden minimap; the pyramid is built when it
+ * is first shown
+ *
+ * Return: Pointer to the minimap, or NULL on failure
+ */
+minimap_t *minimap_Create(void)
+{
+	minimap_t *minimap = calloc(1, sizeof(minimap_t));
+
+	if (minimap == NULL)
+		return (NULL);
+	minimap->zoom = -2;
+	minimap->layer = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(pixel_t));
+	if (minimap->layer == NULL)
+	{
+		free(minimap);
+		return (NULL);
+	}
+	return (minimap);
+}
+
+/**
+ * minimap_Destroy - Frees the minimap
+ * @minimap: Pointer to the minimap, may be NULL
+ *
+ * Return: void
+ */
+void minimap_Destroy(minimap_t *minimap)
+{
+	if (minimap == NULL)
+		return;
+	minimap_Release(minimap);
+	free(minimap->layer);
+	free(minimap);
+}
@@ -0,0 +1,254 @@
+#include "../headers/navigation.h"
+
+#define NAV_QUEUED 1
+#define NAV_ORPHAN 2
+#define NAV_SEEDED 4
+
+/**
+ * struct cellvec_s - growable list of cell indices
+ * @cells: the indices
+ * @size: number of used entries
+ * @capacity: number of allocated entries
+ */
+typedef struct cellvec_s
+{
+	int *cells;
+	int size;
+	int capacity;
+} cellvec_t;
+
+static const int navStep[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+
+/**
+ * nav_MinNeighbour - Finds the smallest distance among the walkable
+ * neighbours of a cell
+ * @field: Pointer to the field
+ * @cell: Index of the cell
+ *
+ * Return: The smallest neighbour distance, or NAV_UNREACHABLE
+ */
+static uint32_t nav_MinNeighbour(const flowfield_t *field, int cell)
+{
+	int k, nx, ny;
+	uint32_t d, best = NAV_UNREACHABLE;
+
+	for (k = 0; k < 4; k++)
+	{
+		nx = cell / field->width + navStep[k][0];
+		ny = cell % field->width + navStep[k][1];
+		if (!nav_IsWalkable(field->maze, field->width, field->height, nx, ny))
+			continue;
+		d = field->dist[nx * field->width + ny];
+		if (d < best)
+			best = d;
+	}
+	return (best);
+}
+
+/**
+ * cellvec_Push - Appends a cell to a growable list
+ * @vec: Pointer to the list
+ * @cell: Cell index to append
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool cellvec_Push(cellvec_t *vec, int cell)
+{
+	int *grown;
+
+	if (vec->size == vec->capacity)
+	{
+		vec->capacity = vec->capacity ? vec->capacity * 2 : 64;
+		grown = realloc(vec->cells, vec->capacity * sizeof(int));
+		if (grown == NULL)
+			return (false);
+		vec->cells = grown;
+	}
+	vec->cells[vec->size++] = cell;
+	return (true);
+}
+
+/**
+ * nav_Relax - Lowers distances outwards from cells whose distance is final,
+ * visiting them in increasing order so each cell is settled once
+ * @field: Pointer to the field
+ * @seeds: Settled cells sorted by increasing distance
+ *
+ * Return: void
+ */
+static void nav_Relax(flowfield_t *field, cellvec_t *seeds)
+{
+	cellvec_t queue = {NULL, 0, 0};
+	int head = 0, next = 0, cell, k, nx, ny, n;
+
+	while (next < seeds->size || head < queue.size)
+	{
+		if (head == queue.size || (next < seeds->size &&
+		    field->dist[seeds->cells[next]] <= field->dist[queue.cells[head]]))
+			cell = seeds->cells[next++];
+		else
+			cell = queue.cells[head++];
+		if (field->dist[cell] == NAV_UNREACHABLE)
+			continue;
+		for (k = 0; k < 4; k++)
+		{
+			nx = cell / field->width + navStep[k][0];
+			ny = cell % field->width + navStep[k][1];
+			if (!nav_IsWalkable(field->maze, field->width, field->height,
+					nx, ny))
+				continue;
+			n = nx * field->width + ny;
+			if (field->dist[cell] + 1 >= field->dist[n])
+				continue;
+			field->dist[n] = field->dist[cell] + 1;
+			if (!cellvec_Push(&queue, n))
+				break;
+		}
+	}
+	free(queue.cells);
+}
+
+/**
+ * nav_CollectOrphans - Finds the cells whose every shortest route went
+ * through a cell that just became a wall and resets them to unreachable.
+ * Cells are visited level by level, so all orphans one step closer to the
+ * goal are known before a cell is checked for remaining support.
+ * @field: Pointer to the field
+ * @cell: Index of the cell that was closed
+ * @previous: Distance the closed cell had
+ * @visited: Receives every cell looked at, orphans are flagged NAV_ORPHAN
+ *
+ * Return: void
+ */
+static void nav_CollectOrphans(flowfield_t *field, int cell,
+		uint32_t previous, cellvec_t *visited)
+{
+	int head, k, nx, ny, n;
+	uint32_t level;
+
+	field->mark[cell] = NAV_QUEUED;
+	cellvec_Push(visited, cell);
+	for (head = 0; head < visited->size; head++)
+	{
+		cell = visited->cells[head];
+		if (head > 0 && nav_MinNeighbour(field, cell) + 1 == field->dist[cell])
+			continue;
+		level = head == 0 ? previous : field->dist[cell];
+		field->mark[cell] |= NAV_ORPHAN;
+		field->dist[cell] = NAV_UNREACHABLE;
+		for (k = 0; k < 4; k++)
+		{
+			nx = cell / field->width + navStep[k][0];
+			ny = cell % field->width + navStep[k][1];
+			n = nx * field->width + ny;
+			if (!nav_IsWalkable(field->maze, field->width, field->height,
+					nx, ny) || field->mark[n] || field->dist[n] != level + 1)
+				continue;
+			field->mark[n] = NAV_QUEUED;
+			cellvec_Push(visited, n);
+		}
+	}
+}
+
+/**
+ * compare_SeedKeys - qsort comparator for (distance << 32 | cell) keys
+ * @a: Pointer to the first key
+ * @b: Pointer to the second key
+ *
+ * Return: Negative, zero or positive like strcmp
+ */
+static int compare_SeedKeys(const void *a, const void *b)
+{
+	uint64_t ka = *(const uint64_t *)a, kb = *(const uint64_t *)b;
+
+	return ((ka > kb) - (ka < kb));
+}
+
+/**
+ * nav_GatherSeeds - Collects the reachable cells bordering the orphans,
+ * sorted by distance, so the orphans can be filled back in from them
+ * @field: Pointer to the field
+ * @visited: Cells looked at by nav_CollectOrphans
+ * @seeds: Receives the border cells
+ *
+ * Return: void
+ */
+static void nav_GatherSeeds(flowfield_t *field, const cellvec_t *visited,
+		cellvec_t *seeds)
+{
+	int i, k, nx, ny, n;
+	uint64_t *keys;
+
+	for (i = 0; i < visited->size; i++)
+	{
+		if (!(field->mark[visited->cells[i]] & NAV_ORPHAN))
+			continue;
+		for (k = 0; k < 4; k++)
+		{
+			nx = visited->cells[i] / field->width + navStep[k][0];
+			ny = visited->cells[i] % field->width + navStep[k][1];
+			n = nx * field->width + ny;
+			if (!nav_IsWalkable(field->maze, field->width, field->height,
+					nx, ny) || (field->mark[n] & (NAV_ORPHAN | NAV_SEEDED)) ||
+			    field->dist[n] == NAV_UNREACHABLE)
+				continue;
+			field->mark[n] |= NAV_SEEDED;
+			cellvec_Push(seeds, n);
+		}
+	}
+	keys = malloc(seeds->size * sizeof(uint64_t) + 1);
+	if (keys == NULL)
+		return;
+	for (i = 0; i < seeds->size; i++)
+		keys[i] = (uint64_t)field->dist[seeds->cells[i]] << 32 |
+			(uint32_t)seeds->cells[i];
+	qsort(keys, seeds->size, sizeof(uint64_t), compare_SeedKeys);
+	for (i = 0; i < seeds->size; i++)
+		seeds->cells[i] = (int)(keys[i] & 0xFFFFFFFF);
+	free(keys);
+}
+
+/**
+ * nav_CellChanged - Repairs a field after one maze cell was opened or
+ * closed, touching only the cells whose distance actually changes
+ * @field: Pointer to the field
+ * @x: Row of the cell, the maze must already hold its new value
+ * @y: Column of the cell
+ *
+ * Return: void
+ */
+void nav_CellChanged(flowfield_t *field, int x, int y)
+{
+	cellvec_t visited = {NULL, 0, 0}, seeds = {NULL, 0, 0};
+	int cell = x * field->width + y, i;
+	uint32_t previous;
+
+	if (x < 0 || x >= field->height || y < 0 || y >= field->width)
+		return;
+	previous = field->dist[cell];
+	if (!nav_IsWalkable(field->maze, field->width, field->height, x, y))
+	{
+		if (previous == NAV_UNREACHABLE)
+			return;
+		nav_CollectOrphans(field, cell, previous, &visited);
+		nav_GatherSeeds(field, &visited, &seeds);
+	}
+	else
+	{
+		field->dist[cell] = NAV_UNREACHABLE;
+		for (i = 0; i < field->goalCount; i++)
+			if (field->goals[i].x == x && field->goals[i].y == y)
+				field->dist[cell] = 0;
+		if (field->dist[cell] != 0 && nav_MinNeighbour(field, cell) !=
+		    NAV_UNREACHABLE)
+			field->dist[cell] = nav_MinNeighbour(field, cell) + 1;
+		cellvec_Push(&seeds, cell);
+	}
+	nav_Relax(field, &seeds);
+	for (i = 0; i < visited.size; i++)
+		field->mark[visited.cells[i]] = 0;
+	for (i = 0; i < seeds.size; i++)
+		field->mark[seeds.cells[i]] = 0;
+	free(visited.cells);
+	free(seeds.cells);
+}
@@ -0,0 +1,171 @@
+#include "../headers/navigation.h"
+
+/**
+ * nav_IsWalkable - Checks if a maze cell can be entered
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ * @x: Row of the cell
+ * @y: Column of the cell
+ *
+ * Return: true if the cell is inside the maze and empty, else false
+ */
+bool nav_IsWalkable(const int *maze, int width, int height, int x, int y)
+{
+	return (x >= 0 && x < height && y >= 0 && y < width &&
+		maze[x * width + y] == 0);
+}
+
+/**
+ * nav_CreateFlowField - Allocates and builds a distance field to goals
+ * @maze: Pointer to the maze array, kept by the field
+ * @width: Number of cells in a maze row
+ * @height: Number of rows in the maze
+ * @goals: Goal cells the field leads to
+ * @goalCount: Number of goal cells
+ *
+ * Return: Pointer to the new field, or NULL on failure
+ */
+flowfield_t *nav_CreateFlowField(const int *maze, int width, int height,
+		const SDL_Point *goals, int goalCount)
+{
+	flowfield_t *field;
+	size_t cells = (size_t)width * height;
+
+	if (maze == NULL || width <= 0 || height <= 0 || goalCount <= 0)
+		return (NULL);
+	field = calloc(1, sizeof(flowfield_t));
+	if (field == NULL)
+		return (NULL);
+	field->maze = maze;
+	field->width = width;
+	field->height = height;
+	field->goalCount = goalCount;
+	field->goals = malloc(goalCount * sizeof(SDL_Point));
+	field->dist = malloc(cells * sizeof(uint32_t));
+	field->mark = calloc(cells, sizeof(uint8_t));
+	if (field->goals == NULL || field->dist == NULL || field->mark == NULL)
+	{
+		nav_DestroyFlowField(field);
+		return (NULL);
+	}
+	memcpy(field->goals, goals, goalCount * sizeof(SDL_Point));
+	nav_BuildFlowField(field);
+	return (field);
+}
+
+/**
+ * nav_DestroyFlowField - Frees a distance field
+ * @field: Pointer to the field, may be NULL
+ *
+ * Return: void
+ */
+void nav_DestroyFlowField(flowfield_t *field)
+{
+	if (field == NULL)
+		return;
+	free(field->goals);
+	free(field->dist);
+	free(field->mark);
+	free(field);
+}
+
+/**
+ * nav_BuildFlowField - Recomputes every distance with a breadth first
+ * search seeded from all goals at once
+ * @field: Pointer to the field
+ *
+ * Return: void
+ */
+void nav_BuildFlowField(flowfield_t *field)
+{
+	static const int step[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	size_t cells = (size_t)field->width * field->height;
+	int *queue, head = 0, tail = 0, i, x, y, nx, ny, cell;
+
+	for (i = 0; i < (int)cells; i++)
+		field->dist[i] = NAV_UNREACHABLE;
+	queue = malloc(cells * sizeof(int));
+	if (queue == NULL)
+		return;
+	for (i = 0; i < field->goalCount; i++)
+	{
+		x = field->goals[i].x;
+		y = field->goals[i].y;
+		if (!nav_IsWalkable(field->maze, field->width, field->height, x, y))
+			continue;
+		cell = x * field->width + y;
+		if (field->dist[cell] != 0)
+			queue[tail++] = cell;
+		field->dist[cell] = 0;
+	}
+	while (head < tail)
+	{
+		cell = queue[head++];
+		for (i = 0; i < 4; i++)
+		{
+			nx = cell / field->width + step[i][0];
+			ny = cell % field->width + step[i][1];
+			if (!nav_IsWalkable(field->maze, field->width, field->height,
+					nx, ny) ||
+			    field->dist[nx * field->width + ny] != NAV_UNREACHABLE)
+				continue;
+			field->dist[nx * field->width + ny] = field->dist[cell] + 1;
+			queue[tail++] = nx * field->width + ny;
+		}
+	}
+	free(queue);
+}
+
+/**
+ * nav_QueryBatch - Looks up the flow direction for many agents at once
+ * @field: Pointer to the field
+ * @positions: Agent positions in maze coordinates
+ * @directions: Receives a unit vector towards the next cell of each agent,
+ * or (0, 0) when the agent stands on a goal or cannot reach one
+ * @count: Number of agents
+ *
+ * Return: Number of agents that have a route to a goal
+ */
+int nav_QueryBatch(const flowfield_t *field, const point_t *positions,
+		point_t *directions, int count)
+{
+	static const int step[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+	int i, k, x, y, best, routed = 0;
+	uint32_t bestDist, d;
+	double length;
+
+	for (i = 0; i < count; i++)
+	{
+		x = (int)positions[i].x;
+		y = (int)positions[i].y;
+		directions[i].x = 0;
+		directions[i].y = 0;
+		if (!nav_IsWalkable(field->maze, field->width, field->height, x, y) ||
+		    field->dist[x * field->width + y] == NAV_UNREACHABLE)
+			continue;
+		routed++;
+		bestDist = field->dist[x * field->width + y];
+		for (k = 0, best = -1; k < 4; k++)
+		{
+			if (!nav_IsWalkable(field->maze, field->width, field->height,
+					x + step[k][0], y + step[k][1]))
+				continue;
+			d = field->dist[(x + step[k][0]) * field->width + y + step[k][1]];
+			if (d < bestDist)
+			{
+				bestDist = d;
+				best = k;
+			}
+		}
+		if (best < 0)
+			continue;
+		directions[i].x = x + step[best][0] + 0.5 - positions[i].x;
+		directions[i].y = y + step[best][1] + 0.5 - positions[i].y;
+		length = sqrt(directions[i].x * directions[i].x +
+			directions[i].y * directions[i].y);
+		directions[i].x /= length;
+		directions[i].y /= length;
+	}
+	return (routed);
+}
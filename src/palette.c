@@ -0,0 +1,211 @@
+#include "../headers/palette.h"
+
+/**
+ * struct colorbox_s - range of colours handled as one by the median cut
+ * @start: index of the first colour of the box
+ * @count: number of colours in the box
+ * @shift: bit offset of the channel with the widest spread
+ * @range: spread of that channel, -1 when the box cannot be split
+ */
+typedef struct colorbox_s
+{
+	size_t start;
+	size_t count;
+	int shift;
+	int range;
+} colorbox_t;
+
+/**
+ * box_Measure - Finds the channel a box of colours spreads the most along
+ * @colors: Colour array the box indexes
+ * @box: Pointer to the box, its shift and range are updated
+ *
+ * Return: void
+ */
+static void box_Measure(const uint32_t *colors, colorbox_t *box)
+{
+	int shift, lo, hi, v;
+	size_t i;
+
+	box->range = -1;
+	box->shift = 0;
+	if (box->count < 2)
+		return;
+	for (shift = 0; shift < 24; shift += 8)
+	{
+		lo = 255;
+		hi = 0;
+		for (i = box->start; i < box->start + box->count; i++)
+		{
+			v = (colors[i] >> shift) & 0xFF;
+			lo = v < lo ? v : lo;
+			hi = v > hi ? v : hi;
+		}
+		if (hi - lo > box->range)
+		{
+			box->range = hi - lo;
+			box->shift = shift;
+		}
+	}
+	if (box->range == 0)
+		box->range = -1;
+}
+
+/**
+ * compare_Colors - qsort comparator for colour words
+ * @a: Pointer to the first word
+ * @b: Pointer to the second word
+ *
+ * Return: Negative, zero or positive like strcmp
+ */
+static int compare_Colors(const void *a, const void *b)
+{
+	uint32_t ka = *(const uint32_t *)a, kb = *(const uint32_t *)b;
+
+	return ((ka > kb) - (ka < kb));
+}
+
+/**
+ * box_Split - Sorts a box along its widest channel and cuts it at the
+ * median
+ * @colors: Colour array the box indexes
+ * @box: Pointer to the box, keeps the lower half
+ * @upper: Receives the upper half
+ *
+ * Return: void
+ */
+static void box_Split(uint32_t *colors, colorbox_t *box, colorbox_t *upper)
+{
+	size_t i;
+
+	for (i = box->start; i < box->start + box->count; i++)
+		colors[i] |= ((colors[i] >> box->shift) & 0xFF) << 24;
+	qsort(colors + box->start, box->count, sizeof(uint32_t), compare_Colors);
+	for (i = box->start; i < box->start + box->count; i++)
+		colors[i] &= 0xFFFFFF;
+	upper->start = box->start + box->count / 2;
+	upper->count = box->count - box->count / 2;
+	box->count /= 2;
+	box_Measure(colors, box);
+	box_Measure(colors, upper);
+}
+
+/**
+ * palette_Quantise - Picks the colours of a palette with a median cut
+ * @colors: xRGB colours to represent, typically every texel
+ * @count: Number of colours
+ * @palette: Receives the palette; entry 0 is black, unused entries too
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool palette_Quantise(const uint32_t *colors, size_t count,
+		uint32_t palette[PALETTE_SIZE])
+{
+	colorbox_t boxes[PALETTE_SIZE - 1];
+	uint32_t *work = malloc(count * sizeof(uint32_t) + 1), sum[3];
+	int boxCount = 1, i, widest, c;
+	size_t j;
+
+	if (work == NULL)
+		return (false);
+	for (j = 0; j < count; j++)
+		work[j] = colors[j] & 0xFFFFFF;
+	boxes[0].start = 0;
+	boxes[0].count = count;
+	box_Measure(work, &boxes[0]);
+	while (boxCount < PALETTE_SIZE - 1)
+	{
+		for (i = 0, widest = 0; i < boxCount; i++)
+			if (boxes[i].range > boxes[widest].range)
+				widest = i;
+		if (boxes[widest].range < 0)
+			break;
+		box_Split(work, &boxes[widest], &boxes[boxCount++]);
+	}
+	memset(palette, 0, PALETTE_SIZE * sizeof(uint32_t));
+	for (i = 0; i < boxCount && count > 0; i++)
+	{
+		sum[0] = sum[1] = sum[2] = 0;
+		for (j = boxes[i].start; j < boxes[i].start + boxes[i].count; j++)
+			for (c = 0; c < 3; c++)
+				sum[c] += (work[j] >> (c * 8)) & 0xFF;
+		for (c = 0; c < 3; c++)
+			palette[i + 1] |= (sum[c] / boxes[i].count) << (c * 8);
+	}
+	free(work);
+	return (true);
+}
+
+/**
+ * palette_Nearest - Finds the palette entry closest to a colour
+ * @palette: The palette
+ * @color: xRGB colour to look up
+ *
+ * Return: Index of the entry with the smallest squared RGB distance
+ */
+uint8_t palette_Nearest(const uint32_t palette[PALETTE_SIZE], uint32_t color)
+{
+	int i, best = 0, dr, dg, db;
+	uint32_t distance, bestDistance = UINT32_MAX;
+
+	for (i = 0; i < PALETTE_SIZE; i++)
+	{
+		dr = (int)((palette[i] >> 16) & 0xFF) - (int)((color >> 16) & 0xFF);
+		dg = (int)((palette[i] >> 8) & 0xFF) - (int)((color >> 8) & 0xFF);
+		db = (int)(palette[i] & 0xFF) - (int)(color & 0xFF);
+		distance = dr * dr + dg * dg + db * db;
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			best = i;
+		}
+	}
+	return ((uint8_t)best);
+}
+
+/**
+ * palette_BuildColormap - Fills the shade rows of a palette: row l maps
+ * each entry to the entry closest to it darkened by l / SHADE_LEVELS, so
+ * shading a pixel is a single table lookup
+ * @palette: The palette
+ * @colormap: Receives the rows, row 0 is the identity
+ *
+ * Return: void
+ */
+void palette_BuildColormap(const uint32_t palette[PALETTE_SIZE],
+		uint8_t colormap[SHADE_LEVELS][PALETTE_SIZE])
+{
+	int level, i, c;
+	uint32_t shaded, scale;
+
+	for (i = 0; i < PALETTE_SIZE; i++)
+		colormap[0][i] = (uint8_t)i;
+	for (level = 1; level < SHADE_LEVELS; level++)
+	{
+		scale = SHADE_LEVELS - level;
+		for (i = 0; i < PALETTE_SIZE; i++)
+		{
+			for (c = 0, shaded = 0; c < 24; c += 8)
+				shaded |= (((palette[i] >> c) & 0xFF) * scale / SHADE_LEVELS) << c;
+			colormap[level][i] = palette_Nearest(palette, shaded);
+		}
+	}
+}
+
+/**
+ * palette_Expand - Converts palette indices to xRGB pixels
+ * @palette: The palette
+ * @indices: Indices to convert
+ * @pixels: Receives the pixels
+ * @count: Number of pixels
+ *
+ * Return: void
+ */
+void palette_Expand(const uint32_t palette[PALETTE_SIZE],
+		const uint8_t *indices, uint32_t *pixels, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		pixels[i] = palette[indices[i]];
+}
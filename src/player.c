@@ -1,4 +1,6 @@
 #include "../headers/player.h"
+#include "../headers/replay.h"
+#include "../headers/control.h"
 
 /**
  * movePlayer - handling player movement based on keyboard input
@@ -7,19 +9,25 @@
  * @directionX: X direction of movement
  * @directionY: Y direction of movement
  * @modifier: Movement speed modifier
+ *
+ * Return: true if the player moved or stood still, false if a wall or the
+ * edge of the map stopped it
  */
-void movePlayer(GameState *state, int *maze, double directionX,
+bool movePlayer(GameState *state, int *maze, double directionX,
 		double directionY, double modifier)
 {
 	int newSpotX = (int)(state->position.x + directionX * modifier);
 	int newSpotY = (int)(state->position.y + directionY * modifier);
 
-	if (newSpotX >= 0 && newSpotX < MAP_WIDTH && newSpotY >= 0 &&
-	    newSpotY < MAP_HEIGHT && !maze[newSpotX * MAP_WIDTH + newSpotY])
+	if (newSpotX >= 0 && newSpotX < state->mapHeight && newSpotY >= 0 &&
+	    newSpotY < state->mapWidth &&
+	    !maze[newSpotX * state->mapWidth + newSpotY])
 	{
 		state->position.x += directionX * modifier;
 		state->position.y += directionY * modifier;
+		return (true);
 	}
+	return (false);
 }
 
 /**
@@ -45,45 +53,108 @@ void rotatePlayer(GameState *state, double modifier, int direction)
 }
 
 /**
- * handlePlayerMovement - Handles player movement and rotation based on input
+ * readPlayerInput - Samples the movement keys from the keyboard
+ *
+ * Return: INPUT_* bits of the keys held down
+ */
+uint8_t readPlayerInput(void)
+{
+	const uint8_t *keyboardState = SDL_GetKeyboardState(NULL);
+	uint8_t input = 0;
+
+	if (keyboardState[SDL_SCANCODE_W])
+		input |= INPUT_FORWARD;
+	if (keyboardState[SDL_SCANCODE_S])
+		input |= INPUT_BACKWARD;
+	if (keyboardState[SDL_SCANCODE_E])
+		input |= INPUT_STRAFE;
+	if (keyboardState[SDL_SCANCODE_D])
+		input |= INPUT_TURN_RIGHT;
+	if (keyboardState[SDL_SCANCODE_A])
+		input |= INPUT_TURN_LEFT;
+	return (input);
+}
+
+/**
+ * applyPlayerInput - Moves and rotates the player for one frame
  * @state: Pointer to the GameState structure containing state state
+ * @input: INPUT_* bits of the keys held during the frame
+ * @seconds: Duration of the frame
+ *
+ * Return: true if every move was made, false if a wall stopped one
  */
-void handlePlayerMovement(GameState *state)
+bool applyPlayerInput(GameState *state, uint8_t input, double seconds)
 {
-	const uint8_t *keyboardState;
-	double previousTime;
-	double currentTime;
-	double moveModifier;
-	double rotModifier;
+	double moveModifier = seconds * 5.0;
+	double rotModifier = seconds * 3.0;
 	int *maze = state->maze;
+	bool moved = true;
 
-	keyboardState = SDL_GetKeyboardState(NULL);
-	previousTime = state->time;
-	state->time = SDL_GetTicks();
-	currentTime = (state->time - previousTime) / 1000.0;
-	moveModifier = currentTime * 5.0;
-	rotModifier = currentTime * 3.0;
-	if (keyboardState[SDL_SCANCODE_W])
+	if (input & INPUT_FORWARD)
 	{
-		movePlayer(state, maze, state->direction.x,
+		moved &= movePlayer(state, maze, state->direction.x,
 			   state->direction.y, moveModifier);
 	}
-	if (keyboardState[SDL_SCANCODE_S])
+	if (input & INPUT_BACKWARD)
 	{
-		movePlayer(state, maze, -state->direction.x,
+		moved &= movePlayer(state, maze, -state->direction.x,
 			   -state->direction.y, moveModifier);
 	}
-	if (keyboardState[SDL_SCANCODE_E])
+	if (input & INPUT_STRAFE)
 	{
-		movePlayer(state, maze, state->viewPlane.x,
+		moved &= movePlayer(state, maze, state->viewPlane.x,
 			   state->viewPlane.y, moveModifier);
 	}
-	if (keyboardState[SDL_SCANCODE_D])
+	if (input & INPUT_TURN_RIGHT)
 	{
 		rotatePlayer(state, rotModifier, 1);
 	}
-	if (keyboardState[SDL_SCANCODE_A])
+	if (input & INPUT_TURN_LEFT)
 	{
 		rotatePlayer(state, rotModifier, -1);
 	}
+	return (moved);
+}
+
+/**
+ * handlePlayerMovement - Handles player movement and rotation based on input
+ * from the keyboard and wall clock, from the replay being played back, or
+ * from the steps of a control socket client; a replay being recorded logs
+ * every frame
+ * @state: Pointer to the GameState structure containing state state
+ */
+void handlePlayerMovement(GameState *state)
+{
+	double previousTime = state->time;
+	uint16_t elapsed;
+	uint8_t input;
+	bool moved;
+
+	if (state->replay && state->replay->mode == REPLAY_PLAY)
+	{
+		if (!replay_Next(state->replay, &input, &elapsed))
+		{
+			state->quit = 1;
+			return;
+		}
+		state->time += elapsed;
+	}
+	else if (state->control)
+	{
+		if (!control_Next(state->control, state, &input, &elapsed))
+			return;
+		state->time += elapsed;
+	}
+	else
+	{
+		input = readPlayerInput();
+		state->time = SDL_GetTicks();
+		elapsed = state->time - previousTime > UINT16_MAX ? UINT16_MAX :
+			state->time - previousTime;
+		if (state->replay)
+			replay_Record(state->replay, input, elapsed);
+	}
+	moved = applyPlayerInput(state, input, elapsed / 1000.0);
+	if (state->control)
+		state->control->blocked = !moved;
 }
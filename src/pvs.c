@@ -0,0 +1,197 @@
+#include "../headers/pvs.h"
+
+/**
+ * pvs_Farther - Picks the coordinate farther along a step direction
+ * @a: First coordinate
+ * @b: Second coordinate
+ * @step: Step direction, 1 or -1
+ *
+ * Return: The farther coordinate
+ */
+static int pvs_Farther(int a, int b, int step)
+{
+	return ((b - a) * step > 0 ? b : a);
+}
+
+/**
+ * pvs_Size - Gives the size of the visibility data of a map
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ *
+ * Return: Size in bytes
+ */
+size_t pvs_Size(int width, int height)
+{
+	size_t blocks = (size_t)((width + (1 << PVS_BLOCK_SHIFT) - 1) >>
+		PVS_BLOCK_SHIFT);
+
+	return (blocks * ((height + (1 << PVS_BLOCK_SHIFT) - 1) >>
+		PVS_BLOCK_SHIFT) * PVS_QUADRANTS);
+}
+
+/**
+ * pvs_Index - Finds the bound of a cell in the visibility data
+ * @width: Number of cells in a row
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @quadrant: Ray quadrant, see pvs_BuildQuadrant
+ *
+ * Return: Index of the byte holding the bound of the cell's block
+ */
+size_t pvs_Index(int width, int x, int y, int quadrant)
+{
+	size_t blocks = (size_t)((width + (1 << PVS_BLOCK_SHIFT) - 1) >>
+		PVS_BLOCK_SHIFT);
+
+	return (((x >> PVS_BLOCK_SHIFT) * blocks + (y >> PVS_BLOCK_SHIFT)) *
+		PVS_QUADRANTS + quadrant);
+}
+
+/**
+ * pvs_Encode - Rounds a step bound up to the byte that stores it
+ * @steps: Number of DDA steps
+ *
+ * Return: The byte, PVS_UNBOUNDED if the bound is too large
+ */
+uint8_t pvs_Encode(long steps)
+{
+	long code = steps;
+
+	if (steps >= PVS_EXACT)
+		code = PVS_EXACT - 1 + ((steps + (1 << PVS_COARSE_SHIFT) - 1) >>
+			PVS_COARSE_SHIFT);
+	return (code < PVS_UNBOUNDED ? code : PVS_UNBOUNDED);
+}
+
+/**
+ * pvs_Bound - Gives the DDA step bound of rays leaving a cell
+ * @pvs: Visibility data of the map
+ * @width: Number of cells in a row
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @quadrant: Ray quadrant, see pvs_BuildQuadrant
+ *
+ * Return: Number of steps, or -1 when the rays are unbounded
+ */
+int pvs_Bound(const uint8_t *pvs, int width, int x, int y, int quadrant)
+{
+	int code = pvs[pvs_Index(width, x, y, quadrant)];
+
+	if (code == PVS_UNBOUNDED)
+		return (-1);
+	if (code < PVS_EXACT)
+		return (code);
+	return ((code - (PVS_EXACT - 1)) << PVS_COARSE_SHIFT);
+}
+
+/**
+ * pvs_BuildQuadrant - Computes the DDA step bound of one ray quadrant for
+ * every cell. The farthest corner of the staircase region of a cell is
+ * the farthest of its own and those of its two neighbours in the
+ * quadrant, so cells are swept from the far side with one row of corners
+ * kept. Cells off the map count as walls one step outside it. Each block
+ * keeps the largest bound of its cells.
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @quadrant: Bit 0 set for rays stepping +x, bit 1 for rays stepping +y
+ * @pvs: Visibility data of pvs_Size bytes, zeroed before the first quadrant
+ *
+ * Return: true on success, false if memory ran out
+ */
+bool pvs_BuildQuadrant(const int *maze, int width, int height,
+		int quadrant, uint8_t *pvs)
+{
+	int sx = quadrant & 1 ? 1 : -1, sy = quadrant & 2 ? 1 : -1;
+	int x, y, i, ex, ey, *far, *rowX, *rowY, *prevX, *prevY;
+	uint8_t code, *block;
+
+	far = malloc(width * 4 * sizeof(int));
+	if (far == NULL)
+		return (false);
+	rowX = far;
+	rowY = far + width;
+	prevX = far + 2 * width;
+	prevY = far + 3 * width;
+	for (y = 0; y < width; y++)
+	{
+		prevX[y] = sx > 0 ? height : -1;
+		prevY[y] = y;
+	}
+	for (i = 0, x = sx > 0 ? height - 1 : 0; i < height; i++, x -= sx)
+	{
+		for (y = sy > 0 ? width - 1 : 0; y >= 0 && y < width; y -= sy)
+		{
+			ex = pvs_Farther(x, prevX[y], sx);
+			ey = pvs_Farther(y, prevY[y], sy);
+			if (y + sy >= 0 && y + sy < width)
+			{
+				ex = pvs_Farther(ex, rowX[y + sy], sx);
+				ey = pvs_Farther(ey, rowY[y + sy], sy);
+			}
+			else
+				ey = pvs_Farther(ey, y + sy, sy);
+			rowX[y] = maze[x * width + y] ? x : ex;
+			rowY[y] = maze[x * width + y] ? y : ey;
+			if (maze[x * width + y])
+				code = 0;
+			else if (ex < 0 || ex >= height || ey < 0 || ey >= width)
+				code = PVS_UNBOUNDED;
+			else
+				code = pvs_Encode((long)(ex - x) * sx + (long)(ey - y) * sy);
+			block = pvs + pvs_Index(width, x, y, quadrant);
+			*block = code > *block ? code : *block;
+		}
+		memcpy(prevX, rowX, width * 2 * sizeof(int));
+	}
+	free(far);
+	return (true);
+}
+
+/**
+ * pvs_Build - Computes the visibility data of a whole map
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ *
+ * Return: Pointer to the data of pvs_Size bytes, or NULL on failure
+ */
+uint8_t *pvs_Build(const int *maze, int width, int height)
+{
+	uint8_t *pvs;
+	int quadrant;
+
+	pvs = calloc(pvs_Size(width, height), sizeof(uint8_t));
+	if (pvs == NULL)
+		return (NULL);
+	for (quadrant = 0; quadrant < PVS_QUADRANTS; quadrant++)
+	{
+		if (!pvs_BuildQuadrant(maze, width, height, quadrant, pvs))
+		{
+			free(pvs);
+			return (NULL);
+		}
+	}
+	return (pvs);
+}
+
+/**
+ * pvs_HashMap - Hashes a map so stale visibility files can be detected
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ *
+ * Return: FNV-1a hash of the cells
+ */
+uint32_t pvs_HashMap(const int *maze, int width, int height)
+{
+	uint32_t hash = 2166136261u;
+	size_t i, cells = (size_t)width * height;
+
+	for (i = 0; i < cells; i++)
+	{
+		hash ^= (uint32_t)maze[i];
+		hash *= 16777619u;
+	}
+	return (hash);
+}
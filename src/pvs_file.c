@@ -0,0 +1,110 @@
+#include "../headers/pvs.h"
+
+/**
+ * pvs_ReadFile - Loads visibility data stored next to a map
+ * @path: Path of the visibility file
+ * @header: Header the file must match
+ *
+ * Return: Pointer to the data, or NULL if the file is missing or stale
+ */
+static uint8_t *pvs_ReadFile(const char *path, const pvsheader_t *header)
+{
+	size_t count = pvs_Size(header->width, header->height);
+	pvsheader_t stored;
+	uint8_t *pvs = NULL;
+	FILE *file = fopen(path, "rb");
+
+	if (file == NULL)
+		return (NULL);
+	if (fread(&stored, sizeof(stored), 1, file) == 1 &&
+	    memcmp(&stored, header, sizeof(stored)) == 0)
+	{
+		pvs = malloc(count * sizeof(uint8_t));
+		if (pvs != NULL && fread(pvs, sizeof(uint8_t), count, file) != count)
+		{
+			free(pvs);
+			pvs = NULL;
+		}
+	}
+	fclose(file);
+	return (pvs);
+}
+
+/**
+ * pvs_WriteFile - Stores visibility data next to a map
+ * @path: Path of the visibility file
+ * @header: Header describing the map
+ * @pvs: The data
+ *
+ * Return: true on success, else false
+ */
+static bool pvs_WriteFile(const char *path, const pvsheader_t *header,
+		const uint8_t *pvs)
+{
+	size_t count = pvs_Size(header->width, header->height);
+	FILE *file = fopen(path, "wb");
+	bool done;
+
+	if (file == NULL)
+		return (false);
+	done = fwrite(header, sizeof(*header), 1, file) == 1 &&
+		fwrite(pvs, sizeof(uint8_t), count, file) == count;
+	if (fclose(file) != 0 || !done)
+	{
+		remove(path);
+		return (false);
+	}
+	return (true);
+}
+
+/**
+ * pvs_Load - Loads the visibility data of a map from "<map>.pvs",
+ * computing and storing it there when the file is missing or was made
+ * for a different map
+ * @maze: Pointer to the maze array
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @mapFilename: Path the map was read from
+ *
+ * Return: Pointer to the visibility data, or NULL on failure
+ */
+uint8_t *pvs_Load(const int *maze, int width, int height,
+		const char *mapFilename)
+{
+	pvsheader_t header;
+	char *path = malloc(strlen(mapFilename) + 5);
+	uint8_t *pvs;
+
+	if (path == NULL)
+		return (NULL);
+	sprintf(path, "%s.pvs", mapFilename);
+	header.magic = PVS_MAGIC;
+	header.width = width;
+	header.height = height;
+	header.mapHash = pvs_HashMap(maze, width, height);
+	pvs = pvs_ReadFile(path, &header);
+	if (pvs == NULL)
+	{
+		pvs = pvs_Build(maze, width, height);
+		if (pvs != NULL && !pvs_WriteFile(path, &header, pvs))
+			fprintf(stderr, "Warning: Unable to write %s\n", path);
+	}
+	free(path);
+	return (pvs);
+}
+
+/**
+ * loadMapVisibility - Loads the visibility data of the current map, see
+ * pvs_Load
+ * @state: Pointer to the GameState holding the map
+ * @mapFilename: Path the map was read from
+ *
+ * Return: true if state->pvs is set, false on failure
+ */
+bool loadMapVisibility(GameState *state, const char *mapFilename)
+{
+	free(state->pvs);
+	state->pvs = pvs_Load(state->maze, state->mapWidth, state->mapHeight,
+		mapFilename);
+	return (state->pvs != NULL);
+}
@@ -0,0 +1,266 @@
+#include "../headers/pvs.h"
+
+/*
+ * The bound of a cell comes from the far corner (ex, ey) of its staircase
+ * region: ex is the farthest of its own row and the ex of its two
+ * neighbours in the quadrant, and the same holds for ey. pvsedit_t keeps
+ * each corner as reach offsets from the cell, so after an edit the corners
+ * can be recomputed one anti-diagonal at a time, walking away from the
+ * edited cell against the quadrant and stopping where nothing changes.
+ * The bound of each block whose corners changed is then taken again from
+ * all of its cells.
+ */
+
+/**
+ * pvs_Corner - Gives the far corner of a cell's staircase region. Cells
+ * off the map act as walls, whose corner is the cell itself.
+ * @edit: Pointer to the update context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @quadrant: Ray quadrant, see pvs_BuildQuadrant
+ * @corner: Receives the corner
+ *
+ * Return: void
+ */
+static void pvs_Corner(const pvsedit_t *edit, int x, int y, int quadrant,
+		SDL_Point *corner)
+{
+	const uint16_t *reach;
+
+	corner->x = x;
+	corner->y = y;
+	if (x < 0 || x >= edit->height || y < 0 || y >= edit->width)
+		return;
+	reach = edit->reach + (((size_t)x * edit->width + y) * PVS_QUADRANTS +
+		quadrant) * 2;
+	corner->x += quadrant & 1 ? reach[0] : -reach[0];
+	corner->y += quadrant & 2 ? reach[1] : -reach[1];
+}
+
+/**
+ * pvs_Recompute - Recomputes the corner of one cell from its two
+ * neighbours in a quadrant
+ * @edit: Pointer to the update context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @quadrant: Ray quadrant
+ *
+ * Return: true if the corner changed, else false
+ */
+static bool pvs_Recompute(pvsedit_t *edit, int x, int y, int quadrant)
+{
+	int sx = quadrant & 1 ? 1 : -1, sy = quadrant & 2 ? 1 : -1;
+	size_t cell = (size_t)x * edit->width + y;
+	uint16_t *reach = edit->reach + (cell * PVS_QUADRANTS + quadrant) * 2;
+	SDL_Point a, b, far = {x, y};
+	int rx, ry;
+
+	if (!edit->maze[cell])
+	{
+		pvs_Corner(edit, x + sx, y, quadrant, &a);
+		pvs_Corner(edit, x, y + sy, quadrant, &b);
+		far.x = (a.x - far.x) * sx > 0 ? a.x : far.x;
+		far.x = (b.x - far.x) * sx > 0 ? b.x : far.x;
+		far.y = (a.y - far.y) * sy > 0 ? a.y : far.y;
+		far.y = (b.y - far.y) * sy > 0 ? b.y : far.y;
+	}
+	rx = (far.x - x) * sx;
+	ry = (far.y - y) * sy;
+	if (reach[0] == rx && reach[1] == ry)
+		return (false);
+	reach[0] = rx;
+	reach[1] = ry;
+	return (true);
+}
+
+/**
+ * pvs_UpdateBlock - Takes the bound of the block holding a cell again
+ * from the corners of all its cells, as pvs_BuildQuadrant does
+ * @edit: Pointer to the update context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @quadrant: Ray quadrant
+ *
+ * Return: void
+ */
+static void pvs_UpdateBlock(pvsedit_t *edit, int x, int y, int quadrant)
+{
+	int sx = quadrant & 1 ? 1 : -1, sy = quadrant & 2 ? 1 : -1;
+	int top = x >> PVS_BLOCK_SHIFT << PVS_BLOCK_SHIFT, cx, cy;
+	int left = y >> PVS_BLOCK_SHIFT << PVS_BLOCK_SHIFT;
+	uint8_t code, bound = 0;
+	SDL_Point far;
+
+	for (cx = top; cx < top + (1 << PVS_BLOCK_SHIFT) && cx < edit->height;
+	     cx++)
+		for (cy = left; cy < left + (1 << PVS_BLOCK_SHIFT) &&
+		     cy < edit->width; cy++)
+		{
+			pvs_Corner(edit, cx, cy, quadrant, &far);
+			if (edit->maze[cx * edit->width + cy])
+				code = 0;
+			else if (far.x < 0 || far.x >= edit->height || far.y < 0 ||
+				 far.y >= edit->width)
+				code = PVS_UNBOUNDED;
+			else
+				code = pvs_Encode((long)(far.x - cx) * sx +
+					(long)(far.y - cy) * sy);
+			bound = code > bound ? code : bound;
+		}
+	edit->pvs[pvs_Index(edit->width, x, y, quadrant)] = bound;
+}
+
+/**
+ * pvs_Queue - Adds a cell to the next wavefront unless it is already there
+ * @edit: Pointer to the update context
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @size: Pointer to the size of the next wavefront
+ *
+ * Return: true on success, false if memory ran out
+ */
+static bool pvs_Queue(pvsedit_t *edit, int x, int y, int *size)
+{
+	int cell = x * edit->width + y, *grown, i;
+
+	if (x < 0 || x >= edit->height || y < 0 || y >= edit->width ||
+	    edit->stamp[cell] == edit->generation)
+		return (true);
+	if (*size == edit->capacity)
+	{
+		edit->capacity = edit->capacity ? edit->capacity * 2 : 256;
+		for (i = 0; i < 2; i++)
+		{
+			grown = realloc(edit->cells[i], edit->capacity * sizeof(int));
+			if (grown == NULL)
+				return (false);
+			edit->cells[i] = grown;
+		}
+	}
+	edit->stamp[cell] = edit->generation;
+	edit->cells[1][(*size)++] = cell;
+	return (true);
+}
+
+/**
+ * pvs_NextGeneration - Starts a new wavefront tag, clearing the stamps
+ * when the tag wraps around
+ * @edit: Pointer to the update context
+ *
+ * Return: void
+ */
+static void pvs_NextGeneration(pvsedit_t *edit)
+{
+	if (++edit->generation == 0)
+	{
+		memset(edit->stamp, 0, (size_t)edit->width * edit->height *
+			sizeof(uint32_t));
+		edit->generation = 1;
+	}
+}
+
+/**
+ * pvs_CellChanged - Updates the visibility data after one maze cell was
+ * opened or closed, recomputing only the cells whose region can reach it
+ * and stopping where their corners stay the same
+ * @edit: Pointer to the update context
+ * @x: Row of the cell, the maze must already hold its new value
+ * @y: Column of the cell
+ *
+ * Return: true on success, false if memory ran out and the data is stale
+ */
+bool pvs_CellChanged(pvsedit_t *edit, int x, int y)
+{
+	int quadrant, size, next, i, cx, cy, *swap;
+
+	if (x < 0 || x >= edit->height || y < 0 || y >= edit->width)
+		return (true);
+	for (quadrant = 0; quadrant < PVS_QUADRANTS; quadrant++)
+	{
+		pvs_NextGeneration(edit);
+		size = 0;
+		if (!pvs_Queue(edit, x, y, &size))
+			return (false);
+		while (size > 0)
+		{
+			swap = edit->cells[0];
+			edit->cells[0] = edit->cells[1];
+			edit->cells[1] = swap;
+			pvs_NextGeneration(edit);
+			for (i = 0, next = 0; i < size; i++)
+			{
+				cx = edit->cells[0][i] / edit->width;
+				cy = edit->cells[0][i] % edit->width;
+				if (!pvs_Recompute(edit, cx, cy, quadrant))
+					continue;
+				pvs_UpdateBlock(edit, cx, cy, quadrant);
+				if (!pvs_Queue(edit, cx - (quadrant & 1 ? 1 : -1), cy, &next) ||
+				    !pvs_Queue(edit, cx, cy - (quadrant & 2 ? 1 : -1), &next))
+					return (false);
+			}
+			size = next;
+		}
+	}
+	return (true);
+}
+
+/**
+ * pvs_CreateEdit - Prepares visibility data for incremental updates,
+ * recomputing the corner of every cell in dependency order
+ * @maze: Pointer to the maze array, kept by the context
+ * @width: Number of cells in a row
+ * @height: Number of rows
+ * @pvs: Visibility data of the maze, kept up to date by pvs_CellChanged
+ *
+ * Return: Pointer to the context, or NULL on failure
+ */
+pvsedit_t *pvs_CreateEdit(const int *maze, int width, int height,
+		uint8_t *pvs)
+{
+	pvsedit_t *edit;
+	size_t cells = (size_t)width * height;
+	int quadrant, i, x, y;
+
+	if (maze == NULL || pvs == NULL || width <= 0 || height <= 0)
+		return (NULL);
+	edit = calloc(1, sizeof(pvsedit_t));
+	if (edit == NULL)
+		return (NULL);
+	edit->maze = maze;
+	edit->width = width;
+	edit->height = height;
+	edit->pvs = pvs;
+	edit->reach = calloc(cells * PVS_QUADRANTS * 2, sizeof(uint16_t));
+	edit->stamp = calloc(cells, sizeof(uint32_t));
+	if (edit->reach == NULL || edit->stamp == NULL)
+	{
+		pvs_DestroyEdit(edit);
+		return (NULL);
+	}
+	for (quadrant = 0; quadrant < PVS_QUADRANTS; quadrant++)
+		for (i = 0; i < height; i++)
+		{
+			x = quadrant & 1 ? height - 1 - i : i;
+			for (y = quadrant & 2 ? width - 1 : 0; y >= 0 && y < width;
+			     y += quadrant & 2 ? -1 : 1)
+				pvs_Recompute(edit, x, y, quadrant);
+		}
+	return (edit);
+}
+
+/**
+ * pvs_DestroyEdit - Frees an update context, the visibility data stays
+ * @edit: Pointer to the context, may be NULL
+ *
+ * Return: void
+ */
+void pvs_DestroyEdit(pvsedit_t *edit)
+{
+	if (edit == NULL)
+		return;
+	free(edit->reach);
+	free(edit->stamp);
+	free(edit->cells[0]);
+	free(edit->cells[1]);
+	free(edit);
+}
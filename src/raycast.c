@@ -12,47 +12,48 @@
  * @side: determines whether wall is N/S or E/W
  * Return: Always void
  */
-void drawTexturedWallStrips(GameState *state, SDL_Point map, point_t rayPos,
-	point_t rayDir, double distToWall, int x, int side)
+void drawTexturedWallStrips(GameState *state, SDL_Point map, vec_t rayPos,
+	vec_t rayDir, real_t distToWall, int x, int side)
 {
-	int sliceHeight, drawStart, drawEnd, tileIndex, y;
-	double wallX;
+	int sliceHeight, drawStart, drawEnd, tileIndex, y, face, level;
+	real_t wallX;
 	SDL_Point tex;
-	uint32_t color;
+	const pixel_t *texels;
 	int *maze = state->maze;
 
-	sliceHeight = (int)(SCREEN_HEIGHT / distToWall);
+	sliceHeight = real_Floor(REAL_DIV(REAL_FROM_INT(SCREEN_HEIGHT),
+		distToWall));
 	drawStart = -sliceHeight / 2 + SCREEN_HEIGHT / 2;
 	if (drawStart < 0)
 		drawStart = 0;
 	drawEnd = sliceHeight / 2 + SCREEN_HEIGHT / 2;
 	if (drawEnd >= SCREEN_HEIGHT)
 		drawEnd = SCREEN_HEIGHT - 1;
-	wallX = side == 0 ? rayPos.y + distToWall * rayDir.y
-		: rayPos.x + distToWall * rayDir.x;
-	if (map.x < 0 || map.x >= MAP_WIDTH || map.y < 0 ||
-		map.y >= MAP_HEIGHT)
+	wallX = side == 0 ? rayPos.y + REAL_MUL(distToWall, rayDir.y)
+		: rayPos.x + REAL_MUL(distToWall, rayDir.x);
+	if (map.x < 0 || map.x >= state->mapHeight || map.y < 0 ||
+		map.y >= state->mapWidth)
 		return;
-	tileIndex = *((int *)maze + map.x * MAP_WIDTH + map.y) - 1;
-	wallX -= floor(wallX);
-	tex.x = (int)(wallX * (double)TEXTURE_WIDTH);
+	tileIndex = *((int *)maze + map.x * state->mapWidth + map.y) - 1;
+	wallX = REAL_FRAC(wallX);
+	face = side * 2 + (side == 0 ? rayDir.x >= 0 : rayDir.y >= 0);
+	level = lighting_WallLevel(state->lighting, map, face, wallX, distToWall);
+	tex.x = real_Floor(wallX * TEXTURE_WIDTH);
 	if (tex.x < 0 || tex.x >= TEXTURE_WIDTH)
 		return;
 	if ((side == 0 && rayDir.x > 0) || (side == 1 && rayDir.y < 0))
 		tex.x = TEXTURE_WIDTH - tex.x - 1;
+	texels = state->shades[level][tileIndex][tex.x];
 	for (y = drawStart; y < drawEnd; y++)
 	{
 		tex.y = ((((y << 1) - SCREEN_HEIGHT + sliceHeight)
 			<< (int)log2(TEXTURE_HEIGHT)) / sliceHeight) >> 1;
 		if (tex.y < 0 || tex.y >= TEXTURE_HEIGHT)
 			continue;
-		color = state->tiles[tileIndex][tex.x][tex.y];
-		if (side == 1)
-			color = (color >> 1) & 0x7F7F7F;
 		if (y >= 0 && y < SCREEN_HEIGHT)
-			state->screenBuffer[y][x] = color;
+			state->screenBuffer[y][x] = texels[tex.y];
 	}
-	cast_EnvTextures(state, map, rayDir, distToWall, wallX,
+	cast_EnvTextures(state, map, rayPos, rayDir, distToWall, wallX,
 		drawEnd, x, side);
 }
 
@@ -69,15 +70,15 @@ void drawTexturedWallStrips(GameState *state, SDL_Point map, point_t rayPos,
  * @textured: True if user enabled textures, otherwise False
  * Return: Always void
  */
-void drawWallStrips(GameState *state, SDL_Point map, point_t rayPos,
-	point_t rayDir, double distToWall, int x, int side, int textured)
+void drawWallStrips(GameState *state, SDL_Point map, vec_t rayPos,
+	vec_t rayDir, real_t distToWall, int x, int side, int textured)
 {
 	int sliceHeight, drawStart, drawEnd, width, height;
 
 	if (!textured)
 	{
 		SDL_GetWindowSize(state->window, &width, &height);
-		sliceHeight = (int)(height / distToWall);
+		sliceHeight = (int)(height / REAL_TO_DOUBLE(distToWall));
 		drawStart = -sliceHeight / 2 + height / 2;
 		if (drawStart < 0)
 			drawStart = 0;
@@ -96,6 +97,38 @@ void drawWallStrips(GameState *state, SDL_Point map, point_t rayPos,
 	}
 }
 
+/**
+ * ray_Delta - Distance along a ray between two grid lines of one axis,
+ * measured like the wall distance (in units of the camera direction)
+ * @d: Component of the ray direction along the axis
+ *
+ * Return: |1 / d|, or RAY_FAR when that is farther, which keeps the fixed
+ * point sums from overflowing
+ */
+static real_t ray_Delta(real_t d)
+{
+	if (d < 0)
+		d = -d;
+	return (REAL_MUL(d, RAY_FAR) > REAL_ONE ? REAL_DIV(REAL_ONE, d) : RAY_FAR);
+}
+
+/**
+ * ray_First - Distance along a ray to the first grid line of one axis
+ * @offset: Distance from the ray origin to that grid line along the axis
+ * @d: Component of the ray direction along the axis
+ * @delta: ray_Delta of @d
+ *
+ * Return: |offset / d|, or RAY_FAR when that is farther
+ */
+static real_t ray_First(real_t offset, real_t d, real_t delta)
+{
+	if (delta < RAY_FAR)
+		return (REAL_MUL(offset, delta));
+	if (d < 0)
+		d = -d;
+	return (REAL_MUL(d, RAY_FAR) > offset ? REAL_DIV(offset, d) : RAY_FAR);
+}
+
 /**
  * calculateRayPosition - Calculates the ray position and direction
  * @state: current game state.
@@ -108,84 +141,125 @@ void drawWallStrips(GameState *state, SDL_Point map, point_t rayPos,
  * @positionToNext: current position or next position of the player.
  * Return: void
  */
-void calculateRayPosition(GameState *state, int i, point_t *rayPosition,
-		point_t *rayDirection, SDL_Point *mapPosition, point_t *distanceToNext,
-		SDL_Point *stepDirection, point_t *positionToNext)
+void calculateRayPosition(GameState *state, int i, vec_t *rayPosition,
+		vec_t *rayDirection, SDL_Point *mapPosition, vec_t *distanceToNext,
+		SDL_Point *stepDirection, vec_t *positionToNext)
 {
 	double cameraX;
 
 	cameraX = 2 * i / (double)SCREEN_WIDTH - 1;
 
-	rayPosition->x = state->position.x;
-	rayPosition->y = state->position.y;
-	rayDirection->x = state->direction.x + state->viewPlane.x * cameraX;
-	rayDirection->y = state->direction.y + state->viewPlane.y * cameraX;
+	rayPosition->x = REAL(state->position.x);
+	rayPosition->y = REAL(state->position.y);
+	rayDirection->x = REAL(state->direction.x + state->viewPlane.x * cameraX);
+	rayDirection->y = REAL(state->direction.y + state->viewPlane.y * cameraX);
 
-	mapPosition->x = (int)rayPosition->x;
-	mapPosition->y = (int)rayPosition->y;
+	mapPosition->x = real_Floor(rayPosition->x);
+	mapPosition->y = real_Floor(rayPosition->y);
 
-	distanceToNext->x = rayDirection->x == 0 ? INFINITY :
-		sqrt(1 + pow(rayDirection->y, 2) / pow(rayDirection->x, 2));
-	distanceToNext->y = rayDirection->y == 0 ? INFINITY :
-		sqrt(1 + pow(rayDirection->x, 2) / pow(rayDirection->y, 2));
+	distanceToNext->x = ray_Delta(rayDirection->x);
+	distanceToNext->y = ray_Delta(rayDirection->y);
 
 	stepDirection->x = rayDirection->x < 0 ? -1 : 1;
 	stepDirection->y = rayDirection->y < 0 ? -1 : 1;
 
-	positionToNext->x = rayDirection->x < 0 ?
-		(rayPosition->x - mapPosition->x) * distanceToNext->x :
-		(mapPosition->x + 1.0 - rayPosition->x) *
-		distanceToNext->x;
-	positionToNext->y = rayDirection->y < 0 ?
-		(rayPosition->y - mapPosition->y) * distanceToNext->y :
-		(mapPosition->y + 1.0 - rayPosition->y) *
-		distanceToNext->y;
+	positionToNext->x = ray_First(rayDirection->x < 0 ?
+		rayPosition->x - REAL_FROM_INT(mapPosition->x) :
+		REAL_FROM_INT(mapPosition->x + 1) - rayPosition->x,
+		rayDirection->x, distanceToNext->x);
+	positionToNext->y = ray_First(rayDirection->y < 0 ?
+		rayPosition->y - REAL_FROM_INT(mapPosition->y) :
+		REAL_FROM_INT(mapPosition->y + 1) - rayPosition->y,
+		rayDirection->y, distanceToNext->y);
+}
+
+/**
+ * castRay - Steps a ray through the maze until it hits a wall. The ray
+ * checks the map edges for its first RAY_CHECKED_STEPS steps; a ray still
+ * going then takes at most the number of steps the visibility data allows
+ * from its start cell, without edge checks. With no bound it keeps
+ * checking the edges instead.
+ * @state: pointer to the GameState structure
+ * @column: screen column the ray is cast for
+ * @ray: receives the ray and where it stopped
+ * Return: true if a wall was hit, false otherwise
+ */
+bool castRay(GameState *state, int column, rayhit_t *ray)
+{
+	vec_t distanceToNext, positionToNext;
+	SDL_Point stepDirection, start;
+	int budget = -1, hit = 0;
+
+	calculateRayPosition(state, column, &ray->position, &ray->direction,
+		&ray->map, &distanceToNext, &stepDirection, &positionToNext);
+	ray->side = 0;
+	ray->steps = 0;
+	if (ray->map.x < 0 || ray->map.x >= state->mapHeight ||
+	    ray->map.y < 0 || ray->map.y >= state->mapWidth)
+		return (false);
+	start = ray->map;
+	while (!hit && (ray->steps < budget || budget < 0))
+	{
+		if (positionToNext.x < positionToNext.y)
+		{
+			positionToNext.x += distanceToNext.x;
+			ray->map.x += stepDirection.x;
+			ray->side = 0;
+		}
+		else
+		{
+			positionToNext.y += distanceToNext.y;
+			ray->map.y += stepDirection.y;
+			ray->side = 1;
+		}
+		ray->steps++;
+		if (budget < 0 && (ray->map.x < 0 || ray->map.x >= state->mapHeight ||
+		    ray->map.y < 0 || ray->map.y >= state->mapWidth))
+			return (false);
+		hit = state->maze[ray->map.x * state->mapWidth + ray->map.y] > 0;
+		if (ray->steps == RAY_CHECKED_STEPS && state->pvs)
+			budget = pvs_Bound(state->pvs, state->mapWidth, start.x, start.y,
+				(stepDirection.x > 0) + (stepDirection.y > 0) * 2);
+	}
+	if (!hit)
+		return (false);
+	ray->distance = ray->side == 0 ? positionToNext.x - distanceToNext.x :
+		positionToNext.y - distanceToNext.y;
+	if (ray->distance < RAY_MIN_DISTANCE)
+		ray->distance = RAY_MIN_DISTANCE;
+	ray->wallX = REAL_FRAC(ray->side == 0 ? ray->position.y +
+		REAL_MUL(ray->distance, ray->direction.y) : ray->position.x +
+		REAL_MUL(ray->distance, ray->direction.x));
+	return (true);
 }
 
 /**
- * renderWalls - Renders vertical wall slices
+ * renderWalls - Renders vertical wall slices, or the whole textured frame
+ * with the binned renderer of the state when it has one, and the minimap
+ * and metrics overlay over textured frames
  * @state: pointer to the GameState structure
  * @textured: flag to determine whether to render textures
  * Return: void
  */
 void renderWalls(GameState *state, int textured)
 {
+	rayhit_t ray;
 	int i;
-	point_t rayPosition, rayDirection, positionToNext, distanceToNext;
-	SDL_Point mapPosition, stepDirection;
-	int hit, side = 0;
-	double distanceToWall;
-	int *maze = state->maze;
 
-	for (i = 0; i < SCREEN_WIDTH; i++)
-	{
-		calculateRayPosition(state, i, &rayPosition, &rayDirection,
-			&mapPosition, &distanceToNext, &stepDirection, &positionToNext);
-		for (hit = 0; hit == 0;)
+	init_EnvRows();
+	if (textured && state->binner)
+		binner_Render(state->binner, state);
+	else
+		for (i = 0; i < SCREEN_WIDTH; i++)
 		{
-			if (positionToNext.x < positionToNext.y)
-			{
-				positionToNext.x += distanceToNext.x;
-				mapPosition.x += stepDirection.x;
-				side = 0;
-			}
-			else
-			{
-				positionToNext.y += distanceToNext.y;
-				mapPosition.y += stepDirection.y;
-				side = 1;
-			}
-
-			if (*((int *)maze + mapPosition.x * MAP_WIDTH + mapPosition.y) > 0)
-				hit = 1;
+			if (castRay(state, i, &ray))
+				drawWallStrips(state, ray.map, ray.position, ray.direction,
+					ray.distance, i, ray.side, textured);
 		}
-		distanceToWall = side == 0 ? (mapPosition.x - rayPosition.x +
-			(1 - stepDirection.x) / 2) / rayDirection.x :
-			(mapPosition.y - rayPosition.y + (1 - stepDirection.y) / 2) /
-			rayDirection.y;
-
-		drawWallStrips(state, mapPosition, rayPosition, rayDirection,
-			distanceToWall, i, side, textured);
+	if (textured)
+	{
+		minimap_Draw(state->minimap, state);
+		metrics_Draw(state->metrics, state);
 	}
 	update_SDLFrames(state, textured);
 }
@@ -0,0 +1,373 @@
+#include "../headers/reload.h"
+#include "../headers/map.h"
+#include "../headers/pvs.h"
+#include "../headers/textures.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define RELOAD_MAP_BIT (1u << TEXTURE_COUNT)
+#define RELOAD_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+#define RELOAD_SETTLE_MS 50
+
+/**
+ * reload_FreeData - Frees data read by the watcher or replaced by it
+ * @data: Pointer to the data, may be NULL
+ *
+ * Return: void
+ */
+static void reload_FreeData(reloaddata_t *data)
+{
+	if (data == NULL)
+		return;
+	free(data->maze);
+	free(data->pvs);
+	lighting_Destroy(data->lighting);
+	free(data);
+}
+
+/**
+ * reload_ReadMap - Reads the map again with its visibility data and
+ * lighting, keeping the previous data when the new file is invalid
+ * @reload: Pointer to the watcher
+ * @data: Data to fill
+ *
+ * Return: void
+ */
+static void reload_ReadMap(reload_t *reload, reloaddata_t *data)
+{
+	lighting_t *lighting = NULL;
+	uint8_t *pvs = NULL;
+	int width, height, *maze;
+
+	maze = readMapFromFile(reload->mapFile, &width, &height);
+	if (maze)
+		pvs = pvs_Load(maze, width, height, reload->mapFile);
+	if (pvs == NULL || !lighting_Load(maze, width, height, reload->mapFile,
+	    &lighting))
+	{
+		fprintf(stderr, "Warning: %s not reloaded\n", reload->mapFile);
+		free(maze);
+		free(pvs);
+		return;
+	}
+	free(data->maze);
+	free(data->pvs);
+	lighting_Destroy(data->lighting);
+	data->maze = maze;
+	data->mapWidth = width;
+	data->mapHeight = height;
+	data->pvs = pvs;
+	data->lighting = lighting;
+}
+
+/**
+ * reload_ReadTextures - Decodes the textures that changed
+ * @reload: Pointer to the watcher
+ * @data: Data to fill
+ * @changed: Bit per changed texture slot
+ *
+ * Return: void
+ */
+static void reload_ReadTextures(reload_t *reload, reloaddata_t *data,
+		unsigned int changed)
+{
+	unsigned int decoded = 0;
+	int slot;
+
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+	{
+#ifdef MAZE_PALETTE
+		if (changed & 1u << slot && load_TextureSlot(reload->textureDir, slot,
+		    reload->texels[slot]))
+			decoded |= 1u << slot;
+#else
+		if (changed & 1u << slot && load_TextureSlot(reload->textureDir, slot,
+		    data->tiles[slot]))
+			decoded |= 1u << slot;
+#endif
+	}
+#ifdef MAZE_PALETTE
+	if (decoded && convert_TexturePixels(reload->texels, data->tiles,
+	    data->palette, data->colormap))
+		decoded = (1u << TEXTURE_COUNT) - 1;
+	else
+		decoded = 0;
+#endif
+	data->textures |= decoded;
+}
+
+/**
+ * reload_Read - Reads the changed files and publishes the result, merged
+ * with anything published earlier and not yet swapped in
+ * @reload: Pointer to the watcher
+ * @changed: Bit per changed texture slot, and RELOAD_MAP_BIT for the map
+ * @detected: Performance counter at the first change
+ *
+ * Return: void
+ */
+static void reload_Read(reload_t *reload, unsigned int changed,
+		uint64_t detected)
+{
+	reloaddata_t *data = SDL_AtomicSetPtr(&reload->pending, NULL);
+
+	if (data == NULL)
+		data = calloc(1, sizeof(reloaddata_t));
+	if (data == NULL)
+		return;
+	if (changed & RELOAD_MAP_BIT)
+		reload_ReadMap(reload, data);
+	if (changed & (RELOAD_MAP_BIT - 1))
+		reload_ReadTextures(reload, data, changed);
+	if (data->maze == NULL && data->textures == 0)
+	{
+		free(data);
+		return;
+	}
+	if (data->detected == 0)
+		data->detected = detected;
+	data->ready = SDL_GetPerformanceCounter();
+	SDL_AtomicSetPtr(&reload->pending, data);
+}
+
+/**
+ * reload_Changes - Reads the pending inotify events
+ * @reload: Pointer to the watcher
+ *
+ * Return: Bit per changed texture slot, and RELOAD_MAP_BIT for the map
+ */
+static unsigned int reload_Changes(reload_t *reload)
+{
+	long buffer[1024];
+	struct inotify_event *event;
+	unsigned int changed = 0;
+	ssize_t size, offset;
+	int slot;
+
+	while ((size = read(reload->notify, buffer, sizeof(buffer))) > 0)
+		for (offset = 0; offset < size;
+		     offset += sizeof(struct inotify_event) + event->len)
+		{
+			event = (struct inotify_event *)((char *)buffer + offset);
+			if (event->len == 0)
+				continue;
+			if (event->wd == reload->mapWatch &&
+			    strcmp(event->name, reload->mapName) == 0)
+				changed |= RELOAD_MAP_BIT;
+			slot = get_TextureSlot(event->name);
+			if (event->wd == reload->textureWatch && slot >= 0)
+				changed |= 1u << slot;
+		}
+	return (changed);
+}
+
+/**
+ * reload_Watch - Body of the watcher thread. Changes are collected until
+ * no event arrived for RELOAD_SETTLE_MS, so a file saved in several
+ * writes is read once.
+ * @data: Pointer to the watcher
+ *
+ * Return: 0
+ */
+static int reload_Watch(void *data)
+{
+	reload_t *reload = data;
+	struct pollfd wait = {0, POLLIN, 0};
+	unsigned int changed;
+	uint64_t detected;
+	int slot;
+
+	wait.fd = reload->notify;
+#ifdef MAZE_PALETTE
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+		load_TextureSlot(reload->textureDir, slot, reload->texels[slot]);
+#else
+	(void)slot;
+#endif
+	while (!SDL_AtomicGet(&reload->stop))
+	{
+		reload_FreeData(SDL_AtomicSetPtr(&reload->retired, NULL));
+		if (poll(&wait, 1, 100) <= 0)
+			continue;
+		detected = SDL_GetPerformanceCounter();
+		changed = reload_Changes(reload);
+		while (poll(&wait, 1, RELOAD_SETTLE_MS) > 0)
+			changed |= reload_Changes(reload);
+		if (changed)
+			reload_Read(reload, changed, detected);
+	}
+	return (0);
+}
+
+/**
+ * reload_Start - Starts watching the map being played and the textures
+ * @mapFile: Path of the map, kept by the watcher
+ * @textureDir: Directory holding the texture files, kept by the watcher
+ *
+ * Return: Pointer to the watcher, or NULL on failure
+ */
+reload_t *reload_Start(char *mapFile, const char *textureDir)
+{
+	reload_t *reload = calloc(1, sizeof(reload_t));
+	const char *slash = strrchr(mapFile, '/');
+	char *dir = strdup(mapFile);
+
+	if (reload == NULL || dir == NULL)
+	{
+		free(reload);
+		free(dir);
+		return (NULL);
+	}
+	reload->mapFile = mapFile;
+	reload->mapName = slash ? slash + 1 : mapFile;
+	reload->textureDir = textureDir;
+	if (slash)
+		dir[slash - mapFile] = '\0';
+	reload->notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	reload->mapWatch = reload->notify < 0 ? -1 : inotify_add_watch(
+		reload->notify, slash ? dir : ".", RELOAD_EVENTS);
+	reload->textureWatch = reload->notify < 0 ? -1 : inotify_add_watch(
+		reload->notify, textureDir, RELOAD_EVENTS);
+	free(dir);
+#ifdef MAZE_PALETTE
+	reload->texels = calloc(TEXTURE_COUNT, sizeof(*reload->texels));
+	if (reload->texels == NULL)
+		reload->mapWatch = -1;
+#endif
+	if (reload->mapWatch >= 0 && reload->textureWatch >= 0)
+		reload->thread = SDL_CreateThread(reload_Watch, "reload", reload);
+	if (reload->thread == NULL)
+	{
+		fprintf(stderr, "Error: Unable to watch %s and %s\n", mapFile,
+			textureDir);
+		if (reload->notify >= 0)
+			close(reload->notify);
+		free(reload->texels);
+		free(reload);
+		return (NULL);
+	}
+	return (reload);
+}
+
+/**
+ * reload_Stop - Stops the watcher and frees it
+ * @reload: Pointer to the watcher, may be NULL
+ *
+ * Return: void
+ */
+void reload_Stop(reload_t *reload)
+{
+	if (reload == NULL)
+		return;
+	SDL_AtomicSet(&reload->stop, 1);
+	SDL_WaitThread(reload->thread, NULL);
+	close(reload->notify);
+	reload_FreeData(reload->pending);
+	reload_FreeData(reload->retired);
+	free(reload->texels);
+	free(reload);
+}
+
+/**
+ * reload_Apply - Swaps the data published by the watcher into the game,
+ * between two frames. The player is moved out of any wall the new map
+ * puts it in, and changed textures are shaded again.
+ * @reload: Pointer to the watcher, may be NULL
+ * @state: Pointer to the GameState
+ *
+ * Return: true if data was swapped in, else false
+ */
+bool reload_Apply(reload_t *reload, GameState *state)
+{
+	uint64_t start = SDL_GetPerformanceCounter();
+	double frequency = SDL_GetPerformanceFrequency();
+	reloaddata_t *data, swap;
+	int slot;
+
+	data = reload ? SDL_AtomicSetPtr(&reload->pending, NULL) : NULL;
+	if (data == NULL)
+		return (false);
+	if (data->maze)
+	{
+		swap = *data;
+		data->maze = state->maze;
+		data->pvs = state->pvs;
+		data->lighting = state->lighting;
+		state->maze = swap.maze;
+		state->mapWidth = swap.mapWidth;
+		state->mapHeight = swap.mapHeight;
+		state->pvs = swap.pvs;
+		state->lighting = swap.lighting;
+		findOpenCell(state->maze, state->mapWidth, state->mapHeight,
+			&state->position);
+	}
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+		if (data->textures & 1u << slot)
+			memcpy(state->tiles[slot], data->tiles[slot],
+				sizeof(state->tiles[slot]));
+#ifdef MAZE_PALETTE
+	if (data->textures)
+	{
+		memcpy(state->palette, data->palette, sizeof(state->palette));
+		memcpy(state->colormap, data->colormap, sizeof(state->colormap));
+	}
+#endif
+	if (data->textures)
+		shade_TexturePixels(state, data->textures);
+	reload->apply = (SDL_GetPerformanceCounter() - start) / frequency;
+	reload->latency = (SDL_GetPerformanceCounter() - data->detected) /
+		frequency;
+	reload->reloads++;
+	if (reload->latency > reload->latencyMax)
+		reload->latencyMax = reload->latency;
+	if (reload->apply > reload->applyMax)
+		reload->applyMax = reload->apply;
+	data->textures = 0;
+	reload_FreeData(SDL_AtomicSetPtr(&reload->retired, data));
+	return (true);
+}
+
+#else
+
+/**
+ * reload_Start - Hot reload needs inotify, which this platform lacks
+ * @mapFile: Path of the map
+ * @textureDir: Directory holding the texture files
+ *
+ * Return: NULL
+ */
+reload_t *reload_Start(char *mapFile, const char *textureDir)
+{
+	fprintf(stderr, "Error: Unable to watch %s and %s\n", mapFile,
+		textureDir);
+	return (NULL);
+}
+
+/**
+ * reload_Stop - Nothing to stop without inotify
+ * @reload: NULL
+ *
+ * Return: void
+ */
+void reload_Stop(reload_t *reload)
+{
+	(void)reload;
+}
+
+/**
+ * reload_Apply - Nothing to swap in without inotify
+ * @reload: NULL
+ * @state: Pointer to the GameState
+ *
+ * Return: false
+ */
+bool reload_Apply(reload_t *reload, GameState *state)
+{
+	(void)reload;
+	(void)state;
+	return (false);
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "../headers/replay.h"
+#include "../headers/pvs.h"
+
+/**
+ * replay_ReadFrames - Reads every frame left in a replay file
+ * @replay: Pointer to the replay
+ * @file: File positioned after the header
+ *
+ * Return: true on success, false on failure
+ */
+static bool replay_ReadFrames(replay_t *replay, FILE *file)
+{
+	long start = ftell(file), end;
+
+	if (start < 0 || fseek(file, 0, SEEK_END) != 0)
+		return (false);
+	end = ftell(file);
+	if (end < start || fseek(file, start, SEEK_SET) != 0)
+		return (false);
+	replay->frameCount = (end - start) / REPLAY_FRAME_SIZE;
+	replay->frames = malloc(replay->frameCount * REPLAY_FRAME_SIZE + 1);
+	if (replay->frames == NULL)
+		return (false);
+	return (fread(replay->frames, REPLAY_FRAME_SIZE, replay->frameCount,
+		file) == replay->frameCount);
+}
+
+/**
+ * replay_Open - Starts recording a run, or loads a recorded run and puts
+ * the player back where it started
+ * @state: Pointer to the GameState, its map must be loaded
+ * @path: Path of the replay file
+ * @mode: REPLAY_RECORD or REPLAY_PLAY
+ *
+ * Return: Pointer to the replay, or NULL on failure
+ */
+replay_t *replay_Open(GameState *state, const char *path, replaymode_t mode)
+{
+	replay_t *replay = calloc(1, sizeof(replay_t));
+	replayheader_t header;
+	FILE *file = fopen(path, mode == REPLAY_RECORD ? "wb" : "rb");
+	bool opened = false;
+
+	header.magic = REPLAY_MAGIC;
+	header.mapHash = pvs_HashMap(state->maze, state->mapWidth,
+		state->mapHeight);
+	if (replay && file && mode == REPLAY_RECORD)
+	{
+		header.position = state->position;
+		header.direction = state->direction;
+		header.viewPlane = state->viewPlane;
+		opened = fwrite(&header, sizeof(header), 1, file) == 1;
+	}
+	else if (replay && file && fread(&header, sizeof(header), 1, file) == 1 &&
+		 header.magic == REPLAY_MAGIC && replay_ReadFrames(replay, file))
+	{
+		if (header.mapHash != pvs_HashMap(state->maze, state->mapWidth,
+				state->mapHeight))
+			fprintf(stderr, "Warning: %s was recorded on another map\n", path);
+		state->position = header.position;
+		state->direction = header.direction;
+		state->viewPlane = header.viewPlane;
+		opened = true;
+	}
+	if (!opened)
+	{
+		fprintf(stderr, "Error: Unable to open replay %s\n", path);
+		if (file)
+			fclose(file);
+		replay_Close(replay);
+		return (NULL);
+	}
+	replay->mode = mode;
+	if (mode == REPLAY_RECORD)
+		replay->file = file;
+	else
+		fclose(file);
+	return (replay);
+}
+
+/**
+ * replay_Record - Appends the input and timestep of a frame
+ * @replay: Pointer to a recording replay
+ * @input: Input bits of the frame (see player.h)
+ * @elapsed: Time the frame advanced the game, in ms
+ *
+ * Return: void
+ */
+void replay_Record(replay_t *replay, uint8_t input, uint16_t elapsed)
+{
+	uint8_t frame[REPLAY_FRAME_SIZE];
+
+	frame[0] = input;
+	frame[1] = elapsed & 0xFF;
+	frame[2] = elapsed >> 8;
+	if (fwrite(frame, REPLAY_FRAME_SIZE, 1, replay->file) == 1)
+		replay->frameCount++;
+}
+
+/**
+ * replay_Next - Fetches the next recorded frame
+ * @replay: Pointer to a playing replay
+ * @input: Receives the input bits of the frame
+ * @elapsed: Receives the timestep of the frame, in ms
+ *
+ * Return: true if a frame was left, false at the end of the replay
+ */
+bool replay_Next(replay_t *replay, uint8_t *input, uint16_t *elapsed)
+{
+	uint8_t *frame;
+
+	if (replay->cursor >= replay->frameCount)
+		return (false);
+	frame = replay->frames + replay->cursor++ * REPLAY_FRAME_SIZE;
+	*input = frame[0];
+	*elapsed = frame[1] | frame[2] << 8;
+	return (true);
+}
+
+/**
+ * replay_Close - Finishes a recording and frees a replay
+ * @replay: Pointer to the replay, may be NULL
+ *
+ * Return: void
+ */
+void replay_Close(replay_t *replay)
+{
+	if (replay == NULL)
+		return;
+	if (replay->file && fclose(replay->file) != 0)
+		fprintf(stderr, "Error: Unable to finish the replay file\n");
+	free(replay->frames);
+	free(replay);
+}
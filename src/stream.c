@@ -0,0 +1,218 @@
+#include "../headers/stream.h"
+#include "../headers/palette.h"
+
+/**
+ * parseStreamFormat - Converts a format name to a stream format
+ * @name: "y4m" or "argb"
+ * @format: Receives the format
+ *
+ * Return: true if the name is known, else false
+ */
+bool parseStreamFormat(const char *name, streamformat_t *format)
+{
+	if (strcmp(name, "y4m") == 0)
+		*format = STREAM_Y4M;
+	else if (strcmp(name, "argb") == 0)
+		*format = STREAM_ARGB;
+	else
+		return (false);
+	return (true);
+}
+
+/**
+ * stream_Expand - Turns a queued frame into ARGB pixels
+ * @stream: Pointer to the stream
+ * @frame: The frame
+ *
+ * Return: The pixels, either the frame itself or the scratch frame
+ */
+static const uint32_t *stream_Expand(stream_t *stream,
+		const streamframe_t *frame)
+{
+	int y;
+
+#ifdef MAZE_PALETTE
+	for (y = 0; y < SCREEN_HEIGHT; y++)
+		palette_Expand(frame->palette, frame->pixels[y],
+			stream->argb + y * SCREEN_WIDTH, SCREEN_WIDTH);
+#else
+	if (stream->format == STREAM_Y4M)
+		return (&frame->pixels[0][0]);
+	memcpy(stream->argb, frame->pixels, sizeof(frame->pixels));
+#endif
+	if (stream->format == STREAM_ARGB)
+		for (y = 0; y < SCREEN_WIDTH * SCREEN_HEIGHT; y++)
+			stream->argb[y] |= 0xFF000000;
+	return (stream->argb);
+}
+
+/**
+ * stream_WriteFrame - Converts and writes one frame
+ * @stream: Pointer to the stream
+ * @frame: The frame
+ *
+ * Return: true on success, false if the write failed
+ */
+static bool stream_WriteFrame(stream_t *stream, const streamframe_t *frame)
+{
+	const uint32_t *argb = stream_Expand(stream, frame);
+	size_t luma = SCREEN_WIDTH * SCREEN_HEIGHT, chroma = (SCREEN_WIDTH + 1) /
+		2 * ((SCREEN_HEIGHT + 1) / 2);
+
+	if (stream->format == STREAM_ARGB)
+		return (fwrite(argb, sizeof(uint32_t), luma, stream->file) == luma);
+	stream_YUV420(argb, SCREEN_WIDTH, SCREEN_HEIGHT, stream->yuv,
+		stream->yuv + luma, stream->yuv + luma + chroma);
+	return (fputs("FRAME\n", stream->file) >= 0 && fwrite(stream->yuv, 1,
+		luma + 2 * chroma, stream->file) == luma + 2 * chroma);
+}
+
+/**
+ * stream_Writer - Body of the writer thread: writes queued frames in order
+ * until the stream closes and the ring is empty
+ * @data: Pointer to the stream
+ *
+ * Return: 0
+ */
+static int stream_Writer(void *data)
+{
+	stream_t *stream = data;
+	streamframe_t *frame;
+
+	for (;;)
+	{
+		SDL_LockMutex(stream->lock);
+		while (stream->count == 0 && !stream->closing)
+			SDL_CondWait(stream->queued, stream->lock);
+		frame = stream->count ? &stream->slots[stream->first] : NULL;
+		SDL_UnlockMutex(stream->lock);
+		if (frame == NULL)
+			return (0);
+		if (!stream->failed && !stream_WriteFrame(stream, frame))
+		{
+			fprintf(stderr, "Error: Unable to write video frame\n");
+			stream->failed = true;
+		}
+		SDL_LockMutex(stream->lock);
+		stream->first = (stream->first + 1) % STREAM_SLOTS;
+		stream->count--;
+		if (stream->failed)
+			stream->dropped++;
+		else
+			stream->written++;
+		SDL_CondSignal(stream->freed);
+		SDL_UnlockMutex(stream->lock);
+	}
+}
+
+/**
+ * stream_Frame - Queues the finished frame of the state. When the ring is
+ * full the frame is dropped, or for a stream opened to wait, queued once
+ * the writer frees a slot.
+ * @stream: Pointer to the stream, may be NULL
+ * @state: Pointer to the GameState holding the frame
+ *
+ * Return: void
+ */
+void stream_Frame(stream_t *stream, const GameState *state)
+{
+	streamframe_t *frame = NULL;
+
+	if (stream == NULL)
+		return;
+	SDL_LockMutex(stream->lock);
+	while (stream->wait && stream->count == STREAM_SLOTS)
+		SDL_CondWait(stream->freed, stream->lock);
+	if (stream->count < STREAM_SLOTS)
+		frame = &stream->slots[(stream->first + stream->count) % STREAM_SLOTS];
+	else
+		stream->dropped++;
+	SDL_UnlockMutex(stream->lock);
+	if (frame == NULL)
+		return;
+	memcpy(frame->pixels, state->screenBuffer, sizeof(frame->pixels));
+#ifdef MAZE_PALETTE
+	memcpy(frame->palette, state->palette, sizeof(frame->palette));
+#endif
+	SDL_LockMutex(stream->lock);
+	stream->count++;
+	SDL_CondSignal(stream->queued);
+	SDL_UnlockMutex(stream->lock);
+}
+
+/**
+ * stream_Open - Starts a video output
+ * @output: Path of the file, or '|' followed by a command to pipe to
+ * @format: Format of the frames
+ * @wait: true to wait for the writer when the ring is full, as when there
+ * is no window; false to drop frames instead
+ *
+ * Return: Pointer to the stream, or NULL on failure
+ */
+stream_t *stream_Open(const char *output, streamformat_t format, bool wait)
+{
+	stream_t *stream = calloc(1, sizeof(stream_t));
+
+	if (stream == NULL)
+		return (NULL);
+	stream->format = format;
+	stream->wait = wait;
+	stream->piped = output[0] == '|';
+	stream->file = stream->piped ? popen(output + 1, "w") :
+		fopen(output, "wb");
+	stream->slots = malloc(STREAM_SLOTS * sizeof(streamframe_t));
+	stream->argb = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+	stream->yuv = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * 2);
+	stream->lock = SDL_CreateMutex();
+	stream->queued = SDL_CreateCond();
+	stream->freed = SDL_CreateCond();
+	if (stream->file && format == STREAM_Y4M && fprintf(stream->file,
+	    "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", SCREEN_WIDTH,
+	    SCREEN_HEIGHT, STREAM_FPS) < 0)
+		stream->failed = true;
+	if (stream->file && stream->slots && stream->argb && stream->yuv &&
+	    stream->lock && stream->queued && stream->freed && !stream->failed)
+		stream->thread = SDL_CreateThread(stream_Writer, "stream", stream);
+	if (stream->thread == NULL)
+	{
+		fprintf(stderr, "Error: Unable to stream video to %s\n", output);
+		stream->failed = true;
+		stream_Close(stream);
+		return (NULL);
+	}
+	return (stream);
+}
+
+/**
+ * stream_Close - Writes the frames still queued, closes the output and
+ * reports how many frames were written and dropped
+ * @stream: Pointer to the stream, may be NULL
+ *
+ * Return: void
+ */
+void stream_Close(stream_t *stream)
+{
+	if (stream == NULL)
+		return;
+	if (stream->thread)
+	{
+		SDL_LockMutex(stream->lock);
+		stream->closing = true;
+		SDL_CondSignal(stream->queued);
+		SDL_UnlockMutex(stream->lock);
+		SDL_WaitThread(stream->thread, NULL);
+		fprintf(stderr, "Streamed %lu frames, %lu dropped\n", stream->written,
+			stream->dropped);
+	}
+	if (stream->file && stream->piped)
+		pclose(stream->file);
+	else if (stream->file)
+		fclose(stream->file);
+	SDL_DestroyCond(stream->freed);
+	SDL_DestroyCond(stream->queued);
+	SDL_DestroyMutex(stream->lock);
+	free(stream->slots);
+	free(stream->argb);
+	free(stream->yuv);
+	free(stream);
+}
@@ -0,0 +1,200 @@
+#include "../headers/stream.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * BT.601 studio range in integer math, the same in both paths so they
+ * give identical frames:
+ *   Y = ((66 R + 129 G + 25 B + 128) >> 8) + 16
+ * and U, V from the sums Rs, Gs, Bs of each 2x2 block:
+ *   U = (112 Bs - 38 Rs - 74 Gs + 131584) >> 10
+ *   V = (112 Rs - 94 Gs - 18 Bs + 131584) >> 10
+ * 131584 is 128 << 10 plus rounding, which keeps every sum positive.
+ */
+#define YUV_CHROMA_BIAS 131584
+
+/**
+ * stream_YUV420Scalar - Converts the columns of an ARGB frame from x0 on
+ * to planar YUV 4:2:0, the last row and column standing in for missing
+ * ones when the size is odd
+ * @argb: Frame of width * height pixels
+ * @width: Number of pixels in a row
+ * @height: Number of rows
+ * @x0: First column to convert, even
+ * @y: Luma plane, width * height bytes
+ * @u: Cb plane, (width + 1) / 2 * ((height + 1) / 2) bytes
+ * @v: Cr plane, the size of @u
+ *
+ * Return: void
+ */
+void stream_YUV420Scalar(const uint32_t *argb, int width, int height,
+		int x0, uint8_t *y, uint8_t *u, uint8_t *v)
+{
+	int cw = (width + 1) / 2, row, col, k, r, g, b, rs, gs, bs;
+	uint32_t p;
+
+	for (row = 0; row < height; row++)
+		for (col = x0; col < width; col++)
+		{
+			p = argb[row * width + col];
+			r = p >> 16 & 0xFF;
+			g = p >> 8 & 0xFF;
+			b = p & 0xFF;
+			y[row * width + col] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+		}
+	for (row = 0; row < height; row += 2)
+		for (col = x0; col < width; col += 2)
+		{
+			rs = gs = bs = 0;
+			for (k = 0; k < 4; k++)
+			{
+				p = argb[(row + (k >> 1 && row + 1 < height)) * width + col +
+					((k & 1) && col + 1 < width)];
+				rs += p >> 16 & 0xFF;
+				gs += p >> 8 & 0xFF;
+				bs += p & 0xFF;
+			}
+			u[row / 2 * cw + col / 2] = (112 * bs - 38 * rs - 74 * gs +
+				YUV_CHROMA_BIAS) >> 10;
+			v[row / 2 * cw + col / 2] = (112 * rs - 94 * gs - 18 * bs +
+				YUV_CHROMA_BIAS) >> 10;
+		}
+}
+
+#ifdef __SSE2__
+
+/**
+ * yuv_Channels - Splits 8 ARGB pixels into 16-bit channel lanes
+ * @lo: First 4 pixels
+ * @hi: Last 4 pixels
+ * @rgb: Receives the red, green and blue lanes
+ *
+ * Return: void
+ */
+static void yuv_Channels(__m128i lo, __m128i hi, __m128i rgb[3])
+{
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	int c;
+
+	for (c = 0; c < 3; c++)
+		rgb[c] = _mm_packs_epi32(
+			_mm_and_si128(_mm_srli_epi32(lo, 16 - 8 * c), mask),
+			_mm_and_si128(_mm_srli_epi32(hi, 16 - 8 * c), mask));
+}
+
+/**
+ * yuv_Luma - Computes the luma of 8 pixels
+ * @rgb: Red, green and blue lanes
+ *
+ * Return: 8 luma values in 16-bit lanes
+ */
+static __m128i yuv_Luma(const __m128i rgb[3])
+{
+	__m128i sum = _mm_add_epi16(
+		_mm_add_epi16(_mm_mullo_epi16(rgb[0], _mm_set1_epi16(66)),
+			_mm_mullo_epi16(rgb[1], _mm_set1_epi16(129))),
+		_mm_add_epi16(_mm_mullo_epi16(rgb[2], _mm_set1_epi16(25)),
+			_mm_set1_epi16(128)));
+
+	return (_mm_add_epi16(_mm_srli_epi16(sum, 8), _mm_set1_epi16(16)));
+}
+
+/**
+ * yuv_Chroma - Computes 8 chroma values from 2x2 block sums
+ * @a: Sums the first coefficient applies to
+ * @b: Sums the second coefficient applies to
+ * @c: Sums the third coefficient applies to
+ * @ab: The first two coefficients, packed as two 16-bit lanes
+ * @third: The third coefficient
+ *
+ * Return: 8 chroma values in 16-bit lanes
+ */
+static __m128i yuv_Chroma(__m128i a, __m128i b, __m128i c, int ab, int third)
+{
+	const __m128i zero = _mm_setzero_si128(), bias = _mm_set1_epi32(
+		YUV_CHROMA_BIAS), k1 = _mm_set1_epi32(ab),
+		k2 = _mm_set1_epi32(third & 0xFFFF);
+	__m128i lo, hi;
+
+	lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b),
+		k1), _mm_madd_epi16(_mm_unpacklo_epi16(c, zero), k2)), bias);
+	hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b),
+		k1), _mm_madd_epi16(_mm_unpackhi_epi16(c, zero), k2)), bias);
+	return (_mm_packs_epi32(_mm_srli_epi32(lo, 10), _mm_srli_epi32(hi, 10)));
+}
+
+/**
+ * yuv_Block - Converts 16 columns of two rows
+ * @top: First pixel of the block in the upper row
+ * @width: Number of pixels in a row
+ * @y: Luma of the first pixel of the block
+ * @u: Cb of the block
+ * @v: Cr of the block
+ *
+ * Return: void
+ */
+static void yuv_Block(const uint32_t *top, int width, uint8_t *y,
+		uint8_t *u, uint8_t *v)
+{
+	const __m128i ones = _mm_set1_epi16(1);
+	__m128i rgb[2][2][3], sums[3], half[2];
+	const uint32_t *row;
+	int r, h, c;
+
+	for (r = 0; r < 2; r++)
+	{
+		row = top + r * width;
+		for (h = 0; h < 2; h++)
+			yuv_Channels(_mm_loadu_si128((const __m128i *)(row + h * 8)),
+				_mm_loadu_si128((const __m128i *)(row + h * 8 + 4)),
+				rgb[r][h]);
+		_mm_storeu_si128((__m128i *)(y + r * width), _mm_packus_epi16(
+			yuv_Luma(rgb[r][0]), yuv_Luma(rgb[r][1])));
+	}
+	for (c = 0; c < 3; c++)
+	{
+		for (h = 0; h < 2; h++)
+			half[h] = _mm_madd_epi16(_mm_add_epi16(rgb[0][h][c], rgb[1][h][c]),
+				ones);
+		sums[c] = _mm_packs_epi32(half[0], half[1]);
+	}
+	_mm_storel_epi64((__m128i *)u, _mm_packus_epi16(yuv_Chroma(sums[2],
+		sums[0], sums[1], (int)(0xFFDA0070u), -74), ones));
+	_mm_storel_epi64((__m128i *)v, _mm_packus_epi16(yuv_Chroma(sums[0],
+		sums[1], sums[2], (int)(0xFFA20070u), -18), ones));
+}
+
+#endif
+
+/**
+ * stream_YUV420 - Converts an ARGB frame to planar YUV 4:2:0, 16 columns
+ * of two rows at a time with SSE2 when the compiler targets it
+ * @argb: Frame of width * height pixels
+ * @width: Number of pixels in a row
+ * @height: Number of rows
+ * @y: Luma plane, width * height bytes
+ * @u: Cb plane, (width + 1) / 2 * ((height + 1) / 2) bytes
+ * @v: Cr plane, the size of @u
+ *
+ * Return: void
+ */
+void stream_YUV420(const uint32_t *argb, int width, int height,
+		uint8_t *y, uint8_t *u, uint8_t *v)
+{
+	int x0 = 0;
+#ifdef __SSE2__
+	int cw = (width + 1) / 2, row, col;
+
+	if (height % 2 == 0)
+	{
+		x0 = width / 16 * 16;
+		for (row = 0; row < height; row += 2)
+			for (col = 0; col < x0; col += 16)
+				yuv_Block(argb + row * width + col, width, y + row * width + col,
+					u + row / 2 * cw + col / 2, v + row / 2 * cw + col / 2);
+	}
+#endif
+	stream_YUV420Scalar(argb, width, height, x0, y, u, v);
+}
@@ -1,15 +1,17 @@
-#include "../headers/defs.h"
+#include "../headers/textures.h"
+#include "../headers/palette.h"
+#include "../headers/lighting.h"
 #include <SDL2/SDL_image.h>
 
 /**
  * extract_TexturePixels - Responsible for extracting pixels
  * from a single texture
- * @state: Represents a pointer to the Game structure
  * @texture: Pointer to the SDL_Surface representing the texture
- * @index: Index of the texture in the tiles array
+ * @texels: Receives the xRGB texels of the texture
  * Return: Always void
  */
-void extract_TexturePixels(GameState *state, SDL_Surface *texture, int index)
+void extract_TexturePixels(SDL_Surface *texture,
+		uint32_t texels[TEXTURE_HEIGHT][TEXTURE_WIDTH])
 {
 	int j, k, flipped_j;
 	uint8_t *pixel;
@@ -32,33 +34,168 @@ void extract_TexturePixels(GameState *state, SDL_Surface *texture, int index)
 
 			SDL_GetRGB(color, texture->format, &r, &g, &b);
 
-			state->tiles[index][j][k] = (r << 16) | (g << 8) | b;
+			texels[j][k] = (r << 16) | (g << 8) | b;
 		}
 	}
 
 	SDL_UnlockSurface(texture);
 }
 
+static const char *textureNames[TEXTURE_COUNT] = {
+	"brick_1.jpg",
+	"brick_2.jpg",
+	"brick_3.jpg",
+	"brick_4.jpg",
+	"floor.jpg",
+	"ceiling.jpg"
+};
+
+/**
+ * convert_TexturePixels - Converts the texels of every texture to the pixel
+ * format of the build. Palette builds derive the palette and its shade
+ * rows from the texels first.
+ * @texels: xRGB texels of the TEXTURE_COUNT textures
+ * @tiles: Receives the texture pixels
+ * @palette: Receives the palette, unused outside palette builds
+ * @colormap: Receives the shade rows, unused outside palette builds
+ * Return: true on success, false if memory ran out
+ */
+bool convert_TexturePixels(uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH],
+		pixel_t (*tiles)[TEXTURE_HEIGHT][TEXTURE_WIDTH], uint32_t *palette,
+		uint8_t (*colormap)[PALETTE_SIZE])
+{
+#ifdef MAZE_PALETTE
+	int t, j, k;
+
+	if (!palette_Quantise(&texels[0][0][0], (size_t)TEXTURE_COUNT *
+	    TEXTURE_HEIGHT * TEXTURE_WIDTH, palette))
+		return (false);
+	palette_BuildColormap(palette, colormap);
+	for (t = 0; t < TEXTURE_COUNT; t++)
+		for (j = 0; j < TEXTURE_HEIGHT; j++)
+			for (k = 0; k < TEXTURE_WIDTH; k++)
+				tiles[t][j][k] = palette_Nearest(palette, texels[t][j][k]);
+#else
+	(void)palette;
+	(void)colormap;
+	memcpy(tiles, texels, TEXTURE_COUNT * sizeof(*tiles));
+#endif
+	return (true);
+}
+
+/**
+ * set_TexturePixels - Stores the texels of every texture in the state, in
+ * the pixel format of the build, along with their shaded copies
+ * @state: Represents a pointer to the Game structure
+ * @texels: xRGB texels of the TEXTURE_COUNT textures
+ * Return: true on success, false if memory ran out
+ */
+bool set_TexturePixels(GameState *state,
+		uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH])
+{
+	if (state->shades == NULL)
+		state->shades = malloc(SHADE_LEVELS * sizeof(*state->shades));
+	if (state->shades == NULL)
+		return (false);
+#ifdef MAZE_PALETTE
+	if (!convert_TexturePixels(texels, state->tiles, state->palette,
+	    state->colormap))
+#else
+	if (!convert_TexturePixels(texels, state->tiles, NULL, NULL))
+#endif
+		return (false);
+	shade_TexturePixels(state, (1u << TEXTURE_COUNT) - 1);
+	return (true);
+}
+
+/**
+ * shade_TexturePixels - Shades textures at every level into the shaded
+ * copies of the state, so the renderers never shade a pixel themselves
+ * @state: Represents a pointer to the Game structure, with its shaded
+ * copies allocated
+ * @slots: Bit per texture slot to shade
+ * Return: Always void
+ */
+void shade_TexturePixels(GameState *state, unsigned int slots)
+{
+	shade_t shade;
+	int level, t, j, k;
+
+	for (level = 0; level < SHADE_LEVELS; level++)
+	{
+		shade = SHADE_ROW(state, level);
+		for (t = 0; t < TEXTURE_COUNT; t++)
+			for (j = 0; slots & 1u << t && j < TEXTURE_HEIGHT; j++)
+				for (k = 0; k < TEXTURE_WIDTH; k++)
+					state->shades[level][t][j][k] =
+						SHADE(shade, state->tiles[t][j][k]);
+	}
+}
+
+/**
+ * get_TextureName - Gives the file name a texture is loaded from
+ * @slot: Index of the texture
+ * Return: File name, without its directory
+ */
+const char *get_TextureName(int slot)
+{
+	return (textureNames[slot]);
+}
+
+/**
+ * get_TextureSlot - Looks up the texture a file name is loaded into
+ * @name: File name, without its directory
+ * Return: Index of the texture, or -1 if no texture uses the name
+ */
+int get_TextureSlot(const char *name)
+{
+	int slot;
+
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+		if (strcmp(name, textureNames[slot]) == 0)
+			return (slot);
+	return (-1);
+}
+
+/**
+ * load_TextureSlot - Decodes the file of one texture
+ * @dir: Directory holding the texture files
+ * @slot: Index of the texture
+ * @texels: Receives the xRGB texels of the texture
+ * Return: true on success, false if the file could not be decoded
+ */
+bool load_TextureSlot(const char *dir, int slot,
+		uint32_t texels[TEXTURE_HEIGHT][TEXTURE_WIDTH])
+{
+	char path[512];
+	SDL_Surface *surface;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, textureNames[slot]);
+	surface = IMG_Load(path);
+	if (surface == NULL)
+	{
+		fprintf(stderr, "Failed to load texture %d: %s\n", slot, IMG_GetError());
+		return (false);
+	}
+	extract_TexturePixels(surface, texels);
+	SDL_FreeSurface(surface);
+	return (true);
+}
+
 /**
  * loadTextures - loads textures into SDL surfaces
  * @parsedOrigin: array to store loaded textures
  * Return: true if all textures were loaded successfully, false otherwise
  */
-int loadTextures(SDL_Surface *parsedOrigin[])
+bool loadTextures(SDL_Surface *parsedOrigin[])
 {
 	int i, n;
-	const char *textureFiles[TEXTURE_COUNT] = {
-		"assets/textures/brick_1.jpg",
-		"assets/textures/brick_2.jpg",
-		"assets/textures/brick_3.jpg",
-		"assets/textures/brick_4.jpg",
-		"assets/textures/floor.jpg",
-		"assets/textures/ceiling.jpg"
-	};
+	char path[512];
 
 	for (n = 0; n < TEXTURE_COUNT; n++)
 	{
-		parsedOrigin[n] = IMG_Load(textureFiles[n]);
+		snprintf(path, sizeof(path), "%s/%s", TEXTURE_DIR, textureNames[n]);
+		parsedOrigin[n] = IMG_Load(path);
 		if (parsedOrigin[n] == NULL)
 		{
 			fprintf(stderr, "Failed to load texture %d: %s\n", n, IMG_GetError());
@@ -91,9 +228,7 @@ bool loadMapTextures(GameState *state)
 		return (false);
 	}
 
-	extract_Pixels(state, parsedOrigin);
-
-	return (true);
+	return (extract_Pixels(state, parsedOrigin));
 }
 
 /**
@@ -107,40 +242,75 @@ bool loadMapTextures(GameState *state)
  *
  * Return: The calculated environment pixel position
  */
-point_t get_EnvPixelPosition(SDL_Point mapPos, point_t rayDir, double wallX,
+vec_t get_EnvPixelPosition(SDL_Point mapPos, vec_t rayDir, real_t wallX,
 int wallSide)
 {
-	point_t envPixelPos;
+	vec_t envPixelPos;
 
 	if (wallSide == 0 && rayDir.x > 0)
 	{
-		envPixelPos.x = mapPos.x;
-		envPixelPos.y = mapPos.y + wallX;
+		envPixelPos.x = REAL_FROM_INT(mapPos.x);
+		envPixelPos.y = REAL_FROM_INT(mapPos.y) + wallX;
 	}
 	else if (wallSide == 0 && rayDir.x < 0)
 	{
-		envPixelPos.x = mapPos.x + 1.0;
-		envPixelPos.y = mapPos.y + wallX;
+		envPixelPos.x = REAL_FROM_INT(mapPos.x + 1);
+		envPixelPos.y = REAL_FROM_INT(mapPos.y) + wallX;
 	}
 	else if (wallSide == 1 && rayDir.y > 0)
 	{
-		envPixelPos.x = mapPos.x + wallX;
-		envPixelPos.y = mapPos.y;
+		envPixelPos.x = REAL_FROM_INT(mapPos.x) + wallX;
+		envPixelPos.y = REAL_FROM_INT(mapPos.y);
 	}
 	else
 	{
-		envPixelPos.x = mapPos.x + wallX;
-		envPixelPos.y = mapPos.y + 1.0;
+		envPixelPos.x = REAL_FROM_INT(mapPos.x) + wallX;
+		envPixelPos.y = REAL_FROM_INT(mapPos.y + 1);
 	}
 
 	return (envPixelPos);
 }
 
+static real_t envRowDistance[SCREEN_HEIGHT];
+static const uint8_t unlitRowLevel[SCREEN_HEIGHT];
+
+/**
+ * init_EnvRows - Fills the table of camera distances to the floor seen on
+ * each screen row below the horizon, which only depend on the screen size.
+ * Must be called before cast_EnvTextures; later calls do nothing.
+ *
+ * Return: void
+ */
+void init_EnvRows(void)
+{
+	int y;
+
+	if (envRowDistance[SCREEN_HEIGHT - 1] != 0)
+		return;
+	for (y = SCREEN_HEIGHT / 2 + 1; y < SCREEN_HEIGHT; y++)
+		envRowDistance[y] = REAL(SCREEN_HEIGHT / (2.0 * y - SCREEN_HEIGHT));
+}
+
+/**
+ * get_EnvRows - Gives the tables cast_EnvTextures shades and places the
+ * floor and ceiling of each screen row with
+ * @state: Represents a pointer to the Game structure
+ * @rowLevel: Receives the shade level of each row
+ *
+ * Return: Camera distance to the floor seen on each row below the horizon
+ */
+const real_t *get_EnvRows(const GameState *state, const uint8_t **rowLevel)
+{
+	*rowLevel = state->lighting ? state->lighting->rowLevel : unlitRowLevel;
+	return (envRowDistance);
+}
+
 /**
  * cast_EnvTextures - Responsible for rendering the environment texture
  * based on the player's position
  * @state: Represents a pointer to the Game structure
  * @mapPos: Represents the position of the map in the state
+ * @rayPos: Represents the position of the camera
  * @rayDir: Represents the direction of the ray
  * @distToWall: Represents the distance from the player to the wall
  * @wallX: Represents the X-coordinate of the wall intersection
@@ -151,46 +321,38 @@ int wallSide)
  *
  * Return: void
  */
-void cast_EnvTextures(GameState *state, SDL_Point mapPos, point_t rayDir,
-		double distToWall, double wallX, int drawEnd, int col, int wallSide)
+void cast_EnvTextures(GameState *state, SDL_Point mapPos, vec_t rayPos,
+		vec_t rayDir, real_t distToWall, real_t wallX, int drawEnd, int col,
+		int wallSide)
 {
-
-	point_t envPixelPos = get_EnvPixelPosition(mapPos, rayDir, wallX, wallSide);
-	point_t currentEnvPixel;
+	vec_t envPixelPos = get_EnvPixelPosition(mapPos, rayDir, wallX, wallSide);
+	vec_t currentEnvPixel, toWall;
 	SDL_Point txPos;
-	double weight, currentDist;
-	int y, textureIndex;
+	real_t weight, inverseDist;
+	const uint8_t *rowLevel = state->lighting ? state->lighting->rowLevel :
+		unlitRowLevel;
+	pixel_t (*shade)[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	int y;
 
-	textureIndex = wallSide == 0 ? 0 : 1;
 	if (drawEnd < 0)
 		drawEnd = SCREEN_HEIGHT;
+	inverseDist = REAL_DIV(REAL_ONE, distToWall);
+	toWall.x = envPixelPos.x - rayPos.x;
+	toWall.y = envPixelPos.y - rayPos.y;
 
 	for (y = drawEnd + 1; y < SCREEN_HEIGHT; y++)
 	{
-		currentDist = SCREEN_HEIGHT / (2.0 * y - SCREEN_HEIGHT);
-		weight = currentDist / distToWall;
-
-		currentEnvPixel.x = weight * envPixelPos.x +
-			(1.0 - weight) * state->position.x;
-		currentEnvPixel.y = weight * envPixelPos.y +
-			(1.0 - weight) * state->position.y;
+		weight = REAL_MUL(envRowDistance[y], inverseDist);
 
-		txPos.x = (int)(currentEnvPixel.x * TEXTURE_WIDTH) % TEXTURE_WIDTH;
-		txPos.y = (int)(currentEnvPixel.y * TEXTURE_HEIGHT) % TEXTURE_HEIGHT;
+		currentEnvPixel.x = rayPos.x + REAL_MUL(weight, toWall.x);
+		currentEnvPixel.y = rayPos.y + REAL_MUL(weight, toWall.y);
 
-		if (txPos.x < 0 || txPos.x >= TEXTURE_WIDTH ||
-		    txPos.y < 0 || txPos.y >= TEXTURE_HEIGHT)
-			continue;
+		txPos.x = real_Floor(REAL_FRAC(currentEnvPixel.x) * TEXTURE_WIDTH);
+		txPos.y = real_Floor(REAL_FRAC(currentEnvPixel.y) * TEXTURE_HEIGHT);
 
-		if (y >= 0 && y < SCREEN_HEIGHT)
-			state->screenBuffer[y][col] = state->tiles[textureIndex][txPos.y][txPos.x];
-		if (SCREEN_HEIGHT - y >= 0 &&
-		    SCREEN_HEIGHT - y < SCREEN_HEIGHT)
-		{
-			state->screenBuffer[SCREEN_HEIGHT - y][col] =
-				state->tiles[5][txPos.y][txPos.x];
-			state->screenBuffer[y][col] =
-				state->tiles[4][txPos.y][txPos.x];
-		}
+		shade = state->shades[rowLevel[y]];
+		state->screenBuffer[SCREEN_HEIGHT - y][col] =
+			shade[5][txPos.y][txPos.x];
+		state->screenBuffer[y][col] = shade[4][txPos.y][txPos.x];
 	}
 }
@@ -20,6 +20,7 @@ void printGameState(GameState *state)
 	printf("Player Plane: (%f, %f)\n", state->viewPlane.x, state->viewPlane.y);
 	printf("Time: %f\n", state->time);
 	printf("Maze Pointer: %p\n", (void *)state->maze);
+	printf("Maze Size: %d x %d\n", state->mapWidth, state->mapHeight);
 }
 
 /**
@@ -60,18 +61,23 @@ uint32_t get_ColorFromPixel(uint8_t *pixel, SDL_PixelFormat *format)
  * from loaded textures
  * @state: Represents a pointer to the GameState structure
  * @parsedOrigin: Represnts an array of loaded textures
- * Return: Always void
+ * Return: true on success, false if memory ran out
  */
-void extract_Pixels(GameState *state, SDL_Surface * parsedOrigin[])
+bool extract_Pixels(GameState *state, SDL_Surface * parsedOrigin[])
 {
+	uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	bool stored;
 	int i;
 
+	texels = malloc(TEXTURE_COUNT * sizeof(*texels));
 	for (i = 0; i < TEXTURE_COUNT; i++)
 	{
-		extract_TexturePixels(state, parsedOrigin[i], i);
+		if (texels)
+			extract_TexturePixels(parsedOrigin[i], texels[i]);
 		SDL_FreeSurface(parsedOrigin[i]);
 		parsedOrigin[i] = NULL;
 	}
+	stored = texels && set_TexturePixels(state, texels);
+	free(texels);
+	return (stored);
 }
-
-
@@ -0,0 +1,149 @@
+#include "../headers/workers.h"
+
+/**
+ * workers_Work - Takes work items of the current pass until none are left
+ * @worker: Pointer to the worker
+ *
+ * Return: void
+ */
+static void workers_Work(worker_t *worker)
+{
+	workers_t *pool = worker->pool;
+	int index = worker - pool->workers, item;
+
+	while ((item = SDL_AtomicAdd(&pool->next, 1)) < pool->items)
+		pool->work(pool->context, index, item);
+}
+
+/**
+ * workers_Thread - Body of a worker thread: takes part in every pass until
+ * the pool stops
+ * @data: Pointer to the worker
+ *
+ * Return: 0
+ */
+static int workers_Thread(void *data)
+{
+	worker_t *worker = data;
+	workers_t *pool = worker->pool;
+	bool stop;
+
+	for (;;)
+	{
+		SDL_LockMutex(pool->lock);
+		while (worker->generation == pool->generation && !pool->stop)
+			SDL_CondWait(pool->wake, pool->lock);
+		worker->generation = pool->generation;
+		stop = pool->stop;
+		SDL_UnlockMutex(pool->lock);
+		if (stop)
+			return (0);
+		workers_Work(worker);
+		SDL_LockMutex(pool->lock);
+		if (--pool->busy == 0)
+			SDL_CondSignal(pool->done);
+		SDL_UnlockMutex(pool->lock);
+	}
+}
+
+/**
+ * workers_Run - Runs a pass on every thread of the pool and waits until it
+ * is done
+ * @pool: Pointer to the pool
+ * @work: Function doing one item
+ * @context: Context handed to @work
+ * @items: Number of work items
+ *
+ * Return: void
+ */
+void workers_Run(workers_t *pool, workfunc_t work, void *context, int items)
+{
+	SDL_LockMutex(pool->lock);
+	pool->work = work;
+	pool->context = context;
+	pool->items = items;
+	SDL_AtomicSet(&pool->next, 0);
+	pool->busy = pool->threads - 1;
+	pool->generation++;
+	SDL_CondBroadcast(pool->wake);
+	SDL_UnlockMutex(pool->lock);
+	workers_Work(&pool->workers[0]);
+	SDL_LockMutex(pool->lock);
+	while (pool->busy > 0)
+		SDL_CondWait(pool->done, pool->lock);
+	SDL_UnlockMutex(pool->lock);
+}
+
+/**
+ * workers_Create - Starts a worker pool
+ * @threads: Number of threads to work with, the caller included
+ * @name: Name of the threads
+ *
+ * Return: Pointer to the pool, or NULL on failure
+ */
+workers_t *workers_Create(int threads, const char *name)
+{
+	workers_t *pool = calloc(1, sizeof(workers_t));
+	int i;
+
+	if (pool == NULL)
+		return (NULL);
+	pool->threads = threads > 1 ? threads : 1;
+	pool->workers = calloc(pool->threads, sizeof(worker_t));
+	pool->lock = SDL_CreateMutex();
+	pool->wake = SDL_CreateCond();
+	pool->done = SDL_CreateCond();
+	if (pool->workers == NULL || pool->lock == NULL || pool->wake == NULL ||
+	    pool->done == NULL)
+	{
+		pool->threads = 0;
+		workers_Destroy(pool);
+		return (NULL);
+	}
+	for (i = 0; i < pool->threads; i++)
+	{
+		pool->workers[i].pool = pool;
+		if (i > 0)
+			pool->workers[i].thread = SDL_CreateThread(workers_Thread, name,
+				&pool->workers[i]);
+		if (i > 0 && pool->workers[i].thread == NULL)
+		{
+			fprintf(stderr, "Error: Unable to start %s thread %d\n", name, i);
+			pool->threads = i;
+			workers_Destroy(pool);
+			return (NULL);
+		}
+	}
+	return (pool);
+}
+
+/**
+ * workers_Destroy - Stops the threads and frees the pool
+ * @pool: Pointer to the pool, may be NULL
+ *
+ * Return: void
+ */
+void workers_Destroy(workers_t *pool)
+{
+	int i;
+
+	if (pool == NULL)
+		return;
+	if (pool->lock)
+	{
+		SDL_LockMutex(pool->lock);
+		pool->stop = true;
+		SDL_CondBroadcast(pool->wake);
+		SDL_UnlockMutex(pool->lock);
+	}
+	for (i = 1; i < pool->threads; i++)
+		SDL_WaitThread(pool->workers[i].thread, NULL);
+	if (pool->done)
+		SDL_DestroyCond(pool->done);
+	if (pool->wake)
+		SDL_DestroyCond(pool->wake);
+	if (pool->lock)
+		SDL_DestroyMutex(pool->lock);
+	free(pool->workers);
+	free(pool);
+}
@@ -0,0 +1,41 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "../headers/defs.h"
+#include "../headers/mapgen.h"
+
+/**
+ * struct benchmark_s - one entry of the benchmark suite
+ * @name: name used to select the benchmark on the command line
+ * @run: runs the benchmark for a square map of the given size
+ */
+typedef struct benchmark_s
+{
+	const char *name;
+	void (*run)(int size);
+} benchmark_t;
+
+double bench_Seconds(void);
+uint32_t bench_Random(uint32_t *seed);
+int *bench_GenerateMaze(int size, mapstyle_t style, int density);
+SDL_Point bench_RandomOpenCell(const int *maze, int size, uint32_t *seed);
+GameState *bench_CreateState(int *maze, int size);
+void bench_DestroyState(GameState *state);
+void bench_PlaceCamera(GameState *state, uint32_t *seed);
+void bench_Fail(void);
+
+void bench_MapGeneration(int size);
+void bench_Navigation(int size);
+void bench_Visibility(int size);
+void bench_Precision(int size);
+void bench_Render(int size);
+void bench_MapEdits(int size);
+void bench_Reload(int size);
+void bench_Stream(int size);
+void bench_Control(int size);
+void bench_Binning(int size);
+void bench_Crowd(int size);
+void bench_Minimap(int size);
+void bench_Metrics(int size);
+
+#endif
@@ -0,0 +1,257 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+#include "../headers/binning.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define BINNING_POSES 64
+#define BINNING_CHECKS 16
+#define BINNING_CHECK_THREADS 4
+#define BINNING_COUNTERS 2
+
+/**
+ * bench_OpenCounters - Opens the cache miss counters of the process,
+ * disabled: last level misses and L1 data read misses. Threads started
+ * afterwards are counted too, once they have ended.
+ * @fds: Receives a descriptor per counter, -1 where the kernel or the
+ * machine has none (no perf events, or a virtual machine hiding them)
+ *
+ * Return: void
+ */
+static void bench_OpenCounters(int fds[BINNING_COUNTERS])
+{
+#ifdef __linux__
+	struct perf_event_attr attr;
+	int i;
+
+	for (i = 0; i < BINNING_COUNTERS; i++)
+	{
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = i == 0 ? PERF_TYPE_HARDWARE : PERF_TYPE_HW_CACHE;
+		attr.config = i == 0 ? PERF_COUNT_HW_CACHE_MISSES :
+			PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+			PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+		attr.disabled = 1;
+		attr.inherit = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+#else
+	fds[0] = fds[1] = -1;
+#endif
+}
+
+/**
+ * bench_EnableCounters - Starts or stops the counters opened by
+ * bench_OpenCounters
+ * @fds: The counters
+ * @enable: true to start counting, false to stop
+ *
+ * Return: void
+ */
+static void bench_EnableCounters(int fds[BINNING_COUNTERS], bool enable)
+{
+#ifdef __linux__
+	int i;
+
+	for (i = 0; i < BINNING_COUNTERS; i++)
+		if (fds[i] >= 0)
+			ioctl(fds[i], enable ? PERF_EVENT_IOC_ENABLE :
+				PERF_EVENT_IOC_DISABLE, 0);
+#else
+	(void)fds;
+	(void)enable;
+#endif
+}
+
+/**
+ * bench_CloseCounters - Reads and closes the counters opened by
+ * bench_OpenCounters
+ * @fds: The counters
+ * @counts: Receives the count of each counter, or -1 where it is missing
+ *
+ * Return: void
+ */
+static void bench_CloseCounters(int fds[BINNING_COUNTERS],
+		double counts[BINNING_COUNTERS])
+{
+	int i;
+#ifdef __linux__
+	uint64_t value;
+
+	for (i = 0; i < BINNING_COUNTERS; i++)
+	{
+		counts[i] = fds[i] >= 0 && read(fds[i], &value, sizeof(value)) ==
+			sizeof(value) ? (double)value : -1;
+		if (fds[i] >= 0)
+			close(fds[i]);
+	}
+#else
+	(void)fds;
+	for (i = 0; i < BINNING_COUNTERS; i++)
+		counts[i] = -1;
+#endif
+}
+
+/**
+ * bench_BinnedFrames - Renders headless frames from fixed poses, counting
+ * cache misses on every thread rendering
+ * @state: Pointer to the state
+ * @threads: Threads of the binned renderer, 0 for the column path
+ * @misses: Receives the misses per frame of each counter, -1 where the
+ * counter is missing
+ *
+ * Return: Mean frame time in seconds, or 0 on failure
+ */
+static double bench_BinnedFrames(GameState *state, int threads,
+		double misses[BINNING_COUNTERS])
+{
+	uint32_t seed = 521288629u;
+	double start, draw = 0;
+	int fds[BINNING_COUNTERS], pose, i;
+
+	bench_OpenCounters(fds);
+	state->binner = threads ? binner_Create(threads) : NULL;
+	if (threads && state->binner == NULL)
+	{
+		bench_CloseCounters(fds, misses);
+		return (0);
+	}
+	for (pose = 0; pose < BINNING_POSES; pose++)
+	{
+		bench_PlaceCamera(state, &seed);
+		bench_EnableCounters(fds, true);
+		start = bench_Seconds();
+		renderWalls(state, true);
+		draw += bench_Seconds() - start;
+		bench_EnableCounters(fds, false);
+	}
+	binner_Destroy(state->binner);
+	state->binner = NULL;
+	bench_CloseCounters(fds, misses);
+	for (i = 0; i < BINNING_COUNTERS; i++)
+		misses[i] = misses[i] < 0 ? -1 : misses[i] / BINNING_POSES;
+	return (draw / BINNING_POSES);
+}
+
+/**
+ * bench_CompareFrames - Draws frames with the column path onto a cleared
+ * buffer and with the binned renderer onto garbage, and compares them
+ * @state: Pointer to the state
+ * @threads: Threads of the binned renderer
+ *
+ * Return: Number of pixels that differ, or -1 on failure
+ */
+static long bench_CompareFrames(GameState *state, int threads)
+{
+	binner_t *binner = binner_Create(threads);
+	pixel_t *frame = malloc(sizeof(state->screenBuffer));
+	pixel_t *pixels = &state->screenBuffer[0][0];
+	uint32_t seed = 2463534242u;
+	long differ = 0;
+	rayhit_t ray;
+	int pose, x;
+
+	if (binner == NULL || frame == NULL)
+		differ = -1;
+	init_EnvRows();
+	for (pose = 0; differ >= 0 && pose < BINNING_CHECKS; pose++)
+	{
+		bench_PlaceCamera(state, &seed);
+		memset(state->screenBuffer, 0, sizeof(state->screenBuffer));
+		for (x = 0; x < SCREEN_WIDTH; x++)
+			if (castRay(state, x, &ray))
+				drawWallStrips(state, ray.map, ray.position, ray.direction,
+					ray.distance, x, ray.side, true);
+		memcpy(frame, state->screenBuffer, sizeof(state->screenBuffer));
+		memset(state->screenBuffer, 0xA5, sizeof(state->screenBuffer));
+		binner_Render(binner, state);
+		for (x = 0; x < SCREEN_WIDTH * SCREEN_HEIGHT; x++)
+			differ += pixels[x] != frame[x];
+	}
+	binner_Destroy(binner);
+	free(frame);
+	return (differ);
+}
+
+/**
+ * bench_Misses - Formats a miss count per frame
+ * @buffer: Receives the text, at least 16 bytes
+ * @misses: Misses per frame, negative when the counter is missing
+ *
+ * Return: @buffer
+ */
+static const char *bench_Misses(char *buffer, double misses)
+{
+	if (misses < 0)
+		return ("n/a");
+	sprintf(buffer, "%.1fk", misses / 1000.0);
+	return (buffer);
+}
+
+/**
+ * bench_Binning - Compares the binned renderer on one thread and on every
+ * core with the column path: frame time and cache misses per frame, and
+ * checks both draw the same pixels, failing when they do not. The run on
+ * every core is left out on a machine with a single one.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Binning(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	int cores = SDL_GetCPUCount() > 1 ? SDL_GetCPUCount() : 1;
+	double direct, single, all, missDirect[BINNING_COUNTERS];
+	double missSingle[BINNING_COUNTERS], missAll[BINNING_COUNTERS];
+	char text[6][16], allText[32];
+	long differ;
+
+	if (state)
+		state->lighting = lighting_Create(maze, size, size, NULL, 0, 1, 24);
+	if (state && state->lighting)
+	{
+		differ = bench_CompareFrames(state, BINNING_CHECK_THREADS);
+		direct = bench_BinnedFrames(state, 0, missDirect);
+		single = bench_BinnedFrames(state, 1, missSingle);
+		if (cores > 1)
+		{
+			all = bench_BinnedFrames(state, cores, missAll);
+			sprintf(allText, "%.2f ms on %d cores", all * 1000.0, cores);
+		}
+		else
+		{
+			missAll[0] = missAll[1] = -1;
+			strcpy(allText, "no run on every core (1 core)");
+		}
+		printf("binning %s %dx%d: %dx%d tiles of %zu KB, %d per frame; "
+			"frame %.2f ms column path, %.2f ms binned on 1 thread (%+.1f%%), "
+			"%s; cache misses per frame %s / %s / %s, L1D read misses %s / "
+			"%s / %s; %ld pixels differ in %d frames%s\n", PIXEL_FORMAT, size,
+			size, BIN_WIDTH, (int)BIN_ROWS * 2,
+			2 * sizeof(((bintile_t *)0)->bottom) / 1024,
+			(int)(BIN_STRIPS * BIN_BANDS), direct * 1000.0, single * 1000.0,
+			100.0 * (single - direct) / direct, allText,
+			bench_Misses(text[0], missDirect[0]),
+			bench_Misses(text[1], missSingle[0]),
+			bench_Misses(text[2], missAll[0]),
+			bench_Misses(text[3], missDirect[1]),
+			bench_Misses(text[4], missSingle[1]),
+			bench_Misses(text[5], missAll[1]), differ, BINNING_CHECKS,
+			differ ? " FAIL" : "");
+		if (differ)
+			bench_Fail();
+	}
+	if (state)
+		lighting_Destroy(state->lighting);
+	bench_DestroyState(state);
+	free(maze);
+}
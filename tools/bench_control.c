@@ -0,0 +1,284 @@
+#include "bench.h"
+#include "../headers/control.h"
+#include "../headers/player.h"
+#include "../headers/raycast.h"
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define CONTROL_INSTANCES 64
+#define CONTROL_ROUND_TRIPS 20000
+#define CONTROL_FRAME_TRIPS 64
+#define CONTROL_TRACES 64
+#define CONTROL_TRACE_RAYS 256
+#define CONTROL_FLEET_ROUNDS 500
+#define CONTROL_FRAME_ROUNDS 4
+#define CONTROL_CONNECT_TIMEOUT 10.0
+
+/**
+ * struct controlfleet_s - game instances of the benchmark and their clients
+ * @dir: temporary directory holding the sockets
+ * @pids: process of each instance
+ * @clients: connection to each instance
+ * @count: number of instances started
+ */
+typedef struct controlfleet_s
+{
+	char dir[32];
+	pid_t pids[CONTROL_INSTANCES];
+	controlclient_t *clients[CONTROL_INSTANCES];
+	int count;
+} controlfleet_t;
+
+/**
+ * bench_ServeInstance - Body of an instance process: a headless game
+ * driven by its control socket, the way mazzerre -c socket -H runs it
+ * @maze: Pointer to the square maze, shared with the parent
+ * @size: Number of cells along each side
+ * @path: Path of the socket
+ * @seed: Seed of the starting camera
+ *
+ * Return: never returns
+ */
+static void bench_ServeInstance(int *maze, int size, const char *path,
+		uint32_t seed)
+{
+	GameState *state = bench_CreateState(maze, size);
+
+	if (state)
+	{
+		bench_PlaceCamera(state, &seed);
+		state->control = control_Start(path);
+	}
+	while (state && state->control && !state->quit)
+	{
+		if (state->control->render)
+			renderWalls(state, true);
+		handlePlayerMovement(state);
+	}
+	if (state)
+		control_Stop(state->control);
+	bench_DestroyState(state);
+	_exit(0);
+}
+
+/**
+ * bench_StartFleet - Starts the instances and connects to each of them
+ * @fleet: Receives the instances, count set to 0 by the caller
+ * @maze: Pointer to the square maze
+ * @size: Number of cells along each side
+ *
+ * Return: true on success, false on failure
+ */
+static bool bench_StartFleet(controlfleet_t *fleet, int *maze, int size)
+{
+	double start;
+	char path[64];
+	int i;
+
+	strcpy(fleet->dir, "/tmp/mazecontrol.XXXXXX");
+	if (mkdtemp(fleet->dir) == NULL)
+		return (false);
+	fflush(stdout);
+	for (i = 0; i < CONTROL_INSTANCES; i++)
+	{
+		sprintf(path, "%s/%d", fleet->dir, i);
+		fleet->pids[i] = fork();
+		if (fleet->pids[i] == 0)
+			bench_ServeInstance(maze, size, path, 2654435761u + i);
+		if (fleet->pids[i] < 0)
+			return (false);
+		fleet->clients[i] = NULL;
+		fleet->count++;
+	}
+	start = bench_Seconds();
+	for (i = 0; i < fleet->count; i++)
+	{
+		sprintf(path, "%s/%d", fleet->dir, i);
+		while ((fleet->clients[i] = control_Connect(path)) == NULL &&
+		       bench_Seconds() - start < CONTROL_CONNECT_TIMEOUT)
+			SDL_Delay(1);
+		if (fleet->clients[i] == NULL)
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * bench_StopFleet - Ends the instances and removes their sockets
+ * @fleet: The instances
+ *
+ * Return: void
+ */
+static void bench_StopFleet(controlfleet_t *fleet)
+{
+	char path[64];
+	int i;
+
+	for (i = 0; i < fleet->count; i++)
+	{
+		if (fleet->clients[i] == NULL || control_Request(fleet->clients[i],
+		    CONTROL_QUIT, NULL, 0, NULL, 0) != CONTROL_OK)
+			kill(fleet->pids[i], SIGTERM);
+		control_Disconnect(fleet->clients[i]);
+		waitpid(fleet->pids[i], NULL, 0);
+		sprintf(path, "%s/%d", fleet->dir, i);
+		unlink(path);
+	}
+	if (fleet->count)
+		rmdir(fleet->dir);
+}
+
+/**
+ * bench_RoundTrips - Steps one instance and waits for each step in turn
+ * @client: Connection to the instance
+ * @steps: Number of steps
+ * @render: true to have a frame rendered for each step
+ * @longest: Receives the longest round trip, in seconds
+ *
+ * Return: Mean round trip in seconds, or 0 on failure
+ */
+static double bench_RoundTrips(controlclient_t *client, int steps,
+		bool render, double *longest)
+{
+	uint32_t seed = 88172645u;
+	double start = bench_Seconds(), trip, total = 0;
+	controlstate_t state;
+	int i;
+
+	*longest = 0;
+	for (i = 0; i < steps; i++)
+	{
+		if (!control_Step(client, bench_Random(&seed) & (INPUT_FORWARD |
+		    INPUT_TURN_RIGHT), 16, render, &state) ||
+		    (render && control_Slot(client, &state) == NULL))
+			return (0);
+		trip = bench_Seconds() - start;
+		start += trip;
+		total += trip;
+		*longest = trip > *longest ? trip : *longest;
+	}
+	return (total / steps);
+}
+
+/**
+ * bench_Traces - Traces batches of random segments against the maze
+ * @client: Connection to the instance
+ * @size: Number of cells along each side
+ *
+ * Return: Segments traced per second, or 0 on failure
+ */
+static double bench_Traces(controlclient_t *client, int size)
+{
+	controlray_t rays[CONTROL_TRACE_RAYS];
+	controlhit_t hits[CONTROL_TRACE_RAYS];
+	uint32_t seed = 521288629u;
+	double start, angle;
+	int i, r;
+
+	start = bench_Seconds();
+	for (i = 0; i < CONTROL_TRACES; i++)
+	{
+		for (r = 0; r < CONTROL_TRACE_RAYS; r++)
+		{
+			angle = (bench_Random(&seed) % 3600) * M_PI / 1800.0;
+			rays[r].from.x = bench_Random(&seed) % size + 0.5;
+			rays[r].from.y = bench_Random(&seed) % size + 0.5;
+			rays[r].to.x = rays[r].from.x + 32 * cos(angle);
+			rays[r].to.y = rays[r].from.y + 32 * sin(angle);
+		}
+		if (control_Request(client, CONTROL_TRACE, rays, sizeof(rays), hits,
+		    sizeof(hits)) != CONTROL_OK)
+			return (0);
+	}
+	return (CONTROL_TRACES * CONTROL_TRACE_RAYS / (bench_Seconds() - start));
+}
+
+/**
+ * bench_FleetSteps - Steps every instance at once: a step is posted to
+ * each, then all the replies are collected, for a number of rounds
+ * @fleet: The instances
+ * @rounds: Number of rounds
+ * @render: true to have a frame rendered for each step
+ * @blocked: Receives the number of steps a wall stopped
+ *
+ * Return: Steps per second across the instances, or 0 on failure
+ */
+static double bench_FleetSteps(controlfleet_t *fleet, int rounds,
+		bool render, int *blocked)
+{
+	controlstep_t step = {0, 0, 16};
+	uint32_t seed = 2463534242u;
+	double start = bench_Seconds();
+	controlheader_t header;
+	controlstate_t state;
+	int round, i;
+
+	*blocked = 0;
+	step.render = render;
+	for (round = 0; round < rounds; round++)
+	{
+		for (i = 0; i < fleet->count; i++)
+		{
+			step.input = bench_Random(&seed) & (INPUT_FORWARD |
+				INPUT_STRAFE | INPUT_TURN_LEFT);
+			if (!control_Post(fleet->clients[i], CONTROL_STEP, &step,
+			    sizeof(step)))
+				return (0);
+		}
+		for (i = 0; i < fleet->count; i++)
+		{
+			if (!control_Wait(fleet->clients[i], &header, &state,
+			    sizeof(state)) || header.status != CONTROL_OK ||
+			    (render && control_Slot(fleet->clients[i], &state) == NULL))
+				return (0);
+			*blocked += state.blocked != 0;
+		}
+	}
+	return ((double)rounds * fleet->count / (bench_Seconds() - start));
+}
+
+/**
+ * bench_Control - Measures the control socket: round trip of a step with
+ * and without a frame, traced segments per second, and steps and frames
+ * per second across CONTROL_INSTANCES instances driven at once
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Control(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	controlfleet_t fleet;
+	double trip, tripMax, frame, frameMax, rays, steps, frames;
+	int blocked, unused;
+
+	fleet.count = 0;
+	if (maze && bench_StartFleet(&fleet, maze, size))
+	{
+		trip = bench_RoundTrips(fleet.clients[0], CONTROL_ROUND_TRIPS, false,
+			&tripMax);
+		frame = bench_RoundTrips(fleet.clients[0], CONTROL_FRAME_TRIPS, true,
+			&frameMax);
+		rays = bench_Traces(fleet.clients[0], size);
+		steps = bench_FleetSteps(&fleet, CONTROL_FLEET_ROUNDS, false,
+			&blocked);
+		frames = bench_FleetSteps(&fleet, CONTROL_FRAME_ROUNDS, true, &unused);
+		if (trip > 0 && frame > 0 && rays > 0 && steps > 0 && frames > 0)
+			printf("control %s %dx%d: step %.1f us mean / %.1f us longest "
+				"round trip, %.2f ms / %.2f ms with a frame, %.1f Mray/s "
+				"traced; %d instances: %.0f steps/s (%d of %d blocked), %.0f "
+				"frames/s\n", PIXEL_FORMAT, size, size, trip * 1e6,
+				tripMax * 1e6, frame * 1000.0, frameMax * 1000.0, rays / 1e6,
+				fleet.count, steps, blocked, fleet.count * CONTROL_FLEET_ROUNDS,
+				frames);
+		else
+			fprintf(stderr, "control %dx%d: an instance stopped answering\n",
+				size, size);
+	}
+	else if (maze)
+		fprintf(stderr, "control %dx%d: unable to start %d instances\n", size,
+			size, CONTROL_INSTANCES);
+	bench_StopFleet(&fleet);
+	free(maze);
+}
@@ -0,0 +1,170 @@
+#include "bench.h"
+#include "../headers/crowd.h"
+#include "../headers/navigation.h"
+
+#define CROWD_UPDATES (1 << 21)
+#define CROWD_MIN_TICKS 4
+#define CROWD_SPEED 1.5
+#define CROWD_TICK (1.0 / 60)
+#define CROWD_CHECK_THREADS 4
+#define CROWD_RUNS 3
+
+/**
+ * bench_Wander - Gives an agent a random heading at CROWD_SPEED
+ * @crowd: Pointer to the crowd
+ * @i: Index of the agent
+ * @seed: Pointer to the generator state
+ *
+ * Return: void
+ */
+static void bench_Wander(crowd_t *crowd, int i, uint32_t *seed)
+{
+	double angle = (bench_Random(seed) % 3600) * M_PI / 1800.0;
+
+	crowd->vx[i] = CROWD_SPEED * cos(angle);
+	crowd->vy[i] = CROWD_SPEED * sin(angle);
+}
+
+/**
+ * bench_FillCrowd - Creates a crowd of wandering agents, each standing in
+ * a random open cell
+ * @maze: Pointer to the square maze
+ * @size: Number of cells along each side
+ * @agents: Number of agents
+ * @threads: Number of threads to update with
+ *
+ * Return: Pointer to the crowd, or NULL on failure
+ */
+static crowd_t *bench_FillCrowd(const int *maze, int size, int agents,
+		int threads)
+{
+	crowd_t *crowd = crowd_Create(maze, size, size, agents, threads);
+	uint32_t seed = 88172645u;
+	SDL_Point cell;
+	int i;
+
+	while (crowd && crowd->count < agents)
+	{
+		cell = bench_RandomOpenCell(maze, size, &seed);
+		i = crowd_Add(crowd, cell.x + 0.5, cell.y + 0.5,
+			0.2 + bench_Random(&seed) % 16 / 100.0);
+		if (i >= 0)
+			bench_Wander(crowd, i, &seed);
+	}
+	return (crowd);
+}
+
+/**
+ * bench_InWall - Tells whether an agent overlaps a wall cell
+ * @crowd: Pointer to the crowd
+ * @i: Index of the agent
+ *
+ * Return: true if the agent is deeper than 1e-9 cells into a wall
+ */
+static bool bench_InWall(const crowd_t *crowd, int i)
+{
+	double r = crowd->radius[i] - 1e-9, qx, qy;
+	int cx, cy;
+
+	for (cx = (int)floor(crowd->x[i] - r); cx <= crowd->x[i] + r; cx++)
+		for (cy = (int)floor(crowd->y[i] - r); cy <= crowd->y[i] + r; cy++)
+		{
+			qx = fmin(fmax(crowd->x[i], cx), cx + 1) - crowd->x[i];
+			qy = fmin(fmax(crowd->y[i], cy), cy + 1) - crowd->y[i];
+			if (!nav_IsWalkable(crowd->maze, crowd->width, crowd->height, cx,
+			    cy) && qx * qx + qy * qy < r * r)
+				return (true);
+		}
+	return (false);
+}
+
+/**
+ * bench_RunCrowd - Ticks a crowd, turning agents a wall slowed to a new
+ * heading between ticks
+ * @crowd: Pointer to the crowd
+ * @ticks: Number of ticks
+ * @blocked: Receives the share of agent updates a wall slowed
+ *
+ * Return: Agent updates per second, counting the update time only
+ */
+static double bench_RunCrowd(crowd_t *crowd, int ticks, double *blocked)
+{
+	uint32_t seed = 521288629u;
+	double start, time = 0;
+	long slowed = 0;
+	int tick, i;
+
+	for (tick = 0; tick < ticks; tick++)
+	{
+		start = bench_Seconds();
+		crowd_Update(crowd, CROWD_TICK);
+		time += bench_Seconds() - start;
+		for (i = 0; i < crowd->count; i++)
+			if (crowd->blocked[i])
+			{
+				slowed++;
+				bench_Wander(crowd, i, &seed);
+			}
+	}
+	*blocked = (double)slowed / ((double)ticks * crowd->count);
+	return ((double)ticks * crowd->count / time);
+}
+
+/**
+ * bench_Crowd - Measures crowd updates of 10k, 100k and 1M agents on one
+ * thread and on every core, and checks that no agent ends up in a wall
+ * and that the thread count does not change the result. The check also
+ * runs on CROWD_CHECK_THREADS threads, so that it splits the agents even
+ * on a single core. Fails when a check does not hold.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Crowd(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	int cores = SDL_GetCPUCount() > 1 ? SDL_GetCPUCount() : 1;
+	int threads[CROWD_RUNS] = {1, cores, CROWD_CHECK_THREADS};
+	crowd_t *crowds[CROWD_RUNS];
+	double rates[CROWD_RUNS], blocked[CROWD_RUNS];
+	int agents, ticks, inWall, run, i;
+	bool created, same;
+
+	for (agents = 10000; maze && agents <= 1000000 &&
+	     agents <= (long)size * size / 8; agents *= 10)
+	{
+		ticks = CROWD_UPDATES / agents > CROWD_MIN_TICKS ?
+			CROWD_UPDATES / agents : CROWD_MIN_TICKS;
+		for (run = 0, created = true; run < CROWD_RUNS; run++)
+		{
+			crowds[run] = bench_FillCrowd(maze, size, agents, threads[run]);
+			created = created && crowds[run];
+		}
+		for (run = 0, inWall = 0, same = true; created && run < CROWD_RUNS;
+		     run++)
+		{
+			rates[run] = bench_RunCrowd(crowds[run], ticks, &blocked[run]);
+			for (i = 0; i < agents; i++)
+				inWall += bench_InWall(crowds[run], i);
+			same = same && memcmp(crowds[0]->x, crowds[run]->x,
+				agents * sizeof(double)) == 0 && memcmp(crowds[0]->y,
+				crowds[run]->y, agents * sizeof(double)) == 0;
+		}
+		if (created)
+			printf("crowd %dx%d: %d agents, %d ticks: %.2f M agent-updates/s "
+				"on 1 thread, %.2f M on %d; %.1f%% slowed by walls, %d in "
+				"walls%s, %s on 1, %d and %d threads\n", size, size, agents,
+				ticks, rates[0] / 1e6, rates[1] / 1e6, cores,
+				blocked[0] * 100.0, inWall, inWall ? " FAIL" : "",
+				same ? "same" : "THREADS DIFFER FAIL", cores,
+				CROWD_CHECK_THREADS);
+		else
+			fprintf(stderr, "crowd %dx%d: unable to create %d agents\n",
+				size, size, agents);
+		if (!created || inWall || !same)
+			bench_Fail();
+		for (run = 0; run < CROWD_RUNS; run++)
+			crowd_Destroy(crowds[run]);
+	}
+	free(maze);
+}
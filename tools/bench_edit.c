@@ -0,0 +1,223 @@
+#include "bench.h"
+#include "../headers/mapedit.h"
+#include "../headers/lighting.h"
+#include "../headers/raycast.h"
+
+#define EDIT_DOORS 1024
+#define EDIT_FRAMES 64
+#define EDIT_RECTS 64
+
+/**
+ * bench_EditFrames - Renders frames from random poses, opening or closing
+ * doors before each one the way a running game would
+ * @edit: Pointer to the edit context
+ * @doors: Cells toggled between floor and wall
+ * @editsPerFrame: Number of door toggles before each frame
+ * @editTime: Receives the mean time of one toggle, left alone without any
+ *
+ * Return: Mean time of a frame, edits included, in seconds
+ */
+static double bench_EditFrames(mapedit_t *edit, const SDL_Point *doors,
+		int editsPerFrame, double *editTime)
+{
+	GameState *state = edit->state;
+	uint32_t seed = 2654435761u;
+	double start, editing = 0, total = bench_Seconds();
+	SDL_Rect rects[EDIT_RECTS];
+	SDL_Point door;
+	int frame, i;
+
+	for (frame = 0; frame < EDIT_FRAMES; frame++)
+	{
+		start = bench_Seconds();
+		for (i = 0; i < editsPerFrame; i++)
+		{
+			door = doors[bench_Random(&seed) % EDIT_DOORS];
+			mapedit_SetCell(edit, door.x, door.y,
+				state->maze[door.x * state->mapWidth + door.y] ? 0 : 1);
+		}
+		while (mapedit_TakeDirty(edit, rects, EDIT_RECTS) == EDIT_RECTS)
+			;
+		editing += bench_Seconds() - start;
+		bench_PlaceCamera(state, &seed);
+		renderWalls(state, true);
+	}
+	total = bench_Seconds() - total;
+	if (editsPerFrame > 0)
+		*editTime = editing / ((double)editsPerFrame * EDIT_FRAMES);
+	return (total / EDIT_FRAMES);
+}
+
+/**
+ * bench_Rebuilds - Times rebuilding the derived data of a map from scratch,
+ * what every edit would cost without incremental updates
+ * @state: Pointer to the state, with its lighting
+ * @field: Pointer to the flow field
+ * @pvs: Receives the time of pvs_Build
+ * @nav: Receives the time of nav_BuildFlowField
+ * @light: Receives the time of lighting_Create
+ *
+ * Return: void
+ */
+static void bench_Rebuilds(GameState *state, flowfield_t *field,
+		double *pvs, double *nav, double *light)
+{
+	lighting_t *lighting = state->lighting;
+	uint8_t *data;
+	double start;
+
+	start = bench_Seconds();
+	data = pvs_Build(state->maze, state->mapWidth, state->mapHeight);
+	*pvs = bench_Seconds() - start;
+	free(data);
+	start = bench_Seconds();
+	nav_BuildFlowField(field);
+	*nav = bench_Seconds() - start;
+	start = bench_Seconds();
+	lighting_Destroy(lighting_Create(state->maze, state->mapWidth,
+		state->mapHeight, lighting->lights, lighting->lightCount,
+		lighting->brightness, 24));
+	*light = bench_Seconds() - start;
+}
+
+/**
+ * bench_CheckEdits - Compares the data repaired edit by edit with data
+ * built from scratch on the edited maze
+ * @state: Pointer to the state, with its visibility data and lighting
+ * @field: Pointer to the flow field repaired with the edits
+ * @differ: Receives the number of visibility bounds, light samples and
+ * flow distances that differ, or -1 where a rebuild failed
+ *
+ * Return: void
+ */
+static void bench_CheckEdits(GameState *state, const flowfield_t *field,
+		long differ[3])
+{
+	lighting_t *kept = state->lighting, *fresh;
+	size_t cells = (size_t)state->mapWidth * state->mapHeight, i;
+	flowfield_t *rebuilt;
+	uint8_t *pvs;
+
+	pvs = pvs_Build(state->maze, state->mapWidth, state->mapHeight);
+	fresh = lighting_Create(state->maze, state->mapWidth, state->mapHeight,
+		kept->lights, kept->lightCount, kept->brightness, 24);
+	rebuilt = nav_CreateFlowField(state->maze, state->mapWidth,
+		state->mapHeight, field->goals, field->goalCount);
+	differ[0] = pvs ? 0 : -1;
+	for (i = 0; pvs && i < pvs_Size(state->mapWidth, state->mapHeight); i++)
+		differ[0] += pvs[i] != state->pvs[i];
+	differ[1] = fresh && fresh->blockCount == kept->blockCount ? 0 : -1;
+	for (i = 0; differ[1] >= 0 && i < kept->blockCount * LIGHT_BLOCK_BYTES;
+	     i++)
+		differ[1] += fresh->luxels[i] != kept->luxels[i];
+	differ[2] = rebuilt ? 0 : -1;
+	if (rebuilt)
+		nav_BuildFlowField(rebuilt);
+	for (i = 0; rebuilt && i < cells; i++)
+		differ[2] += rebuilt->dist[i] != field->dist[i];
+	nav_DestroyFlowField(rebuilt);
+	lighting_Destroy(fresh);
+	free(pvs);
+}
+
+/**
+ * bench_Lit - Bakes lights scattered over open cells
+ * @maze: Pointer to a square maze
+ * @size: Number of cells along each side
+ *
+ * Return: Pointer to the lighting, or NULL on failure
+ */
+static lighting_t *bench_Lit(const int *maze, int size)
+{
+	int count = (int)((long)size * size / 1024), i;
+	light_t *lights = malloc(count * sizeof(light_t) + 1);
+	uint32_t seed = 1013904223u;
+	lighting_t *lighting = NULL;
+	SDL_Point cell;
+
+	for (i = 0; lights && i < count; i++)
+	{
+		cell = bench_RandomOpenCell(maze, size, &seed);
+		lights[i].x = cell.x + 0.5;
+		lights[i].y = cell.y + 0.5;
+		lights[i].intensity = 1;
+		lights[i].radius = 6;
+	}
+	if (lights)
+		lighting = lighting_Create(maze, size, size, lights, count, 0.3, 24);
+	free(lights);
+	return (lighting);
+}
+
+/**
+ * bench_MapEdits - Measures frames mixing door toggles and rendering on a
+ * map with visibility data, a flow field and baked lighting, against the
+ * cost of rebuilding that data, then checks the repaired data against a
+ * rebuild
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_MapEdits(int size)
+{
+	static const int editCounts[] = {0, 16, 256, 4096};
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	SDL_Point *doors = malloc(EDIT_DOORS * sizeof(SDL_Point)), goal;
+	flowfield_t *field = NULL;
+	mapedit_t *edit = NULL;
+	double frame, editTime = 0, pvs, nav, light;
+	uint32_t seed = 88172645u;
+	long differ[3];
+	int i;
+
+	if (state && doors)
+	{
+		goal = bench_RandomOpenCell(maze, size, &seed);
+		for (i = 0; i < EDIT_DOORS; i++)
+			do {
+				doors[i] = bench_RandomOpenCell(maze, size, &seed);
+			} while (doors[i].x == goal.x && doors[i].y == goal.y);
+		state->pvs = pvs_Build(maze, size, size);
+		state->lighting = bench_Lit(maze, size);
+		field = nav_CreateFlowField(maze, size, size, &goal, 1);
+	}
+	if (field && state->pvs && state->lighting)
+	{
+		nav_BuildFlowField(field);
+		edit = mapedit_Create(state);
+	}
+	if (edit && mapedit_AddFlowField(edit, field))
+	{
+		bench_Rebuilds(state, field, &pvs, &nav, &light);
+		printf("edit %dx%d: rebuild pvs %.1f ms, flow field %.1f ms, "
+			"lighting %.1f ms\n", size, size, pvs * 1000.0, nav * 1000.0,
+			light * 1000.0);
+		for (i = 0; i < (int)(sizeof(editCounts) / sizeof(editCounts[0])); i++)
+		{
+			frame = bench_EditFrames(edit, doors, editCounts[i], &editTime);
+			printf("edit %dx%d: %4d edits/frame, frame %.2f ms, %.2f us/edit "
+				"(%.0f edits/s)\n", size, size, editCounts[i], frame * 1000.0,
+				editCounts[i] ? editTime * 1e6 : 0.0,
+				editCounts[i] ? 1 / editTime : 0.0);
+		}
+		bench_CheckEdits(state, field, differ);
+		printf("edit %dx%d: after the edits, %ld of %ld pvs bounds, %ld of "
+			"%lu light samples and %ld of %ld flow distances differ from a "
+			"rebuild\n", size, size, differ[0], (long)pvs_Size(size, size),
+			differ[1], (unsigned long)state->lighting->
+			blockCount * LIGHT_BLOCK_BYTES, differ[2], (long)size * size);
+		if (differ[0] != 0 || differ[1] != 0 || differ[2] != 0)
+			bench_Fail();
+	}
+	mapedit_Destroy(edit);
+	nav_DestroyFlowField(field);
+	if (state)
+	{
+		lighting_Destroy(state->lighting);
+		free(state->pvs);
+	}
+	free(doors);
+	bench_DestroyState(state);
+	free(maze);
+}
@@ -0,0 +1,40 @@
+#include "bench.h"
+#include "../headers/map.h"
+
+#define MAPGEN_BENCH_FILE "mazebench_map.tmp"
+
+/**
+ * bench_MapGeneration - Times streaming every map style to disk and
+ * loading it back with readMapFromFile
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_MapGeneration(int size)
+{
+	static const char * const names[] = {"perfect", "cavern", "corridor"};
+	static const int densities[] = {100, 45, 98};
+	mapgen_t options = {0, 0, MAPGEN_PERFECT, 0, 2463534242u};
+	double generated, loaded;
+	int style, *maze, width, height;
+
+	options.width = size;
+	options.height = size;
+	for (style = MAPGEN_PERFECT; style <= MAPGEN_CORRIDOR; style++)
+	{
+		options.style = style;
+		options.density = densities[style];
+		generated = bench_Seconds();
+		if (!generateMapToFile(&options, MAPGEN_BENCH_FILE))
+			break;
+		generated = bench_Seconds() - generated;
+		loaded = bench_Seconds();
+		maze = readMapFromFile(MAPGEN_BENCH_FILE, &width, &height);
+		loaded = bench_Seconds() - loaded;
+		printf("mapgen %dx%d %s: generate %.1f ms, load %.1f ms%s\n",
+			size, size, names[style], generated * 1000.0, loaded * 1000.0,
+			maze == NULL ? " (load failed)" : "");
+		free(maze);
+	}
+	remove(MAPGEN_BENCH_FILE);
+}
@@ -0,0 +1,133 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+#include "../headers/metrics.h"
+
+#define METRICS_RECORDS 10000000
+#define METRICS_ROUNDS 8
+#define METRICS_FRAMES 16
+#define METRICS_CONFIGS 3
+#define METRICS_BENCH_PERIOD 10
+#define METRICS_MARKS 1000000
+#define METRICS_REPORTS 10000
+#define METRICS_BOUND 1.0
+
+/**
+ * bench_MetricFrames - Renders headless frames, marking them the way
+ * runGameLoop does
+ * @state: Pointer to the state, with or without metrics
+ * @seed: Seed of the camera poses
+ *
+ * Return: Mean frame time in seconds
+ */
+static double bench_MetricFrames(GameState *state, uint32_t seed)
+{
+	double start = bench_Seconds();
+	int frame;
+
+	for (frame = 0; frame < METRICS_FRAMES; frame++)
+	{
+		metrics_FrameStart(state->metrics);
+		bench_PlaceCamera(state, &seed);
+		renderWalls(state, true);
+		metrics_Input(state->metrics);
+	}
+	return ((bench_Seconds() - start) / METRICS_FRAMES);
+}
+
+/**
+ * bench_MetricWork - Times the work the metrics add to a frame, on metrics
+ * without a reporter thread: the four marks of a frame, and formatting
+ * the JSON line of a report
+ * @report: Receives the time to format a report, in seconds
+ *
+ * Return: Time of the marks of one frame in seconds, or -1 on failure
+ */
+static double bench_MetricWork(double *report)
+{
+	metrics_t *metrics = metrics_Create(NULL, 0);
+	char line[METRICS_JSON];
+	double marks;
+	int i;
+
+	if (metrics == NULL)
+		return (-1);
+	marks = bench_Seconds();
+	for (i = 0; i < METRICS_MARKS; i++)
+	{
+		metrics_FrameStart(metrics);
+		metrics_Input(metrics);
+		metrics_UploadStart(metrics);
+		metrics_Presented(metrics);
+	}
+	marks = (bench_Seconds() - marks) / METRICS_MARKS;
+	*report = bench_Seconds();
+	for (i = 0; i < METRICS_REPORTS; i++)
+		metrics_Format(metrics, line, sizeof(line));
+	*report = (bench_Seconds() - *report) / METRICS_REPORTS;
+	metrics_Destroy(metrics);
+	return (marks);
+}
+
+/**
+ * bench_Metrics - Measures the cost of the frame metrics: one record, and
+ * headless frames without metrics, with metrics reported to /dev/null
+ * every METRICS_BENCH_PERIOD ms, and with the overlay too. A few percent
+ * of noise hides the difference between the first two, so the marks of a
+ * frame and the formatting of a report are also timed on their own, and
+ * the run fails when they add more than METRICS_BOUND percent to a frame
+ * without metrics, reporting every METRICS_PERIOD ms.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Metrics(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	metrics_t *metrics = state ? metrics_Create("/dev/null",
+		METRICS_BENCH_PERIOD) : NULL;
+	double record, best[METRICS_CONFIGS], frame, marks, report, overhead;
+	int round, config, i;
+
+	if (metrics == NULL)
+	{
+		bench_DestroyState(state);
+		free(maze);
+		return;
+	}
+	record = bench_Seconds();
+	for (i = 0; i < METRICS_RECORDS; i++)
+		metrics_Record(metrics, METRIC_RENDER, i & 0xFFFFF);
+	record = (bench_Seconds() - record) / METRICS_RECORDS;
+	/* Rounds take turns so that a slow spell of the machine hits all */
+	for (round = 0; round < METRICS_ROUNDS; round++)
+		for (config = 0; config < METRICS_CONFIGS; config++)
+		{
+			state->metrics = config ? metrics : NULL;
+			metrics->overlay = config == 2;
+			frame = bench_MetricFrames(state, 88172645u + round);
+			if (round == 0 || frame < best[config])
+				best[config] = frame;
+		}
+	state->metrics = NULL;
+	metrics_Destroy(metrics);
+	marks = bench_MetricWork(&report);
+	overhead = (marks + report * best[0] * 1000.0 / METRICS_PERIOD) /
+		best[0] * 100.0;
+	printf("metrics %s %dx%d: %.1f ns per record; frame %.3f ms without "
+		"metrics, %.3f ms with them (%+.2f%%) reported every %d ms, %.3f ms "
+		"with the overlay\n", PIXEL_FORMAT, size, size, record * 1e9,
+		best[0] * 1000.0, best[1] * 1000.0,
+		(best[1] / best[0] - 1) * 100.0, METRICS_BENCH_PERIOD,
+		best[2] * 1000.0);
+	if (marks >= 0)
+		printf("metrics %s %dx%d: marks %.0f ns a frame, report %.1f us "
+			"every %d ms, %.4f%% of a frame (bound %.0f%%)%s\n",
+			PIXEL_FORMAT, size, size, marks * 1e9, report * 1e6,
+			METRICS_PERIOD, overhead, METRICS_BOUND,
+			overhead > METRICS_BOUND ? " FAIL" : "");
+	if (marks < 0 || overhead > METRICS_BOUND)
+		bench_Fail();
+	bench_DestroyState(state);
+	free(maze);
+}
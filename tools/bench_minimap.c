@@ -0,0 +1,177 @@
+#include "bench.h"
+#include "../headers/minimap.h"
+#include "../headers/mapedit.h"
+
+#define MINIMAP_FRAMES 256
+#define MINIMAP_ZOOMS 4
+#define MINIMAP_EDITS 256
+#define MINIMAP_RECTS 64
+
+/**
+ * bench_Walk - Moves the player one frame along a straight walk that
+ * crosses the map; walls do not matter to the minimap
+ * @state: Pointer to the state
+ * @frame: Number of the frame
+ *
+ * Return: void
+ */
+static void bench_Walk(GameState *state, int frame)
+{
+	double angle = frame * 0.004;
+
+	state->position.x = state->mapHeight / 2.0 + frame * 0.04;
+	state->position.y = state->mapWidth / 2.0 + frame * 0.03;
+	state->direction.x = cos(angle);
+	state->direction.y = sin(angle);
+	state->viewPlane.x = -0.66 * sin(angle);
+	state->viewPlane.y = 0.66 * cos(angle);
+}
+
+/**
+ * bench_MinimapFrames - Draws the minimap during a walk
+ * @minimap: Pointer to the minimap, already shown once
+ * @state: Pointer to the state
+ * @redraw: true to throw the layer away before every frame
+ *
+ * Return: Mean time of a frame in seconds
+ */
+static double bench_MinimapFrames(minimap_t *minimap, GameState *state,
+		bool redraw)
+{
+	double start = bench_Seconds();
+	int frame;
+
+	for (frame = 0; frame < MINIMAP_FRAMES; frame++)
+	{
+		bench_Walk(state, frame);
+		minimap->valid = minimap->valid && !redraw;
+		minimap_Draw(minimap, state);
+	}
+	return ((bench_Seconds() - start) / MINIMAP_FRAMES);
+}
+
+/**
+ * bench_CompareMinimaps - Draws a minimap kept up to date by dirty
+ * rectangles and one redrawn from scratch, and compares their windows
+ * @kept: Pointer to the minimap updated frame to frame
+ * @state: Pointer to the state, with the frame to check
+ *
+ * Return: Number of pixels that differ
+ */
+static long bench_CompareMinimaps(minimap_t *kept, GameState *state)
+{
+	minimap_t *fresh = minimap_Create();
+	SDL_Rect *window = &kept->window;
+	pixel_t *copy = malloc(sizeof(state->screenBuffer));
+	long differ = 0;
+	int row, column;
+
+	if (fresh == NULL || copy == NULL)
+		differ = -1;
+	else
+	{
+		fresh->mode = kept->mode;
+		fresh->zoom = kept->zoom;
+		minimap_Draw(kept, state);
+		memcpy(copy, state->screenBuffer, sizeof(state->screenBuffer));
+		minimap_Draw(fresh, state);
+		for (row = window->y; row < window->y + window->h; row++)
+			for (column = window->x; column < window->x + window->w; column++)
+				differ += copy[row * SCREEN_WIDTH + column] !=
+					state->screenBuffer[row][column];
+	}
+	minimap_Destroy(fresh);
+	free(copy);
+	return (differ);
+}
+
+/**
+ * bench_MinimapEdits - Opens and closes cells through the edit context and
+ * repairs the overview from the dirty tiles
+ * @minimap: Pointer to the minimap, showing the overview
+ * @edit: Pointer to the edit context of the state
+ *
+ * Return: Mean time of an edit, repair and frame in seconds
+ */
+static double bench_MinimapEdits(minimap_t *minimap, mapedit_t *edit)
+{
+	GameState *state = edit->state;
+	uint32_t seed = 2654435761u;
+	SDL_Rect rects[MINIMAP_RECTS];
+	double start = bench_Seconds();
+	int i, count, x, y;
+
+	for (i = 0; i < MINIMAP_EDITS; i++)
+	{
+		x = bench_Random(&seed) % state->mapHeight;
+		y = bench_Random(&seed) % state->mapWidth;
+		mapedit_SetCell(edit, x, y, !state->maze[x * state->mapWidth + y]);
+		while ((count = mapedit_TakeDirty(edit, rects, MINIMAP_RECTS)) > 0)
+			minimap_Repair(minimap, rects, count);
+		minimap_Draw(minimap, state);
+	}
+	return ((bench_Seconds() - start) / MINIMAP_EDITS);
+}
+
+/**
+ * bench_Minimap - Measures the minimap: pyramid build time and size, the
+ * frame time of the corner view at several zooms and of the overview, with
+ * dirty rectangles and redrawn from scratch, and the cost of repairing it
+ * after cell edits, checking both ways draw the same pixels and failing
+ * when they do not
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Minimap(int size)
+{
+	static const int zooms[MINIMAP_ZOOMS] = {-2, 0, 3, 6};
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	minimap_t *minimap = state ? minimap_Create() : NULL;
+	mapedit_t *edit = state ? mapedit_Create(state) : NULL;
+	double build, kept[MINIMAP_ZOOMS], redrawn[MINIMAP_ZOOMS];
+	double overview, overviewRedrawn, edits;
+	size_t bytes = 0;
+	long differ = 0;
+	int z, l;
+
+	if (minimap && edit)
+	{
+		minimap->mode = MINIMAP_OVERVIEW;
+		bench_Walk(state, 0);
+		build = bench_Seconds();
+		minimap_Draw(minimap, state);
+		build = bench_Seconds() - build;
+		for (l = 0; l < minimap->levelCount; l++)
+			bytes += (size_t)minimap->levels[l].width *
+				minimap->levels[l].height;
+		overview = bench_MinimapFrames(minimap, state, false);
+		overviewRedrawn = bench_MinimapFrames(minimap, state, true);
+		edits = bench_MinimapEdits(minimap, edit);
+		differ += bench_CompareMinimaps(minimap, state);
+		minimap->mode = MINIMAP_CORNER;
+		for (z = 0; z < MINIMAP_ZOOMS; z++)
+		{
+			minimap->zoom = zooms[z];
+			kept[z] = bench_MinimapFrames(minimap, state, false);
+			differ += bench_CompareMinimaps(minimap, state);
+			redrawn[z] = bench_MinimapFrames(minimap, state, true);
+		}
+		printf("minimap %s %dx%d: %d levels of %.1f MB built in %.1f ms; "
+			"corner frame %.1f/%.1f/%.1f/%.1f us at 1/4, 1, 8 and 64 cells "
+			"per pixel, %.1f/%.1f/%.1f/%.1f us redrawn; overview %.1f us, "
+			"%.1f us redrawn; %.1f us per cell edit with repair; %ld pixels "
+			"differ%s\n", PIXEL_FORMAT, size, size, minimap->levelCount,
+			bytes / 1048576.0, build * 1000.0, kept[0] * 1e6, kept[1] * 1e6,
+			kept[2] * 1e6, kept[3] * 1e6, redrawn[0] * 1e6, redrawn[1] * 1e6,
+			redrawn[2] * 1e6, redrawn[3] * 1e6, overview * 1e6,
+			overviewRedrawn * 1e6, edits * 1e6, differ, differ ? " FAIL" : "");
+		if (differ)
+			bench_Fail();
+	}
+	mapedit_Destroy(edit);
+	minimap_Destroy(minimap);
+	bench_DestroyState(state);
+	free(maze);
+}
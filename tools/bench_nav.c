@@ -0,0 +1,405 @@
+#include "bench.h"
+#include "../headers/navigation.h"
+
+#define NAV_AGENTS (1 << 20)
+#define NAV_EDITS 1000
+#define NAV_PATHS 50
+#define NAV_CHECK_EDITS 256
+#define NAV_CHECK_PATHS 64
+#define NAV_WINDOW 256
+#define NAV_REACH 48
+#define NAV_SQRT2 1.41421356f
+
+/**
+ * struct navwindow_s - plain Dijkstra search over a window of the maze,
+ * with the moves and costs of the jump point search, which it checks
+ * @maze: Pointer to the maze
+ * @size: Number of cells along each side of the maze
+ * @x0: First row of the window
+ * @y0: First column of the window
+ * @cost: Cost from the start of each cell of the window
+ * @heap: Open list, a binary min-heap; a cell is queued at most once per
+ * neighbour
+ * @heapSize: Number of entries in @heap
+ */
+typedef struct navwindow_s
+{
+	const int *maze;
+	int size;
+	int x0;
+	int y0;
+	float cost[NAV_WINDOW * NAV_WINDOW];
+	heapnode_t heap[8 * NAV_WINDOW * NAV_WINDOW + 1];
+	int heapSize;
+} navwindow_t;
+
+/**
+ * bench_FlowQueries - Times batched flow field lookups
+ * @field: Pointer to the field
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ *
+ * Return: Queries per second
+ */
+static double bench_FlowQueries(const flowfield_t *field, int size,
+		uint32_t *seed)
+{
+	point_t *positions, *directions;
+	SDL_Point cell;
+	double start;
+	int i;
+
+	positions = malloc(NAV_AGENTS * sizeof(point_t));
+	directions = malloc(NAV_AGENTS * sizeof(point_t));
+	if (positions == NULL || directions == NULL)
+	{
+		free(positions);
+		free(directions);
+		return (0);
+	}
+	for (i = 0; i < NAV_AGENTS; i++)
+	{
+		cell = bench_RandomOpenCell(field->maze, size, seed);
+		positions[i].x = cell.x + 0.5;
+		positions[i].y = cell.y + 0.5;
+	}
+	start = bench_Seconds();
+	nav_QueryBatch(field, positions, directions, NAV_AGENTS);
+	start = bench_Seconds() - start;
+	free(positions);
+	free(directions);
+	return (NAV_AGENTS / start);
+}
+
+/**
+ * bench_FlowEdits - Times incremental repairs after closing and
+ * reopening random cells
+ * @field: Pointer to the field
+ * @maze: Pointer to the maze the field was built on
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ *
+ * Return: Cell edits per second
+ */
+static double bench_FlowEdits(flowfield_t *field, int *maze, int size,
+		uint32_t *seed)
+{
+	SDL_Point cell;
+	double start = bench_Seconds();
+	int i;
+
+	for (i = 0; i < NAV_EDITS; i++)
+	{
+		cell = bench_RandomOpenCell(maze, size, seed);
+		maze[cell.x * size + cell.y] = 1;
+		nav_CellChanged(field, cell.x, cell.y);
+		maze[cell.x * size + cell.y] = 0;
+		nav_CellChanged(field, cell.x, cell.y);
+	}
+	return (2 * NAV_EDITS / (bench_Seconds() - start));
+}
+
+/**
+ * bench_PathQueries - Times one-off jump point searches
+ * @maze: Pointer to the maze
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ *
+ * Return: Searches per second
+ */
+static double bench_PathQueries(const int *maze, int size, uint32_t *seed)
+{
+	jpsearch_t *search = nav_CreateSearch(maze, size, size);
+	SDL_Point path[4096];
+	double start;
+	int i;
+
+	if (search == NULL)
+		return (0);
+	start = bench_Seconds();
+	for (i = 0; i < NAV_PATHS; i++)
+		nav_FindPath(search, bench_RandomOpenCell(maze, size, seed),
+			bench_RandomOpenCell(maze, size, seed), path, 4096);
+	start = bench_Seconds() - start;
+	nav_DestroySearch(search);
+	return (NAV_PATHS / start);
+}
+
+/**
+ * bench_FlowCheck - Closes random cells one by one, then opens them again,
+ * comparing the repaired field with a rebuilt one after each half
+ * @field: Pointer to the field
+ * @maze: Pointer to the maze the field was built on
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ *
+ * Return: Number of distances that differ, summed over both checks, or -1
+ * if memory ran out
+ */
+static long bench_FlowCheck(flowfield_t *field, int *maze, int size,
+		uint32_t *seed)
+{
+	SDL_Point cells[NAV_CHECK_EDITS];
+	flowfield_t *rebuilt;
+	long differ = 0, i;
+	int pass, n;
+
+	for (n = 0; n < NAV_CHECK_EDITS; n++)
+	{
+		do {
+			cells[n] = bench_RandomOpenCell(maze, size, seed);
+		} while (cells[n].x == field->goals[0].x &&
+			 cells[n].y == field->goals[0].y);
+		maze[cells[n].x * size + cells[n].y] = 1;
+		nav_CellChanged(field, cells[n].x, cells[n].y);
+	}
+	for (pass = 0; pass < 2; pass++)
+	{
+		rebuilt = nav_CreateFlowField(maze, size, size, field->goals,
+			field->goalCount);
+		if (rebuilt == NULL)
+			return (-1);
+		for (i = 0; i < (long)size * size; i++)
+			differ += rebuilt->dist[i] != field->dist[i];
+		nav_DestroyFlowField(rebuilt);
+		for (n = NAV_CHECK_EDITS - 1; pass == 0 && n >= 0; n--)
+		{
+			maze[cells[n].x * size + cells[n].y] = 0;
+			nav_CellChanged(field, cells[n].x, cells[n].y);
+		}
+	}
+	return (differ);
+}
+
+/**
+ * bench_WindowPush - Queues a cell of the window search
+ * @window: Pointer to the search
+ * @cell: Index of the cell in the window
+ * @cost: Cost from the start
+ *
+ * Return: void
+ */
+static void bench_WindowPush(navwindow_t *window, int cell, float cost)
+{
+	int i = window->heapSize++;
+
+	window->cost[cell] = cost;
+	while (i > 0 && window->heap[(i - 1) / 2].cost > cost)
+	{
+		window->heap[i] = window->heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	window->heap[i].cost = cost;
+	window->heap[i].cell = cell;
+}
+
+/**
+ * bench_WindowPop - Takes the cheapest entry of the window search
+ * @window: Pointer to the search, with a non empty open list
+ *
+ * Return: The entry
+ */
+static heapnode_t bench_WindowPop(navwindow_t *window)
+{
+	heapnode_t top = window->heap[0], last;
+	int i = 0, child;
+
+	last = window->heap[--window->heapSize];
+	while ((child = 2 * i + 1) < window->heapSize)
+	{
+		if (child + 1 < window->heapSize &&
+		    window->heap[child + 1].cost < window->heap[child].cost)
+			child++;
+		if (window->heap[child].cost >= last.cost)
+			break;
+		window->heap[i] = window->heap[child];
+		i = child;
+	}
+	window->heap[i] = last;
+	return (top);
+}
+
+/**
+ * bench_WindowOpen - Checks if a cell can be entered, noting the cells
+ * past the window a route could leave through
+ * @window: Pointer to the search
+ * @x: Row of the cell
+ * @y: Column of the cell
+ * @left: Set to true if the cell is open but outside the window
+ *
+ * Return: true if the cell is open and in the window, else false
+ */
+static bool bench_WindowOpen(const navwindow_t *window, int x, int y,
+		bool *left)
+{
+	if (!nav_IsWalkable(window->maze, window->size, window->size, x, y))
+		return (false);
+	if (x >= window->x0 && x < window->x0 + NAV_WINDOW &&
+	    y >= window->y0 && y < window->y0 + NAV_WINDOW)
+		return (true);
+	*left = true;
+	return (false);
+}
+
+/**
+ * bench_WindowSearch - Finds the cost of a shortest route between two
+ * cells without leaving a window around the start. Any route leaving the
+ * window costs at least the distance to its edge, so a cheaper route found
+ * inside is the shortest of the whole maze.
+ * @window: Pointer to the search, with its maze
+ * @start: Start cell
+ * @goal: Goal cell, at most NAV_REACH cells from @start along each axis
+ *
+ * Return: Cost of the route, -1 if there is none, or -2 if the shortest
+ * route could leave the window
+ */
+static float bench_WindowSearch(navwindow_t *window, SDL_Point start,
+		SDL_Point goal)
+{
+	int reach, i, j, x, y, cell;
+	bool left = false;
+	heapnode_t node;
+	float cost;
+
+	window->x0 = start.x - NAV_WINDOW / 2;
+	window->y0 = start.y - NAV_WINDOW / 2;
+	reach = NAV_WINDOW / 2 - 1;
+	for (i = 0; i < NAV_WINDOW * NAV_WINDOW; i++)
+		window->cost[i] = INFINITY;
+	window->heapSize = 0;
+	bench_WindowPush(window, NAV_WINDOW / 2 * NAV_WINDOW + NAV_WINDOW / 2, 0);
+	while (window->heapSize > 0)
+	{
+		node = bench_WindowPop(window);
+		if (node.cost > window->cost[node.cell])
+			continue;
+		if (node.cost >= reach)
+			return (-2);
+		x = window->x0 + node.cell / NAV_WINDOW;
+		y = window->y0 + node.cell % NAV_WINDOW;
+		if (x == goal.x && y == goal.y)
+			return (node.cost);
+		for (i = -1; i <= 1; i++)
+			for (j = -1; j <= 1; j++)
+			{
+				/* Diagonal moves may not cut wall corners */
+				if ((i == 0 && j == 0) || !bench_WindowOpen(window, x + i,
+				    y + j, &left) || (i && j && (!nav_IsWalkable(
+				    window->maze, window->size, window->size, x + i, y) ||
+				    !nav_IsWalkable(window->maze, window->size, window->size,
+				    x, y + j))))
+					continue;
+				cell = (x + i - window->x0) * NAV_WINDOW + y + j - window->y0;
+				cost = node.cost + (i && j ? NAV_SQRT2 : 1);
+				if (cost < window->cost[cell])
+					bench_WindowPush(window, cell, cost);
+			}
+	}
+	return (left ? -2 : -1);
+}
+
+/**
+ * bench_Octile - Finds the cost of a straight or diagonal line of cells
+ * @from: First cell
+ * @to: Last cell
+ *
+ * Return: The cost, 1 per straight step and NAV_SQRT2 per diagonal one
+ */
+static float bench_Octile(SDL_Point from, SDL_Point to)
+{
+	int dx = abs(to.x - from.x), dy = abs(to.y - from.y);
+
+	return ((dx > dy ? dx - dy : dy - dx) + NAV_SQRT2 * (dx < dy ? dx : dy));
+}
+
+/**
+ * bench_PathCheck - Compares the length of jump point search routes
+ * between nearby cells with the window search
+ * @maze: Pointer to the maze
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ * @checked: Receives the number of routes the window search could check
+ *
+ * Return: Number of routes whose length differs, or -1 if memory ran out
+ */
+static int bench_PathCheck(const int *maze, int size, uint32_t *seed,
+		int *checked)
+{
+	jpsearch_t *search = nav_CreateSearch(maze, size, size);
+	navwindow_t *window = malloc(sizeof(navwindow_t));
+	SDL_Point start, goal, path[4096];
+	int differ = 0, i, n, p;
+	float reference, length;
+
+	*checked = 0;
+	for (i = 0; search && window && i < NAV_CHECK_PATHS; i++)
+	{
+		window->maze = maze;
+		window->size = size;
+		start = bench_RandomOpenCell(maze, size, seed);
+		do {
+			goal.x = start.x + (int)(bench_Random(seed) % (2 * NAV_REACH + 1)) -
+				NAV_REACH;
+			goal.y = start.y + (int)(bench_Random(seed) % (2 * NAV_REACH + 1)) -
+				NAV_REACH;
+		} while (!nav_IsWalkable(maze, size, size, goal.x, goal.y));
+		reference = bench_WindowSearch(window, start, goal);
+		if (reference == -2)
+			continue;
+		(*checked)++;
+		n = nav_FindPath(search, start, goal, path, 4096);
+		for (p = 1, length = 0; p < n; p++)
+			length += bench_Octile(path[p - 1], path[p]);
+		differ += reference < 0 ? n >= 0 : n < 0 ||
+			fabsf(length - reference) > 1e-3f;
+	}
+	if (search == NULL || window == NULL)
+		differ = -1;
+	nav_DestroySearch(search);
+	free(window);
+	return (differ);
+}
+
+/**
+ * bench_Navigation - Benchmarks flow fields and jump point search, and
+ * checks the repaired fields and the search routes
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Navigation(int size)
+{
+	uint32_t seed = 2463534242u;
+	flowfield_t *field;
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 35);
+	int checked, paths;
+	SDL_Point goal;
+	double build;
+	long flows;
+
+	if (maze == NULL)
+		return;
+	goal = bench_RandomOpenCell(maze, size, &seed);
+	build = bench_Seconds();
+	field = nav_CreateFlowField(maze, size, size, &goal, 1);
+	build = bench_Seconds() - build;
+	if (field == NULL)
+	{
+		free(maze);
+		return;
+	}
+	printf("nav %dx%d: build %.1f ms, %.2f Mquery/s, %.0f edit/s, ",
+		size, size, build * 1000.0,
+		bench_FlowQueries(field, size, &seed) / 1e6,
+		bench_FlowEdits(field, maze, size, &seed));
+	printf("%.1f jps/s\n", bench_PathQueries(maze, size, &seed));
+	flows = bench_FlowCheck(field, maze, size, &seed);
+	paths = bench_PathCheck(maze, size, &seed, &checked);
+	printf("nav %dx%d: %ld flow distances differ from a rebuild after %d "
+		"cell edits and back, %d of %d jps route lengths differ from a "
+		"grid search\n", size, size, flows, NAV_CHECK_EDITS, paths, checked);
+	if (flows != 0 || paths != 0)
+		bench_Fail();
+	nav_DestroyFlowField(field);
+	free(maze);
+}
@@ -0,0 +1,289 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+
+#define PRECISION_POSES 64
+
+/*
+ * Largest errors each precision may show against the double reference,
+ * which casts the same rounded ray: the share of rays stopping in another
+ * cell, in percent, the relative wall distance error, and the wall slice
+ * height and texture column errors. A ray running exactly along an axis
+ * must always stop in the reference's cell. Slices and columns are whole
+ * numbers, so a tiny error on either side of a boundary already moves
+ * them by one. Float keeps 24 bits, so a distance is good to about 1e-6
+ * after the steps of a long ray; a ray nearly parallel to the grid lines
+ * of one axis takes steps of up to RAY_FAR on it, and the wall distance is
+ * the sum after the step minus the step, which loses up to about 5e-5 near
+ * a wall. Fixed point rounds every step to 1/65536, which near a wall
+ * corner can send a ray to the next cell, and leaves distance errors of
+ * up to about 5e-4.
+ */
+#if defined(MAZE_FIXED)
+#define PRECISION_MAX_CELLS 0.05
+#define PRECISION_MAX_DISTANCE 2e-3
+#define PRECISION_MAX_SLICE 2
+#define PRECISION_MAX_TEXEL 2
+#elif defined(MAZE_FLOAT)
+#define PRECISION_MAX_CELLS 0.01
+#define PRECISION_MAX_DISTANCE 1e-4
+#define PRECISION_MAX_SLICE 1
+#define PRECISION_MAX_TEXEL 2
+#else
+#define PRECISION_MAX_CELLS 0.0
+#define PRECISION_MAX_DISTANCE 1e-12
+#define PRECISION_MAX_SLICE 1
+#define PRECISION_MAX_TEXEL 1
+#endif
+
+/**
+ * struct rayerror_s - Differences between castRay and the double reference
+ * @rays: number of rays compared
+ * @cellMisses: rays that stopped in a different cell than the reference
+ * @parallelMisses: those of them running exactly along an axis
+ * @maxError: largest relative wall distance error
+ * @sumError: sum of the relative wall distance errors
+ * @maxSlice: largest wall slice height error, in pixels
+ * @maxTexel: largest wall texture column error, in texels
+ */
+typedef struct rayerror_s
+{
+	long rays;
+	long cellMisses;
+	long parallelMisses;
+	double maxError;
+	double sumError;
+	int maxSlice;
+	int maxTexel;
+} rayerror_t;
+
+/**
+ * reference_CastRay - Casts one ray in double precision with the original
+ * formulas of the renderer, before the precision could be chosen. It
+ * casts the ray as this build stores it, its position and direction
+ * rounded to real_t, so only the stepping math is compared.
+ * @state: Pointer to the state
+ * @column: Screen column the ray is cast for
+ * @map: Receives the cell hit
+ * @wallX: Receives where on the wall the ray hit, between 0 and 1
+ * @corner: Set when the ray passes through a grid corner, where either
+ * cell next to it is right
+ *
+ * Return: Distance to the wall, or -1 if the ray left the map
+ */
+static double reference_CastRay(const GameState *state, int column,
+		SDL_Point *map, double *wallX, bool *corner)
+{
+	double cameraX = 2 * column / (double)SCREEN_WIDTH - 1, distance;
+	point_t dir, delta, next, position;
+	SDL_Point step;
+	int side = 0;
+
+	dir.x = REAL_TO_DOUBLE(REAL(state->direction.x + state->viewPlane.x *
+		cameraX));
+	dir.y = REAL_TO_DOUBLE(REAL(state->direction.y + state->viewPlane.y *
+		cameraX));
+	position.x = REAL_TO_DOUBLE(REAL(state->position.x));
+	position.y = REAL_TO_DOUBLE(REAL(state->position.y));
+	map->x = (int)position.x;
+	map->y = (int)position.y;
+	delta.x = dir.x == 0 ? INFINITY : sqrt(1 + dir.y * dir.y / (dir.x * dir.x));
+	delta.y = dir.y == 0 ? INFINITY : sqrt(1 + dir.x * dir.x / (dir.y * dir.y));
+	step.x = dir.x < 0 ? -1 : 1;
+	step.y = dir.y < 0 ? -1 : 1;
+	next.x = (dir.x < 0 ? position.x - map->x :
+		map->x + 1.0 - position.x) * delta.x;
+	next.y = (dir.y < 0 ? position.y - map->y :
+		map->y + 1.0 - position.y) * delta.y;
+	*corner = false;
+	do {
+		*corner = *corner || fabs(next.x - next.y) <= 1e-9 * next.x;
+		if (next.x < next.y)
+		{
+			next.x += delta.x;
+			map->x += step.x;
+			side = 0;
+		}
+		else
+		{
+			next.y += delta.y;
+			map->y += step.y;
+			side = 1;
+		}
+		if (map->x < 0 || map->x >= state->mapHeight || map->y < 0 ||
+		    map->y >= state->mapWidth)
+			return (-1);
+	} while (state->maze[map->x * state->mapWidth + map->y] == 0);
+	distance = side == 0 ?
+		(map->x - position.x + (1 - step.x) / 2) / dir.x :
+		(map->y - position.y + (1 - step.y) / 2) / dir.y;
+	*wallX = side == 0 ? position.y + distance * dir.y :
+		position.x + distance * dir.x;
+	*wallX -= floor(*wallX);
+	return (distance);
+}
+
+/**
+ * bench_PlacePose - Places the camera for one compared pose: a random
+ * cell and direction for a quarter of the poses, the others moved off the
+ * cell centre, close to its edges for some, and half of them facing
+ * exactly along an axis, so the middle column casts a ray parallel to the
+ * grid lines
+ * @state: Pointer to the state
+ * @seed: Pointer to the generator state
+ * @pose: Number of the pose
+ *
+ * Return: void
+ */
+static void bench_PlacePose(GameState *state, uint32_t *seed, int pose)
+{
+	static const double offsets[] = {0.001, 0.25, 0.999, 0.5, 0.0};
+	int axis;
+
+	bench_PlaceCamera(state, seed);
+	if (pose % 4 != 0)
+	{
+		state->position.x = floor(state->position.x) +
+			offsets[bench_Random(seed) % 5];
+		state->position.y = floor(state->position.y) +
+			offsets[bench_Random(seed) % 5];
+	}
+	if (pose % 4 >= 2)
+	{
+		axis = bench_Random(seed) % 4;
+		state->direction.x = axis < 2 ? 1 - axis * 2 : 0;
+		state->direction.y = axis < 2 ? 0 : 5 - axis * 2;
+		state->viewPlane.x = -0.66 * state->direction.y;
+		state->viewPlane.y = 0.66 * state->direction.x;
+	}
+}
+
+/**
+ * bench_Slice - Gives the height of the wall slice drawn at a distance,
+ * clipped to the screen as it is drawn
+ * @distance: Distance to the wall
+ *
+ * Return: Height in pixels
+ */
+static int bench_Slice(double distance)
+{
+	return (SCREEN_HEIGHT / distance < SCREEN_HEIGHT ?
+		(int)(SCREEN_HEIGHT / distance) : SCREEN_HEIGHT);
+}
+
+/**
+ * bench_CompareRay - Casts one ray both ways and accumulates the error,
+ * leaving out rays through a grid corner
+ * @state: Pointer to the state
+ * @column: Screen column the ray is cast for
+ * @error: Accumulated differences
+ *
+ * Return: void
+ */
+static void bench_CompareRay(GameState *state, int column, rayerror_t *error)
+{
+	rayhit_t ray;
+	SDL_Point cell;
+	double reference, distance, wallX, refWallX, relative;
+	bool corner;
+	int slice;
+
+	reference = reference_CastRay(state, column, &cell, &refWallX, &corner);
+	if (!castRay(state, column, &ray) || corner || reference <
+	    REAL_TO_DOUBLE(RAY_MIN_DISTANCE))
+		return;
+	error->rays++;
+	if (ray.map.x != cell.x || ray.map.y != cell.y)
+	{
+		error->cellMisses++;
+		error->parallelMisses += ray.direction.x == 0 || ray.direction.y == 0;
+		return;
+	}
+	distance = REAL_TO_DOUBLE(ray.distance);
+	relative = fabs(distance - reference) / reference;
+	error->sumError += relative;
+	if (relative > error->maxError)
+		error->maxError = relative;
+	slice = abs(bench_Slice(distance) - bench_Slice(reference));
+	if (slice > error->maxSlice)
+		error->maxSlice = slice;
+	wallX = REAL_TO_DOUBLE(REAL_FRAC(ray.side == 0 ? ray.position.y +
+		REAL_MUL(ray.distance, ray.direction.y) :
+		ray.position.x + REAL_MUL(ray.distance, ray.direction.x)));
+	slice = abs((int)(wallX * TEXTURE_WIDTH) - (int)(refWallX * TEXTURE_WIDTH));
+	if (slice > TEXTURE_WIDTH / 2)
+		slice = TEXTURE_WIDTH - slice;
+	if (slice > error->maxTexel)
+		error->maxTexel = slice;
+}
+
+/**
+ * bench_OverBound - Finds the first error over the bounds of this build
+ * @error: Differences with the reference
+ *
+ * Return: Name of the error over its bound, or NULL if all are within
+ */
+static const char *bench_OverBound(const rayerror_t *error)
+{
+	if (error->parallelMisses > 0)
+		return ("axis-parallel cells");
+	if (100.0 * error->cellMisses / error->rays > PRECISION_MAX_CELLS)
+		return ("cells");
+	if (error->maxError > PRECISION_MAX_DISTANCE)
+		return ("distance");
+	if (error->maxSlice > PRECISION_MAX_SLICE)
+		return ("slice");
+	if (error->maxTexel > PRECISION_MAX_TEXEL)
+		return ("texel");
+	return (NULL);
+}
+
+/**
+ * bench_Precision - Measures how far the ray casting math of this build
+ * strays from double precision, and how fast it runs, and fails when an
+ * error is over the bounds of the build. Build with PRECISION=float or
+ * PRECISION=fixed to compare the modes.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Precision(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45), pose, i;
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	rayerror_t error = {0, 0, 0, 0, 0, 0, 0};
+	uint32_t seed = 362436069u;
+	double rays = 0, frames = 0, start;
+	const char *over;
+	rayhit_t ray;
+
+	for (pose = 0; state && pose < PRECISION_POSES; pose++)
+	{
+		bench_PlacePose(state, &seed, pose);
+		for (i = 0; i < SCREEN_WIDTH; i++)
+			bench_CompareRay(state, i, &error);
+		start = bench_Seconds();
+		for (i = 0; i < SCREEN_WIDTH; i++)
+			castRay(state, i, &ray);
+		rays += bench_Seconds() - start;
+		start = bench_Seconds();
+		renderWalls(state, true);
+		frames += bench_Seconds() - start;
+	}
+	if (state && error.rays)
+	{
+		over = bench_OverBound(&error);
+		printf("precision %s %dx%d: %.3f%% cells differ, distance error "
+			"max %.2e mean %.2e, slice error %d px, texel error %d, "
+			"%.1f Mray/s, frame %.2f ms; %s%s\n", REAL_NAME, size, size,
+			100.0 * error.cellMisses / error.rays, error.maxError,
+			error.sumError / (error.rays - error.cellMisses),
+			error.maxSlice, error.maxTexel,
+			PRECISION_POSES * SCREEN_WIDTH / rays / 1e6,
+			frames * 1000.0 / PRECISION_POSES, over ? "FAIL, error over "
+			"its bound: " : "within bounds", over ? over : "");
+		if (over)
+			bench_Fail();
+	}
+	bench_DestroyState(state);
+	free(maze);
+}
@@ -0,0 +1,160 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+
+#define PVS_POSES 64
+#define PVS_ROUNDS 5
+
+/**
+ * struct raystats_s - DDA work measured over a set of camera poses
+ * @rays: number of rays cast
+ * @steps: DDA steps taken
+ * @boundedSteps: steps taken by rays bounded by the visibility data, past
+ * the first RAY_CHECKED_STEPS, which skip the map edge checks
+ * @seconds: time spent rendering the frames
+ * @cast: time spent casting the rays of the frames, the fastest of
+ * PVS_ROUNDS for each frame
+ */
+typedef struct raystats_s
+{
+	long rays;
+	long steps;
+	long boundedSteps;
+	double seconds;
+	double cast;
+} raystats_t;
+
+/**
+ * bench_CastColumns - Casts the ray of every screen column
+ * @state: Pointer to the headless state
+ * @stats: Receives the number of rays and steps, or NULL
+ *
+ * Return: Time taken, in seconds
+ */
+static double bench_CastColumns(GameState *state, raystats_t *stats)
+{
+	double start = bench_Seconds();
+	rayhit_t ray;
+	int i;
+
+	for (i = 0; i < SCREEN_WIDTH; i++)
+	{
+		castRay(state, i, &ray);
+		if (stats == NULL)
+			continue;
+		stats->rays++;
+		stats->steps += ray.steps;
+		if (state->pvs && ray.steps > RAY_CHECKED_STEPS &&
+		    pvs_Bound(state->pvs, state->mapWidth,
+		    real_Floor(ray.position.x), real_Floor(ray.position.y),
+		    (ray.direction.x >= 0) + (ray.direction.y >= 0) * 2) >= 0)
+			stats->boundedSteps += ray.steps - RAY_CHECKED_STEPS;
+	}
+	return (bench_Seconds() - start);
+}
+
+/**
+ * bench_MeasureRays - Casts rays and renders full frames from fixed poses
+ * with and without the visibility data, taking turns for every pose so
+ * that drift of the machine hits both
+ * @state: Pointer to the headless state
+ * @pvs: Visibility data of the map
+ * @stats: Receives the measurements without (0) and with (1) the data
+ *
+ * Return: void
+ */
+static void bench_MeasureRays(GameState *state, uint8_t *pvs,
+		raystats_t stats[2])
+{
+	uint32_t seed = 88675123u;
+	double start, best[2], time;
+	int pose, round, with;
+
+	memset(stats, 0, 2 * sizeof(*stats));
+	for (pose = 0; pose < PVS_POSES; pose++)
+	{
+		bench_PlaceCamera(state, &seed);
+		for (with = 0; with < 2; with++)
+		{
+			state->pvs = with ? pvs : NULL;
+			bench_CastColumns(state, &stats[with]);
+			start = bench_Seconds();
+			renderWalls(state, true);
+			stats[with].seconds += bench_Seconds() - start;
+		}
+		best[0] = best[1] = 1e9;
+		for (round = 0; round < PVS_ROUNDS; round++)
+			for (with = 0; with < 2; with++)
+			{
+				state->pvs = with ? pvs : NULL;
+				time = bench_CastColumns(state, NULL);
+				best[with] = time < best[with] ? time : best[with];
+			}
+		stats[0].cast += best[0];
+		stats[1].cast += best[1];
+	}
+	state->pvs = pvs;
+}
+
+/**
+ * bench_VisibilityStyle - Benchmarks one map style with and without the
+ * visibility data
+ * @size: Number of cells along each side
+ * @style: Layout of the map
+ * @openEdge: True to remove the outer wall, so rays can leave the map
+ * @name: Name printed for the map
+ *
+ * Return: void
+ */
+static void bench_VisibilityStyle(int size, mapstyle_t style, bool openEdge,
+		const char *name)
+{
+	static const int densities[] = {100, 45, 98};
+	int *maze = bench_GenerateMaze(size, style, densities[style]), i;
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	raystats_t stats[2];
+	double build;
+
+	for (i = 0; state && openEdge && i < size; i++)
+	{
+		maze[i] = maze[(size - 1) * size + i] = 0;
+		maze[i * size] = maze[i * size + size - 1] = 0;
+	}
+	build = bench_Seconds();
+	if (state)
+		state->pvs = pvs_Build(maze, size, size);
+	build = bench_Seconds() - build;
+	if (state && state->pvs)
+	{
+		bench_MeasureRays(state, state->pvs, stats);
+		printf("pvs %dx%d %s: build %.1f ms, %.1f MB, %.1f steps/ray, "
+			"%.0f%% steps bounded, rays cast in %.1f us (%.1f us without, "
+			"%+.1f%%), frame %.2f ms (%.2f ms without)\n", size, size, name,
+			build * 1000.0,
+			pvs_Size(size, size) / 1048576.0,
+			(double)stats[1].steps / stats[1].rays,
+			100.0 * stats[1].boundedSteps /
+			(stats[1].steps ? stats[1].steps : 1),
+			stats[1].cast * 1e6 / PVS_POSES, stats[0].cast * 1e6 / PVS_POSES,
+			100.0 * (stats[1].cast - stats[0].cast) / stats[0].cast,
+			stats[1].seconds * 1000.0 / PVS_POSES,
+			stats[0].seconds * 1000.0 / PVS_POSES);
+		free(state->pvs);
+		state->pvs = NULL;
+	}
+	bench_DestroyState(state);
+	free(maze);
+}
+
+/**
+ * bench_Visibility - Benchmarks the visibility data on every map style
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Visibility(int size)
+{
+	bench_VisibilityStyle(size, MAPGEN_PERFECT, false, "perfect");
+	bench_VisibilityStyle(size, MAPGEN_CAVERN, false, "cavern");
+	bench_VisibilityStyle(size, MAPGEN_CORRIDOR, false, "corridor");
+	bench_VisibilityStyle(size, MAPGEN_CAVERN, true, "open-edge cavern");
+}
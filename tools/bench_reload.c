@@ -0,0 +1,257 @@
+#include "bench.h"
+#include "../headers/map.h"
+#include "../headers/pvs.h"
+#include "../headers/raycast.h"
+#include "../headers/reload.h"
+#include "../headers/textures.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define RELOAD_ROUNDS 4
+#define RELOAD_IDLE_FRAMES 64
+#define RELOAD_TIMEOUT 60.0
+
+/**
+ * struct reloadrun_s - timings of the frames rendered around reloads
+ * @frames: number of frames
+ * @total: total frame time, in seconds
+ * @longest: longest frame, in seconds
+ * @latency: total time from a change to its swap, in seconds
+ * @apply: total time of the swaps, in seconds
+ * @reloads: number of swaps
+ */
+typedef struct reloadrun_s
+{
+	int frames;
+	double total;
+	double longest;
+	double latency;
+	double apply;
+	int reloads;
+} reloadrun_t;
+
+/**
+ * bench_WriteTexture - Writes one texture file of the benchmark
+ * @dir: Directory of the texture files
+ * @slot: Index of the texture
+ * @shade: Colour variation, so each write gives a new texture
+ *
+ * Return: true on success, false on failure
+ */
+static bool bench_WriteTexture(const char *dir, int slot, uint32_t shade)
+{
+	SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, TEXTURE_WIDTH,
+		TEXTURE_HEIGHT, 32, SDL_PIXELFORMAT_RGB888);
+	char path[512];
+	uint32_t *pixels;
+	int x, y, saved;
+
+	if (surface == NULL)
+		return (false);
+	for (y = 0; y < TEXTURE_HEIGHT; y++)
+	{
+		pixels = (uint32_t *)((uint8_t *)surface->pixels + y * surface->pitch);
+		for (x = 0; x < TEXTURE_WIDTH; x++)
+			pixels[x] = ((x ^ y) & 8 ? 0x804020 : 0x408060) + slot * 0x101010 +
+				(shade * 0x030507 & 0x1F1F1F);
+	}
+	snprintf(path, sizeof(path), "%s/%s", dir, get_TextureName(slot));
+	saved = SDL_SaveBMP(surface, path);
+	SDL_FreeSurface(surface);
+	return (saved == 0);
+}
+
+/**
+ * bench_WriteMap - Writes the map file of the benchmark
+ * @path: Path of the map
+ * @size: Number of cells along each side
+ * @seed: Seed of the map, so each write gives a new map
+ *
+ * Return: true on success, false on failure
+ */
+static bool bench_WriteMap(const char *path, int size, uint32_t seed)
+{
+	mapgen_t options;
+
+	options.width = size;
+	options.height = size;
+	options.style = MAPGEN_CAVERN;
+	options.density = 45;
+	options.seed = seed;
+	return (generateMapToFile(&options, path));
+}
+
+/**
+ * bench_ReloadFrames - Renders frames until the watcher swaps new data in,
+ * or for a fixed number of frames when none is expected
+ * @state: Pointer to the state
+ * @reload: Pointer to the watcher, NULL to render RELOAD_IDLE_FRAMES
+ * @run: Timings to add to
+ *
+ * Return: true if data was swapped in or none was expected, else false
+ */
+static bool bench_ReloadFrames(GameState *state, reload_t *reload,
+		reloadrun_t *run)
+{
+	uint32_t seed = 2654435761u;
+	double start, frame, waited = bench_Seconds();
+	bool swapped = false;
+	int frames;
+
+	for (frames = 0; reload ? !swapped : frames < RELOAD_IDLE_FRAMES;
+	     frames++)
+	{
+		if (reload && bench_Seconds() - waited > RELOAD_TIMEOUT)
+			return (false);
+		start = bench_Seconds();
+		swapped = reload_Apply(reload, state);
+		bench_PlaceCamera(state, &seed);
+		renderWalls(state, true);
+		frame = bench_Seconds() - start;
+		run->frames++;
+		run->total += frame;
+		run->longest = frame > run->longest ? frame : run->longest;
+	}
+	if (reload)
+	{
+		run->latency += reload->latency;
+		run->apply += reload->apply;
+		run->reloads++;
+	}
+	return (true);
+}
+
+/**
+ * bench_Reloads - Rewrites the map or one texture after another and
+ * renders frames until each change is swapped in
+ * @state: Pointer to the state
+ * @reload: Pointer to the watcher
+ * @paths: Map path and texture directory
+ * @size: Number of cells along each side
+ * @map: true to rewrite the map, false to rewrite textures
+ * @run: Receives the timings
+ *
+ * Return: true on success, false if a change was never swapped in
+ */
+static bool bench_Reloads(GameState *state, reload_t *reload,
+		char *paths[2], int size, bool map, reloadrun_t *run)
+{
+	int round;
+	bool written;
+
+	memset(run, 0, sizeof(reloadrun_t));
+	for (round = 1; round <= RELOAD_ROUNDS; round++)
+	{
+		written = map ? bench_WriteMap(paths[0], size, 2463534242u + round) :
+			bench_WriteTexture(paths[1], round % TEXTURE_COUNT, round);
+		if (!written || !bench_ReloadFrames(state, reload, run))
+			return (false);
+	}
+	return (true);
+}
+
+/**
+ * bench_ReloadFiles - Creates the map and textures of the benchmark in a
+ * temporary directory
+ * @dir: Template of the directory, replaced by its name
+ * @paths: Receives the map path and the texture directory
+ * @size: Number of cells along each side of the map
+ *
+ * Return: true on success, false on failure
+ */
+static bool bench_ReloadFiles(char *dir, char *paths[2], int size)
+{
+	int slot;
+
+	if (mkdtemp(dir) == NULL)
+		return (false);
+	sprintf(paths[0], "%s/map", dir);
+	sprintf(paths[1], "%s/textures", dir);
+	if (mkdir(paths[1], 0755) != 0 || !bench_WriteMap(paths[0], size,
+	    2463534242u))
+		return (false);
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+		if (!bench_WriteTexture(paths[1], slot, 0))
+			return (false);
+	return (true);
+}
+
+/**
+ * bench_RemoveFiles - Deletes the files of bench_ReloadFiles
+ * @dir: The temporary directory
+ * @paths: Map path and texture directory
+ *
+ * Return: void
+ */
+static void bench_RemoveFiles(const char *dir, char *paths[2])
+{
+	char path[512];
+	int slot;
+
+	for (slot = 0; slot < TEXTURE_COUNT; slot++)
+	{
+		snprintf(path, sizeof(path), "%s/%s", paths[1], get_TextureName(slot));
+		unlink(path);
+	}
+	rmdir(paths[1]);
+	snprintf(path, sizeof(path), "%s.pvs", paths[0]);
+	unlink(path);
+	unlink(paths[0]);
+	rmdir(dir);
+}
+
+/**
+ * bench_Reload - Measures how long a rewritten map or texture takes to
+ * reach a running game through the file watcher, and the frame times
+ * while the watcher thread reads it, against frames with no reload
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Reload(int size)
+{
+	char dir[] = "/tmp/mazereload.XXXXXX", map[64], textures[64];
+	char *paths[2] = {map, textures};
+	reloadrun_t idle = {0, 0, 0, 0, 0, 0}, maps, tiles;
+	GameState *state = NULL;
+	reload_t *reload = NULL;
+	int width, height, *maze = NULL;
+
+	if (bench_ReloadFiles(dir, paths, size))
+		maze = readMapFromFile(map, &width, &height);
+	if (maze)
+		state = bench_CreateState(maze, size);
+	if (state)
+	{
+		state->pvs = pvs_Load(maze, size, size, map);
+		reload = reload_Start(map, textures);
+	}
+	if (reload && state->pvs)
+	{
+		SDL_Delay(200);
+		bench_ReloadFrames(state, NULL, &idle);
+		if (bench_Reloads(state, reload, paths, size, true, &maps) &&
+		    bench_Reloads(state, reload, paths, size, false, &tiles))
+			printf("reload %s %dx%d: map %.1f ms after the change (swap %.3f "
+				"ms), texture %.1f ms (swap %.3f ms), frame %.2f ms idle, "
+				"%.2f ms mean / %.2f ms longest while the map reloads\n",
+				PIXEL_FORMAT, size, size, maps.latency * 1000.0 / maps.reloads,
+				maps.apply * 1000.0 / maps.reloads,
+				tiles.latency * 1000.0 / tiles.reloads,
+				tiles.apply * 1000.0 / tiles.reloads,
+				idle.total * 1000.0 / idle.frames,
+				maps.total * 1000.0 / maps.frames, maps.longest * 1000.0);
+		else
+			fprintf(stderr, "reload %dx%d: a change was never swapped in\n",
+				size, size);
+	}
+	reload_Stop(reload);
+	if (state)
+	{
+		free(state->pvs);
+		maze = state->maze;
+	}
+	bench_DestroyState(state);
+	free(maze);
+	bench_RemoveFiles(dir, paths);
+}
@@ -0,0 +1,209 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+#include "../headers/palette.h"
+#include "../headers/lighting.h"
+
+#define RENDER_POSES 64
+#define SHADE_POSES 16
+#define SHADE_ROUNDS 3
+#define SHADE_BOUND_NS 1.0
+
+/**
+ * bench_Present - Converts the frame buffer to the xRGB frame SDL is given,
+ * the way update_SDLFrames does in a windowed run
+ * @state: Pointer to the state
+ * @frame: Receives SCREEN_WIDTH * SCREEN_HEIGHT pixels
+ *
+ * Return: void
+ */
+static void bench_Present(GameState *state, uint32_t *frame)
+{
+#ifdef MAZE_PALETTE
+	int y;
+
+	for (y = 0; y < SCREEN_HEIGHT; y++)
+		palette_Expand(state->palette, state->screenBuffer[y],
+			frame + y * SCREEN_WIDTH, SCREEN_WIDTH);
+#else
+	memcpy(frame, state->screenBuffer, sizeof(state->screenBuffer));
+#endif
+}
+
+/**
+ * bench_DrawFrames - Renders frames from fixed poses
+ * @state: Pointer to the state
+ * @frame: Scratch xRGB frame for bench_Present
+ * @present: Receives the mean time to present a frame, may be NULL
+ *
+ * Return: Mean time to draw a frame, in seconds
+ */
+static double bench_DrawFrames(GameState *state, uint32_t *frame,
+		double *present)
+{
+	uint32_t seed = 521288629u;
+	double draw = 0, start;
+	int pose;
+
+	if (present)
+		*present = 0;
+	for (pose = 0; pose < RENDER_POSES; pose++)
+	{
+		bench_PlaceCamera(state, &seed);
+		start = bench_Seconds();
+		bench_Present(state, frame);
+		if (present)
+			*present += (bench_Seconds() - start) / RENDER_POSES;
+		start = bench_Seconds();
+		renderWalls(state, true);
+		draw += bench_Seconds() - start;
+	}
+	return (draw / RENDER_POSES);
+}
+
+/**
+ * bench_DrawColumns - Draws a frame column by column and leaves it in the
+ * frame buffer, which renderWalls clears in headless runs
+ * @state: Pointer to the state
+ *
+ * Return: void
+ */
+static void bench_DrawColumns(GameState *state)
+{
+	rayhit_t ray;
+	int x;
+
+	memset(state->screenBuffer, 0, sizeof(state->screenBuffer));
+	for (x = 0; x < SCREEN_WIDTH; x++)
+		if (castRay(state, x, &ray))
+			drawWallStrips(state, ray.map, ray.position, ray.direction,
+				ray.distance, x, ray.side, true);
+}
+
+/**
+ * bench_ShadeCost - Measures what fog adds to each pixel it shades. Every
+ * pose is drawn unlit and with fog in turn, keeping the fastest of a few
+ * rounds of each, so drift between the runs cancels out; the pixels whose
+ * colour fog changes are the pixels it shaded.
+ * @state: Pointer to the state, with lighting that has fog only
+ * @unlit: Scratch copy of the unlit frame buffer
+ * @shaded: Receives the mean number of shaded pixels per frame
+ *
+ * Return: Extra time per shaded pixel, in seconds
+ */
+static double bench_ShadeCost(GameState *state, pixel_t *unlit,
+		double *shaded)
+{
+	lighting_t *fog = state->lighting;
+	const pixel_t *pixels = &state->screenBuffer[0][0];
+	uint32_t seed = 2654435761u;
+	double extra = 0, best[2], time;
+	long count = 0;
+	int pose, round, lit, i;
+
+	for (pose = 0; pose < SHADE_POSES; pose++)
+	{
+		bench_PlaceCamera(state, &seed);
+		best[0] = best[1] = 1e9;
+		for (round = 0; round < SHADE_ROUNDS; round++)
+			for (lit = 0; lit < 2; lit++)
+			{
+				state->lighting = lit ? fog : NULL;
+				time = bench_Seconds();
+				renderWalls(state, true);
+				time = bench_Seconds() - time;
+				best[lit] = time < best[lit] ? time : best[lit];
+			}
+		extra += best[1] - best[0];
+		state->lighting = NULL;
+		bench_DrawColumns(state);
+		memcpy(unlit, pixels, sizeof(state->screenBuffer));
+		state->lighting = fog;
+		bench_DrawColumns(state);
+		for (i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+			count += pixels[i] != unlit[i];
+	}
+	*shaded = (double)count / SHADE_POSES;
+	return (count ? extra / count : 0);
+}
+
+/**
+ * bench_Lights - Scatters point lights over open cells
+ * @maze: Pointer to a square maze
+ * @size: Number of cells along each side
+ * @count: Number of lights
+ *
+ * Return: Array of lights, or NULL if memory ran out
+ */
+static light_t *bench_Lights(const int *maze, int size, int count)
+{
+	light_t *lights = malloc(count * sizeof(light_t) + 1);
+	uint32_t seed = 1013904223u;
+	SDL_Point cell;
+	int i;
+
+	for (i = 0; lights && i < count; i++)
+	{
+		cell = bench_RandomOpenCell(maze, size, &seed);
+		lights[i].x = cell.x + 0.5;
+		lights[i].y = cell.y + 0.5;
+		lights[i].intensity = 1;
+		lights[i].radius = 6;
+	}
+	return (lights);
+}
+
+/**
+ * bench_Render - Measures headless textured frames in the pixel format of
+ * the build, unlit, with fog only and with baked lights and fog. Build
+ * with PALETTE=1 to compare 8-bit palette indices with the default 32-bit
+ * pixels. Fails when fog adds more than SHADE_BOUND_NS to each pixel it
+ * shades: shading is a table lookup, not per pixel math.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Render(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	int lightCount = (int)((long)size * size / 1024);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	uint32_t *frame = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+	light_t *lights = maze ? bench_Lights(maze, size, lightCount) : NULL;
+	double unlit, fog, lit, present, bake, shade = 0, shaded = 0;
+
+	if (state && frame && lights)
+	{
+		unlit = bench_DrawFrames(state, frame, &present);
+		state->lighting = lighting_Create(maze, size, size, NULL, 0, 1, 24);
+		fog = state->lighting ? bench_DrawFrames(state, frame, NULL) : 0;
+		if (state->lighting)
+			shade = bench_ShadeCost(state, (pixel_t *)frame, &shaded);
+		lighting_Destroy(state->lighting);
+		bake = bench_Seconds();
+		state->lighting = lighting_Create(maze, size, size, lights,
+			lightCount, 0.3, 24);
+		bake = bench_Seconds() - bake;
+		lit = state->lighting ? bench_DrawFrames(state, frame, NULL) : 0;
+		printf("render %s %dx%d: textures %zu KB (%zu KB shaded), frame "
+			"buffer %zu KB, present %.2f ms, draw %.2f ms unlit, %.2f ms fog, "
+			"%.2f ms lit (%d lights baked in %.1f ms, %.1f MB)\n",
+			PIXEL_FORMAT, size, size, sizeof(state->tiles) / 1024,
+			SHADE_LEVELS * sizeof(state->tiles) / 1024,
+			sizeof(state->screenBuffer) / 1024, present * 1000.0,
+			unlit * 1000.0, fog * 1000.0, lit * 1000.0, lightCount,
+			bake * 1000.0, state->lighting ? (state->lighting->blockCount *
+			LIGHT_BLOCK_BYTES + (size_t)size * size / (LIGHT_BLOCK *
+			LIGHT_BLOCK) * sizeof(uint32_t)) / 1048576.0 : 0.0);
+		printf("render %s %dx%d: fog shades %.0f pixels a frame for "
+			"%+.2f ns each (bound %.1f ns)%s\n", PIXEL_FORMAT, size, size,
+			shaded, shade * 1e9, SHADE_BOUND_NS,
+			shade * 1e9 > SHADE_BOUND_NS ? " FAIL" : "");
+		if (shade * 1e9 > SHADE_BOUND_NS)
+			bench_Fail();
+		lighting_Destroy(state->lighting);
+	}
+	free(lights);
+	free(frame);
+	bench_DestroyState(state);
+	free(maze);
+}
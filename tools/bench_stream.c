@@ -0,0 +1,167 @@
+#include "bench.h"
+#include "../headers/raycast.h"
+#include "../headers/stream.h"
+
+#define STREAM_FRAMES 128
+#define STREAM_CONVERSIONS 32
+#define STREAM_SHAPES 3
+
+/**
+ * bench_Convert - Times one YUV 4:2:0 conversion of a whole frame
+ * @argb: Frame of SCREEN_WIDTH * SCREEN_HEIGHT pixels
+ * @yuv: Receives the planes
+ * @simd: true for stream_YUV420, false for the scalar code alone
+ *
+ * Return: Pixels converted per second
+ */
+static double bench_Convert(const uint32_t *argb, uint8_t *yuv, bool simd)
+{
+	size_t luma = SCREEN_WIDTH * SCREEN_HEIGHT;
+	uint8_t *u = yuv + luma, *v = u + luma / 4;
+	double start = bench_Seconds();
+	int i;
+
+	for (i = 0; i < STREAM_CONVERSIONS; i++)
+		if (simd)
+			stream_YUV420(argb, SCREEN_WIDTH, SCREEN_HEIGHT, yuv, u, v);
+		else
+			stream_YUV420Scalar(argb, SCREEN_WIDTH, SCREEN_HEIGHT, 0, yuv, u,
+				v);
+	return ((double)luma * STREAM_CONVERSIONS / (bench_Seconds() - start));
+}
+
+/**
+ * bench_CompareYUV - Converts frames of a few sizes with stream_YUV420 and
+ * with the scalar code alone, the whole frame, a width that is not a
+ * multiple of 16 and then also an odd height, and compares the planes.
+ * The buffers start out different, so a byte either path leaves unwritten
+ * counts as a difference.
+ * @argb: Pixels to convert, at least SCREEN_WIDTH * SCREEN_HEIGHT
+ * @simd: Planes of stream_YUV420, SCREEN_WIDTH * SCREEN_HEIGHT * 3 / 2
+ * bytes
+ * @scalar: Planes of the scalar code, the size of @simd
+ *
+ * Return: Number of bytes that differ
+ */
+static long bench_CompareYUV(const uint32_t *argb, uint8_t *simd,
+		uint8_t *scalar)
+{
+	static const int shapes[STREAM_SHAPES][2] = {
+		{SCREEN_WIDTH, SCREEN_HEIGHT}, {997, 798}, {997, 799}};
+	size_t luma, chroma, size, i;
+	long differ = 0;
+	int shape, w, h;
+
+	for (shape = 0; shape < STREAM_SHAPES; shape++)
+	{
+		w = shapes[shape][0];
+		h = shapes[shape][1];
+		luma = (size_t)w * h;
+		chroma = (size_t)((w + 1) / 2) * ((h + 1) / 2);
+		size = luma + 2 * chroma;
+		memset(simd, 0x00, size);
+		memset(scalar, 0xFF, size);
+		stream_YUV420(argb, w, h, simd, simd + luma, simd + luma + chroma);
+		stream_YUV420Scalar(argb, w, h, 0, scalar, scalar + luma,
+			scalar + luma + chroma);
+		for (i = 0; i < size; i++)
+			differ += simd[i] != scalar[i];
+	}
+	return (differ);
+}
+
+/**
+ * bench_StreamFrames - Renders headless frames, streaming them if asked
+ * @state: Pointer to the state
+ * @format: Format of the stream, ignored without @output
+ * @output: Output of the stream, or NULL for none
+ * @wait: true to wait for the writer as headless runs do, false to drop
+ * frames as the window does
+ * @dropped: Receives the number of frames dropped
+ *
+ * Return: Mean frame time on the render thread, in seconds
+ */
+static double bench_StreamFrames(GameState *state, streamformat_t format,
+		const char *output, bool wait, unsigned long *dropped)
+{
+	uint32_t seed = 521288629u;
+	double start;
+	int frame;
+
+	*dropped = 0;
+	state->stream = output ? stream_Open(output, format, wait) : NULL;
+	if (output && state->stream == NULL)
+		return (0);
+	start = bench_Seconds();
+	for (frame = 0; frame < STREAM_FRAMES; frame++)
+	{
+		bench_PlaceCamera(state, &seed);
+		renderWalls(state, true);
+	}
+	start = bench_Seconds() - start;
+	if (state->stream)
+	{
+		SDL_LockMutex(state->stream->lock);
+		*dropped = state->stream->dropped;
+		SDL_UnlockMutex(state->stream->lock);
+	}
+	stream_Close(state->stream);
+	state->stream = NULL;
+	return (start / STREAM_FRAMES);
+}
+
+/**
+ * bench_Stream - Measures the YUV conversion with and without SIMD and
+ * the cost of streaming frames as Y4M and raw ARGB to /dev/null, dropping
+ * frames as the window does, and of Y4M waiting for every frame as headless
+ * runs do. Fails when the two conversions differ or a frame was dropped
+ * while waiting for the writer.
+ * @size: Number of cells along each side of the map
+ *
+ * Return: void
+ */
+void bench_Stream(int size)
+{
+	int *maze = bench_GenerateMaze(size, MAPGEN_CAVERN, 45);
+	GameState *state = maze ? bench_CreateState(maze, size) : NULL;
+	uint32_t *argb = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
+	uint8_t *yuv = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * 3 / 2);
+	uint8_t *check = malloc(SCREEN_WIDTH * SCREEN_HEIGHT * 3 / 2);
+	unsigned long dropY4m, dropArgb, dropWait;
+	double scalar, simd, plain, y4m, waited, raw;
+	uint32_t seed = 88172645u;
+	long differ;
+	int i;
+
+	if (state && argb && yuv && check)
+	{
+		for (i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+			argb[i] = bench_Random(&seed) & 0xFFFFFF;
+		scalar = bench_Convert(argb, yuv, false);
+		simd = bench_Convert(argb, yuv, true);
+		differ = bench_CompareYUV(argb, yuv, check);
+		plain = bench_StreamFrames(state, STREAM_Y4M, NULL, false, &dropWait);
+		y4m = bench_StreamFrames(state, STREAM_Y4M, "/dev/null", false,
+			&dropY4m);
+		raw = bench_StreamFrames(state, STREAM_ARGB, "/dev/null", false,
+			&dropArgb);
+		waited = bench_StreamFrames(state, STREAM_Y4M, "/dev/null", true,
+			&dropWait);
+		printf("stream %s %dx%d: yuv420 %.0f Mpixel/s scalar, %.0f Mpixel/s "
+			"simd (%ld bytes differ in %d sizes)%s; frame %.2f ms, %.2f ms "
+			"with y4m (%lu of %d dropped), %.2f ms with argb (%lu of %d "
+			"dropped), %.2f ms with y4m waiting for the writer (%lu "
+			"dropped)%s\n", PIXEL_FORMAT, size, size, scalar / 1e6,
+			simd / 1e6, differ, STREAM_SHAPES, differ ? " FAIL" : "",
+			plain * 1000.0, y4m * 1000.0, dropY4m, STREAM_FRAMES,
+			raw * 1000.0, dropArgb, STREAM_FRAMES, waited * 1000.0, dropWait,
+			dropWait ? " FAIL" : "");
+		if (differ || dropWait)
+			bench_Fail();
+	}
+	free(check);
+	free(yuv);
+	free(argb);
+	bench_DestroyState(state);
+	free(maze);
+}
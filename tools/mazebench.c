@@ -0,0 +1,202 @@
+#include "bench.h"
+
+static const benchmark_t benchmarks[] = {
+	{"mapgen", bench_MapGeneration},
+	{"nav", bench_Navigation},
+	{"pvs", bench_Visibility},
+	{"precision", bench_Precision},
+	{"render", bench_Render},
+	{"edit", bench_MapEdits},
+	{"reload", bench_Reload},
+	{"stream", bench_Stream},
+	{"control", bench_Control},
+	{"binning", bench_Binning},
+	{"crowd", bench_Crowd},
+	{"minimap", bench_Minimap},
+	{"metrics", bench_Metrics},
+};
+
+static int failures;
+
+/**
+ * bench_Seconds - Reads the high resolution timer
+ *
+ * Return: Seconds elapsed since an arbitrary origin
+ */
+double bench_Seconds(void)
+{
+	return ((double)SDL_GetPerformanceCounter() /
+		SDL_GetPerformanceFrequency());
+}
+
+/**
+ * bench_Random - xorshift32 step, so every run sees the same workload
+ * @seed: Pointer to the generator state, must not be 0
+ *
+ * Return: The next pseudo random number
+ */
+uint32_t bench_Random(uint32_t *seed)
+{
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 17;
+	*seed ^= *seed << 5;
+	return (*seed);
+}
+
+/**
+ * bench_GenerateMaze - Generates the square map a benchmark runs on
+ * @size: Number of cells along each side
+ * @style: Layout of the map
+ * @density: Wall density passed to the generator
+ *
+ * Return: Pointer to the maze, or NULL on failure
+ */
+int *bench_GenerateMaze(int size, mapstyle_t style, int density)
+{
+	mapgen_t options;
+
+	options.width = size;
+	options.height = size;
+	options.style = style;
+	options.density = density;
+	options.seed = 2463534242u;
+	return (generateMapToMemory(&options));
+}
+
+/**
+ * bench_RandomOpenCell - Picks a random walkable cell of a maze
+ * @maze: Pointer to the maze
+ * @size: Number of cells along each side
+ * @seed: Pointer to the generator state
+ *
+ * Return: The cell
+ */
+SDL_Point bench_RandomOpenCell(const int *maze, int size, uint32_t *seed)
+{
+	SDL_Point cell;
+
+	do {
+		cell.x = bench_Random(seed) % size;
+		cell.y = bench_Random(seed) % size;
+	} while (maze[cell.x * size + cell.y]);
+	return (cell);
+}
+
+/**
+ * bench_CreateState - Builds a headless game state: no window, renderer
+ * or texture, so renderWalls only draws into screenBuffer
+ * @maze: Pointer to a square maze, kept by the state
+ * @size: Number of cells along each side
+ *
+ * Return: Pointer to the state, or NULL on failure
+ */
+GameState *bench_CreateState(int *maze, int size)
+{
+	GameState *state = calloc(1, sizeof(GameState));
+	uint32_t (*texels)[TEXTURE_HEIGHT][TEXTURE_WIDTH];
+	int t, x, y;
+
+	texels = malloc(TEXTURE_COUNT * sizeof(*texels));
+	if (state == NULL || texels == NULL)
+	{
+		free(state);
+		free(texels);
+		return (NULL);
+	}
+	state->maze = maze;
+	state->mapWidth = size;
+	state->mapHeight = size;
+	state->textured = true;
+	for (t = 0; t < TEXTURE_COUNT; t++)
+		for (x = 0; x < TEXTURE_HEIGHT; x++)
+			for (y = 0; y < TEXTURE_WIDTH; y++)
+				texels[t][x][y] = ((x ^ y) & 8 ? 0x804020 : 0x408060) +
+					t * 0x101010 + ((x * 3 + y) & 7) * 0x020202;
+	if (!set_TexturePixels(state, texels))
+	{
+		bench_DestroyState(state);
+		state = NULL;
+	}
+	free(texels);
+	return (state);
+}
+
+/**
+ * bench_DestroyState - Frees a state made by bench_CreateState, but not
+ * its maze or the modules attached to it
+ * @state: Pointer to the state, may be NULL
+ *
+ * Return: void
+ */
+void bench_DestroyState(GameState *state)
+{
+	if (state)
+		free(state->shades);
+	free(state);
+}
+
+/**
+ * bench_PlaceCamera - Puts the camera in a random open cell facing a
+ * random direction
+ * @state: Pointer to the state
+ * @seed: Pointer to the generator state
+ *
+ * Return: void
+ */
+void bench_PlaceCamera(GameState *state, uint32_t *seed)
+{
+	SDL_Point cell = bench_RandomOpenCell(state->maze, state->mapWidth, seed);
+	double angle = (bench_Random(seed) % 3600) * M_PI / 1800.0;
+
+	state->position.x = cell.x + 0.5;
+	state->position.y = cell.y + 0.5;
+	state->direction.x = cos(angle);
+	state->direction.y = sin(angle);
+	state->viewPlane.x = -0.66 * sin(angle);
+	state->viewPlane.y = 0.66 * cos(angle);
+}
+
+/**
+ * bench_Fail - Records that a benchmark found results outside its bounds,
+ * so the suite exits with an error
+ *
+ * Return: void
+ */
+void bench_Fail(void)
+{
+	failures++;
+}
+
+/**
+ * main - Runs the benchmark suite
+ * @argc: Number of arguments
+ * @argv: Optional benchmark name followed by map sizes
+ *
+ * Return: 0 on success, 1 on an unknown benchmark name or when a check of
+ * a benchmark failed
+ */
+int main(int argc, char **argv)
+{
+	int sizes[16] = {1024, 2048, 4096, 8192}, count = 4, i, s, found = 0;
+	const char *name = argc > 1 ? argv[1] : "all";
+	int benchCount = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+	if (argc > 2)
+		for (count = 0; count < 16 && count + 2 < argc; count++)
+			sizes[count] = atoi(argv[count + 2]);
+	for (i = 0; i < benchCount; i++)
+	{
+		if (strcmp(name, "all") && strcmp(name, benchmarks[i].name))
+			continue;
+		found = 1;
+		for (s = 0; s < count; s++)
+			if (sizes[s] > 2)
+				benchmarks[i].run(sizes[s]);
+	}
+	if (!found)
+	{
+		fprintf(stderr, "Usage: %s [all|name] [size...]\n", argv[0]);
+		return (1);
+	}
+	return (failures ? 1 : 0);
+}
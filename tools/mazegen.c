@@ -0,0 +1,42 @@
+#include "../headers/mapgen.h"
+
+/**
+ * main - Generates a map file readMapFromFile can load
+ * @argc: Number of arguments
+ * @argv: Style, width, height, then optional density, seed and output
+ * path ("-" or no path writes to the standard output)
+ *
+ * Return: 0 on success, 1 on failure
+ */
+int main(int argc, char **argv)
+{
+	mapgen_t options = {0, 0, MAPGEN_PERFECT, 100, 1};
+
+	if (argc < 4 || !parseMapStyle(argv[1], &options.style))
+	{
+		fprintf(stderr, "Usage: %s perfect|cavern|corridor width height "
+			"[density] [seed] [file]\n", argv[0]);
+		return (1);
+	}
+	options.width = atoi(argv[2]);
+	options.height = atoi(argv[3]);
+	if (options.style == MAPGEN_CAVERN)
+		options.density = 45;
+	else if (options.style == MAPGEN_CORRIDOR)
+		options.density = 98;
+	if (argc > 4)
+		options.density = atoi(argv[4]);
+	if (argc > 5)
+		options.seed = (uint32_t)strtoul(argv[5], NULL, 10);
+	if (options.width < 3 || options.height < 3)
+	{
+		fprintf(stderr, "Error: Map must be at least 3x3\n");
+		return (1);
+	}
+	if (!generateMapToFile(&options, argc > 6 ? argv[6] : "-"))
+	{
+		fprintf(stderr, "Error: Unable to write map\n");
+		return (1);
+	}
+	return (0);
+}